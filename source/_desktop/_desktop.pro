@@ -6,6 +6,7 @@ INSTALL_INC_DIR = $${INSTALL_DIR}/include
 
 QT += widgets
 QT += xml
+QT += concurrent
 
 INCLUDEPATH *= $$PWD/src
 INCLUDEPATH += $$PWD/../
@@ -78,6 +78,9 @@ AppWindow::AppWindow(QWidget *parent)
 {
    m_sauto = new SautoManager(this);
 
+   // the countdowns only move progress bars, ten updates a second is plenty
+   m_sauto->setProgressInterval(100);
+
    connect(m_sauto, SIGNAL(triggered(int, const QString &)),
       this, SLOT(triggered(int, const QString &)));
 
@@ -227,6 +230,9 @@ QWidget* AppWindow::makeSautoList()
    QDir dir(path);
    dir.setFilter(QDir::NoDotAndDotDot | QDir::Files);
    dir.setSorting(QDir::Name);
+
+   // compiled clock files are kept next to their XML
+   dir.setNameFilters(QStringList() << "*.xml");
    QFileInfoList flist = dir.entryInfoList();
    for (int i = 0; i < flist.size(); i++)
    {
@@ -4,5 +4,6 @@ sautoModel \
 sautoXml \
 sautoWidgets \
 sauto \
-_desktop
+_desktop \
+sautoBench
 CONFIG  += ordered
\ No newline at end of file
@@ -15,6 +15,7 @@ CONFIG  += debug_and_release
 CONFIG  += build_all          
 
 QT += widgets
+QT += concurrent
 
 unix {
 QMAKE_CXXFLAGS += -std=c++0x
@@ -35,6 +35,7 @@
 //h-//////////////////////////////////////////////////////////////////////////
 
 // Qt includes
+#include <QDateTime>
 #include <QLocale>
 
 // local includes
@@ -44,18 +45,27 @@ using namespace sauto;
 
 Sauto::Sauto(QObject *parent)
    :QObject(parent),
+   m_clockMode(CLOCK_POLLING),
+   m_latePolicy(LATE_COALESCE),
+   m_progressInterval(0),
+   m_reportProgress(true),
+   m_lastProgress(0),
    m_eventType(EVENT_UNDECIDED),
    m_wp(WP_NOT_SPECIFIED),
-   m_clockCD(-1),
-   m_clockAdjustInterv(CLOCK_ADJUST_INTERV),
-   m_clockDiff(0),
-   m_clockStart(0),
-   m_clockStop(0),
    m_clockCooldown(CLOCK_COOLDOWN_MSEC),
    m_id(-1),
+   m_running(false),
    isSingleSession(false),
    isInSession(false),
+   m_time(&systemTime()),
    m_timer(0),
+   m_wheel(0),
+   m_lastWake(0),
+   m_lastWall(0),
+   m_now(0),
+   m_cronNext(0),
+   m_cronLast(0),
+   m_triggerBatch(0),
    hasNextSessionTime(false),
    msecsToNextSession_original(0),
    msecsToNextSession(0),
@@ -68,37 +78,368 @@ Sauto::Sauto(QObject *parent)
    msecEpoch_sessionStartTime(0),
    msecLastTrigger(0)
 {
-   m_timer = new QTimer(this);
-   m_timer->setTimerType(Qt::PreciseTimer);
-   m_timer->setSingleShot(false);
-
-   connect(m_timer, SIGNAL(timeout()),
-      this, SLOT(timeout()));
+   m_wheelEntry.clock = this;
 }
 
 Sauto::~Sauto()
 {
-
+   // the wheel detaches its entries when it goes first
+   if (m_wheel != 0 && m_wheelEntry.level >= 0)
+   {
+      m_wheel->cancel(&m_wheelEntry);
+   }
 }
 
-void Sauto::init(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF  &def_calendar)
+//  The sessions of the definitions are placed in the argument time zone, the local time of the host
+//  by default
+void Sauto::init(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF  &def_calendar, const SautoZone &zone)
 {
    m_id = id;
    m_default_freq = def_frequency;
-   m_default_intervals = def_intervals;
-   m_default_week = def_week;
-   m_default_calendar = def_calendar;
+   m_zone = zone;
+   m_day = SautoDayContext();
+
+   // the definitions are only needed in their compiled form from here on
+   m_schedule.compile(def_frequency, def_intervals, def_week, def_calendar);
    if(def_frequency.getStartTimeMSec() < 0)
    {
       isSingleSession = true;
    }
 }
 
+//  Moves the clock to another time zone. The sessions were placed in the old one, so a running
+//  clock ends its session and plans the next one again
+void Sauto::setTimeZone(const SautoZone &zone)
+{
+   m_zone = zone;
+   m_day = SautoDayContext();
+   isInSession        = false;
+   hasDuration        = false;
+   hasNextSessionTime = false;
+   hasNextTriggerTime = false;
+   msecLastTrigger    = 0;
+   if (m_running && m_clockMode == CLOCK_DEADLINE)
+   {
+      cancelWakeup();
+      scheduleWakeup(0);
+   }
+}
+
+//  Makes this a cron clock, which fires the task at every minute that the expression matches in
+//  the zone of the clock. A cron clock has no definitions, every trigger is a session of its own
+void Sauto::setCron(const SautoCron &cron, const QString &taskID)
+{
+   m_cron = cron;
+   m_current_freq = SautoModel();
+   m_current_freq.setType(SINGLE);
+   m_current_freq.setOnPeak(taskID);
+   m_cronNext = 0;
+   m_cronLast = 0;
+   isSingleSession = false;
+}
+
+//  Lets the recurrence rule select the days of the sessions in place of the calendar. The
+//  session that is running is ended, and the next one is planned from the rule
+void Sauto::setRecurrence(const SautoRecurrence &recurrence)
+{
+   m_schedule.setRecurrence(recurrence);
+   isInSession        = false;
+   hasDuration        = false;
+   hasNextSessionTime = false;
+   hasNextTriggerTime = false;
+   msecLastTrigger    = 0;
+   if (m_running && m_clockMode == CLOCK_DEADLINE)
+   {
+      cancelWakeup();
+      scheduleWakeup(0);
+   }
+}
+
+//  Swaps in a schedule that was compiled from a definition that changed on disk. A session that
+//  is running goes on with its countdowns when the new schedule has the same session that day,
+//  otherwise it is ended. The next session is always planned again from the new schedule
+EReload Sauto::reload(const SautoSchedule &schedule)
+{
+   if (schedule == m_schedule)
+   {
+      return RELOAD_UNCHANGED;
+   }
+
+   const bool keepSession = isInSession && sessionUnaffected(schedule);
+   m_schedule = schedule;
+   m_default_freq = schedule.frequency();
+   isSingleSession = m_default_freq.getStartTimeMSec() < 0;
+   hasNextSessionTime = false;
+   if (keepSession)
+   {
+      return RELOAD_SWAPPED;
+   }
+
+   const bool wasInSession = isInSession;
+   isInSession        = false;
+   hasDuration        = false;
+   hasNextTriggerTime = false;
+   msecLastTrigger    = 0;
+   if (m_running && m_clockMode == CLOCK_DEADLINE)
+   {
+      // the wakeup may have been armed for a session that is gone
+      cancelWakeup();
+      scheduleWakeup(0);
+   }
+   return wasInSession ? RELOAD_REPLANNED : RELOAD_SWAPPED;
+}
+
+//  The current session is unaffected when the list of the day that it started, or of the day before
+//  for a session that runs past midnight, still has the same model
+bool Sauto::sessionUnaffected(const SautoSchedule &schedule) const
+{
+   const QDate day = m_zone.dateAt(msecEpoch_sessionStartTime);
+   for (int i = 0; i < 2; i++)
+   {
+      const int index = schedule.dayList(day.addDays(-i));
+      if (index < 0)
+      {
+         continue;
+      }
+
+      const SautoScheduleList &list = schedule.list(index);
+      if (list.inherit)
+      {
+         if (schedule.frequency() == m_current_freq)
+         {
+            return true;
+         }
+         continue;
+      }
+
+      const SautoModel *models = schedule.models(list);
+      for (int j = 0; j < list.count; j++)
+      {
+         if (models[j] == m_current_freq)
+         {
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+//  The countdowns as they were at the last wakeup, a paused clock has not counted down since it was paused
+SautoClockState Sauto::state() const
+{
+   SautoClockState state;
+   state.id = m_id;
+   state.wallTime = m_lastWall;
+   state.running = m_running;
+   state.inSession = isInSession;
+   state.eventType = static_cast<quint8>(m_eventType);
+   state.wp = static_cast<quint8>(m_wp);
+   state.hasNextTriggerTime = hasNextTriggerTime;
+   state.msecsToNextTrigger = msecsToNextTrigger;
+   state.msecsToNextTrigger_original = msecsToNextTrigger_original;
+   state.hasDuration = hasDuration;
+   state.msecsDuration_original = msecsDuration_original;
+   state.msecsTimeLeft = msecsTimeLeft;
+   state.sessionStartTime = msecEpoch_sessionStartTime;
+   state.msecsSinceTrigger = msecLastTrigger > 0 ? m_time->elapsed() - static_cast<qint64>(msecLastTrigger) : -1;
+   state.current = m_current_freq;
+   return state;
+}
+
+//  Goes on from the countdowns of another process. The time between the state and now is counted
+//  down for a clock that was running. Only a session that was running is restored, the next session
+//  is planned again from the wall clock. Nothing is emitted, the triggers that were missed meanwhile
+//  are left to resume() once the clock is on its shard
+void Sauto::restore(const SautoClockState &state)
+{
+   hasNextSessionTime = false;
+   if (!state.inSession)
+   {
+      return;
+   }
+
+   isInSession = true;
+   m_current_freq = state.current;
+   m_eventType = static_cast<EEventType>(state.eventType);
+   m_wp = static_cast<EWavePoint>(state.wp);
+   hasNextTriggerTime = state.hasNextTriggerTime;
+   msecsToNextTrigger = state.msecsToNextTrigger;
+   msecsToNextTrigger_original = state.msecsToNextTrigger_original;
+   hasDuration = state.hasDuration;
+   msecsDuration_original = state.msecsDuration_original;
+   msecsTimeLeft = state.msecsTimeLeft;
+   msecEpoch_sessionStartTime = state.sessionStartTime;
+
+   const qint64 down = state.running ? qMax<qint64>(0, m_time->currentMSecsSinceEpoch() - state.wallTime) : 0;
+   advanceCountdowns(down);
+   msecLastTrigger = 0;
+   if (state.msecsSinceTrigger >= 0 && m_time->elapsed() > state.msecsSinceTrigger + down)
+   {
+      msecLastTrigger = m_time->elapsed() - state.msecsSinceTrigger - down;
+   }
+   m_lastWall = m_time->currentMSecsSinceEpoch();
+}
+
+//  Handles the triggers that were due while the process was down by the argument policy, after
+//  restore(). The triggers that are due get the times they were due at. Returns false when the
+//  clock has nothing left to do
+bool Sauto::resume(ELatePolicy policy)
+{
+   recordDropped(catchUp(policy), policy);
+   if (hasDuration && msecsTimeLeft <= 0)
+   {
+      // the session ended while the process was down
+      if (isSingleSession)
+      {
+         return false;
+      }
+      isInSession        = false;
+      hasDuration        = false;
+      hasNextTriggerTime = false;
+   }
+   return true;
+}
+
+//  Handles the triggers of the session that are due by the argument policy. Triggers that would
+//  have come after the end of the session were never due. Returns the number of due triggers that
+//  were not fired
+qint64 Sauto::catchUp(ELatePolicy policy)
+{
+   if (!isInSession || !hasNextTriggerTime || msecsToNextTrigger > 0)
+   {
+      return 0;
+   }
+
+   const qint64 last = hasDuration ? qMin<qint64>(0, msecsTimeLeft - 1) : 0;
+   if (msecsToNextTrigger > last)
+   {
+      return 0;
+   }
+   qint64 due = 1;
+   if (m_eventType != EVENT_SINGLESHOT && msecsToNextTrigger_original > 0)
+   {
+      due += (last - msecsToNextTrigger) / msecsToNextTrigger_original;
+   }
+
+   switch (policy)
+   {
+   case(LATE_FIRE_ALL) :
+      for (qint64 i = 0; i < due && hasNextTriggerTime; i++)
+      {
+         fireTrigger();
+      }
+      return 0;
+
+   case(LATE_COALESCE) :
+      fireTrigger();
+      hasNextTriggerTime = false;
+      return due - 1;
+
+   case(LATE_SKIP) :
+   default:
+      // the next trigger is calculated again from the wall clock, a single shot is its own session
+      hasNextTriggerTime = false;
+      if (m_eventType == EVENT_SINGLESHOT)
+      {
+         isInSession        = false;
+         hasNextSessionTime = false;
+      }
+      return due;
+   }
+}
+
+//  How often the countdowns are reported, in msecs. 0 reports them at every wakeup, and a negative
+//  interval never does, then they are only read through progress()
+void Sauto::setProgressInterval(int msecs)
+{
+   m_progressInterval = msecs;
+   m_reportProgress = msecs == 0;
+   if (m_running && m_clockMode == CLOCK_DEADLINE)
+   {
+      // a clock that sleeps until its next deadline may have to wake up sooner
+      armDeadline();
+   }
+}
+
+SautoProgress Sauto::progress() const
+{
+   SautoProgress progress;
+   progress.id = m_id;
+   progress.running = m_running;
+   progress.inSession = isInSession;
+   progress.hasNextSession = hasNextSessionTime && !isInSession;
+   progress.msecsToSession = msecsToNextSession;
+   progress.msecsToSession_original = msecsToNextSession_original;
+   progress.hasNextTrigger = hasNextTriggerTime && isInSession;
+   progress.msecsToTrigger = msecsToNextTrigger;
+   progress.msecsToTrigger_original = msecsToNextTrigger_original;
+   progress.hasDuration = hasDuration && isInSession;
+   progress.msecsLeft = msecsTimeLeft;
+   progress.msecsDuration = msecsDuration_original;
+   return progress;
+}
+
+void Sauto::setClockMode(EClockMode mode)
+{
+   if (m_clockMode == mode)
+   {
+      return;
+   }
+
+   m_clockMode = mode;
+   if (m_running)
+   {
+      // the time since the last wakeup is counted down before the clock starts over in the new
+      // mode, which counts from now
+      cancelWakeup();
+      advanceCountdowns(m_time->elapsed() - m_lastWake);
+      startClock(m_id);
+   }
+}
+
+void Sauto::setTimeSource(const SautoTimeSource *time)
+{
+   if (m_running)
+   {
+      // the time since the last wakeup is counted down on the old source, and the countdowns
+      // continue from the new one
+      advanceCountdowns(m_time->elapsed() - m_lastWake);
+   }
+   m_time = time;
+   if (m_running)
+   {
+      m_lastWake = m_time->elapsed();
+      m_lastWall = m_time->currentMSecsSinceEpoch();
+   }
+}
+
+void Sauto::setWheel(SautoWheel *wheel)
+{
+   cancelWakeup();
+   m_wheel = wheel;
+   if (m_running)
+   {
+      startClock(m_id);
+   }
+}
+
 void Sauto::startClock(int id)
 {
    if (m_id == id)
    {
-      m_timer->start(m_clockCooldown);
+      m_running = true;
+
+      // time spent paused is not counted down
+      m_lastWake = m_time->elapsed();
+      m_lastWall = m_time->currentMSecsSinceEpoch();
+      if (m_clockMode == CLOCK_DEADLINE)
+      {
+         scheduleWakeup(0);
+      }
+      else
+      {
+         scheduleWakeup(m_clockCooldown);
+      }
    }
 }
 
@@ -106,10 +447,8 @@ void Sauto::stopClock(int id)
 {
    if (m_id == id)
    {
-      if (m_timer != 0 && m_timer->isActive())
-      {
-         m_timer->stop();
-      }
+      m_running = false;
+      cancelWakeup();
       this->deleteLater();
    }
 }
@@ -118,49 +457,183 @@ void Sauto::pauseClock(int id)
 {
    if (m_id == id)
    {
-      m_timer->stop();
+      m_running = false;
+      cancelWakeup();
    }
 }
 
-void Sauto::handleTimeDelay(qint64 msecs)
+void Sauto::advanceCountdowns(qint64 msecs)
 {
-   // add delay to countdown members
-   msecsToNextSession -= msecs;
-   msecsToNextTrigger -= msecs;
-   msecsTimeLeft      -= msecs;
+   // countdowns are allowed to go below zero, how late a trigger is
+   // gets subtracted from the next period so that lateness doesn't add up
+   if (hasNextSessionTime)
+   {
+      msecsToNextSession -= msecs;
+   }
+   if (hasNextTriggerTime)
+   {
+      msecsToNextTrigger -= msecs;
+   }
+   if (hasDuration)
+   {
+      msecsTimeLeft -= msecs;
+   }
 }
 
-void Sauto::measureAccuracy()
+//  Called when the wall clock has jumped, the argument elapsed msecs are the time that really went
+//  by since the last wakeup
+void Sauto::replan(qint64 msecsJump, qint64 msecsElapsed)
 {
-   if(m_clockCD == -1)
+   if (isInSession)
+   {
+      // the session that is running keeps the time it has left, so that it ends with its triggers
+      // as it would have without the jump. The next session is planned from the new wall clock
+      // when it is over
+      advanceCountdowns(msecsElapsed);
+      hasNextSessionTime = false;
+   }
+   else
    {
-      // starting condition
-      m_clockCD    = m_clockAdjustInterv;
-      m_clockStart = QDateTime::currentMSecsSinceEpoch();
+      // the countdowns were calculated against the old wall clock, start over from the definitions
+      hasDuration        = false;
+      hasNextSessionTime = false;
+      hasNextTriggerTime = false;
+      msecLastTrigger    = 0;
    }
-   else if(m_clockCD == 0)
+   emit clockAdjusted(m_id, msecsJump);
+}
+
+void Sauto::recordJitter(qint64 msecsLate)
+{
+   m_jitter.samples++;
+   m_jitter.last   = msecsLate;
+   m_jitter.max    = qMax(m_jitter.max, msecsLate);
+   m_jitter.total += msecsLate;
+}
+
+//  Triggers that were due but did not run, counted by the policy that let them go
+void Sauto::recordDropped(qint64 count, ELatePolicy policy)
+{
+   if (count <= 0)
    {
-      // measure time now
-      // this calculation should ideally be 0 msecs each time
-      m_clockCD   = m_clockAdjustInterv;
-      m_clockStop = QDateTime::currentMSecsSinceEpoch();
-      m_clockDiff = (m_clockStop - m_clockStart) - (m_clockAdjustInterv * m_clockCooldown);
-      if(m_clockDiff >= m_clockCooldown)
+      return;
+   }
+   if (policy == LATE_COALESCE)
+   {
+      m_jitter.coalesced += count;
+   }
+   else
+   {
+      m_jitter.skipped += count;
+   }
+   emit triggersDropped(m_id, count);
+}
+
+void SautoJitter::add(const SautoJitter &other)
+{
+   samples   += other.samples;
+   last       = other.last;
+   max        = qMax(max, other.max);
+   total     += other.total;
+   fired     += other.fired;
+   coalesced += other.coalesced;
+   skipped   += other.skipped;
+}
+
+void Sauto::armDeadline()
+{
+   if (!m_running)
+   {
+      return;
+   }
+
+   // when no countdown is running the next wakeup is a re-plan, which is done
+   // after the regular cooldown so that a clock without sessions doesn't spin
+   qint64 msecs = m_clockCooldown;
+   if (isInSession)
+   {
+      if (hasNextTriggerTime)
       {
-         handleTimeDelay(m_clockDiff);
-         m_clockDiff = 0;
+         msecs = msecsToNextTrigger;
+         if (hasDuration && m_eventType != EVENT_SINGLESHOT)
+         {
+            msecs = qMin(msecs, msecsTimeLeft);
+         }
       }
-      m_clockStart = QDateTime::currentMSecsSinceEpoch();
    }
-   else
+   else if (hasNextSessionTime)
+   {
+      msecs = msecsToNextSession;
+   }
+
+   // a clock that reports its countdowns wakes up to do so
+   if (m_progressInterval > 0)
+   {
+      msecs = qMin<qint64>(msecs, m_progressInterval);
+   }
+
+   // QTimer intervals are int, sessions further away than a day are re-planned daily
+   scheduleWakeup(qBound<qint64>(0, msecs, msecsPer_Day));
+}
+
+void Sauto::scheduleWakeup(qint64 msecs)
+{
+   if (m_wheel != 0)
+   {
+      m_wheel->arm(&m_wheelEntry, msecs);
+      return;
+   }
+
+   // clocks driven by a shared wheel never need a timer of their own
+   if (m_timer == 0)
    {
-      m_clockCD--;
+      m_timer = new QTimer(this);
+      m_timer->setTimerType(Qt::PreciseTimer);
+      connect(m_timer, SIGNAL(timeout()),
+         this, SLOT(timeout()));
+   }
+   m_timer->setSingleShot(m_clockMode == CLOCK_DEADLINE);
+   m_timer->start(static_cast<int>(msecs));
+}
+
+void Sauto::cancelWakeup()
+{
+   if (m_wheel != 0)
+   {
+      m_wheel->cancel(&m_wheelEntry);
+   }
+   else if (m_timer != 0 && m_timer->isActive())
+   {
+      m_timer->stop();
    }
 }
 
 void Sauto::timeout()
 {
-   measureAccuracy();
+   // countdowns follow the monotonic clock, the wall clock is only compared against it
+   // so that a step of the system time (NTP, manual change) is noticed
+   const qint64 wakeTime = m_time->elapsed();
+   const qint64 wallTime = m_time->currentMSecsSinceEpoch();
+   const qint64 elapsed  = wakeTime - m_lastWake;
+   const qint64 jump     = (wallTime - m_lastWall) - elapsed;
+   m_lastWake = wakeTime;
+   m_lastWall = wallTime;
+
+   // the countdowns are reported at most once per progress interval, triggers always are
+   m_reportProgress = m_progressInterval == 0 || (m_progressInterval > 0 && wakeTime - m_lastProgress >= m_progressInterval);
+   if (m_reportProgress)
+   {
+      m_lastProgress = wakeTime;
+   }
+   if (qAbs(jump) > CLOCK_JUMP_TOLERANCE)
+   {
+      replan(jump, elapsed);
+   }
+   else
+   {
+      advanceCountdowns(elapsed);
+   }
+
    if (isInSession)
    {
       inSession();
@@ -169,6 +642,16 @@ void Sauto::timeout()
    {
       outOfSession();
    }
+
+   if (m_clockMode == CLOCK_DEADLINE)
+   {
+      armDeadline();
+   }
+   else if (m_wheel != 0 && m_running)
+   {
+      // the wheel is one-shot, polling clocks re-arm their tick
+      scheduleWakeup(m_clockCooldown);
+   }
 }
 
 void Sauto::inSession()
@@ -184,34 +667,34 @@ void Sauto::inSession()
       }
    }
 
-   msecsToNextTrigger -= m_clockCooldown;
-   if(msecsToNextTrigger < (0-m_clockCooldown))
+   if(msecsToNextTrigger < (0-msecsToNextTrigger_original))
    {
-      // should never be the case
-      hasNextTriggerTime = false;
-      return;
+      // a whole period has been missed, the clock was held up and the policy decides what
+      // happens to the triggers that are due
+      recordJitter(0-msecsToNextTrigger);
+      msecLastTrigger = m_time->elapsed();
+      recordDropped(catchUp(m_latePolicy), m_latePolicy);
+      if(!isInSession || !hasNextTriggerTime)
+      {
+         return;
+      }
    }
 
    if(msecsToNextTrigger <= 0)
    {
-      quint64 msecOnTrigger = QDateTime::currentDateTime().toMSecsSinceEpoch();
-      if(msecLastTrigger == 0)
+      recordJitter(0-msecsToNextTrigger);
+      quint64 msecOnTrigger = m_time->elapsed();
+      if(msecLastTrigger != 0 && msecOnTrigger < (msecLastTrigger + CLOCK_OVERLAP_MSEC) && m_latePolicy != LATE_FIRE_ALL)
       {
-         msecLastTrigger = msecOnTrigger;
-      }
-      else if(msecOnTrigger < (msecLastTrigger + 100))
-      {
-         // TODO : Find out why this is sometimes the case
+         // overlaps the trigger before, the two are one unless the policy fires both
+         recordDropped(1, m_latePolicy);
          hasNextTriggerTime = false;
          return;
       }
-      else
-      {
-         msecLastTrigger = msecOnTrigger;
-      }
+      msecLastTrigger = msecOnTrigger;
       onTrigger();
    }
-   else
+   else if(m_reportProgress)
    {
       emit timeToNextTrigger(m_id, msecsToNextTrigger, msecsToNextTrigger_original);
    }
@@ -240,20 +723,16 @@ void Sauto::outOfSession()
    {
       calculateTime_Session();
    }
-   else
-   {
-      msecsToNextSession -= m_clockCooldown;
-   }
 
    if(msecsToNextSession <= 0)
    {
       // the session start just now!
       msecsToNextSession = 0;
-      msecEpoch_sessionStartTime = QDateTime::currentDateTime().toMSecsSinceEpoch();
+      msecEpoch_sessionStartTime = m_time->currentMSecsSinceEpoch();
       isInSession = true;
       inSession();
    }
-   else
+   else if(m_reportProgress)
    {
       // session has not yet started, report the time left until it starts
       switch(m_eventType)
@@ -282,13 +761,25 @@ void Sauto::outOfSession()
 
 void Sauto::calculateTime_Trigger(SautoModel &freq)
 {
+   if (m_cron.isValid())
+   {
+      // the session of a cron clock is the trigger itself
+      updateDay();
+      msecsToNextTrigger = m_cronNext - m_now;
+      msecsToNextTrigger_original = msecsPer_Min;
+      m_eventType = EVENT_SINGLESHOT;
+      hasNextTriggerTime = true;
+      return;
+   }
+
    if (!freq.isValid())
    {
       return;
    }
 
    bool ok;
-   EIntervalType type = freq.calculateNextTrigger(msecsToNextTrigger, ok, m_wp);
+   updateDay();
+   EIntervalType type = freq.calculateNextTrigger(msecsToNextTrigger, ok, m_wp, m_now, m_day);
    if(!ok)
    {
       hasNextTriggerTime = false;
@@ -298,11 +789,8 @@ void Sauto::calculateTime_Trigger(SautoModel &freq)
    switch(type)
    {
    case(WAVELET):
-      msecsToNextTrigger_original = qRound(static_cast<qreal>(freq.getPeriodTotMSec()) / 4);
-      break;
-
    case(STATIC):
-      msecsToNextTrigger_original = freq.getPeriodTotMSec();
+      msecsToNextTrigger_original = freq.triggerStep();
       break;
 
    case(SINGLE):
@@ -320,19 +808,26 @@ void Sauto::calculateTime_Trigger(SautoModel &freq)
 
 void Sauto::onTrigger()
 {
-   if(msecsToNextTrigger < (0-m_clockCooldown))
+   if(msecsToNextTrigger < (0-msecsToNextTrigger_original))
    {
       // should never be the case
       hasNextTriggerTime = false;
       return;
    }
+   fireTrigger();
+}
 
-   QString m_currTask = "SKIP";
+//  Emits the task of the trigger that is due, and moves the countdown on to the next trigger
+void Sauto::fireTrigger()
+{
+   // the countdowns run from the last wakeup, a late trigger keeps the time it was due
+   const qint64 due = m_lastWall + msecsToNextTrigger;
+   SautoTaskId task = SAUTO_NO_TASK;
    switch(m_eventType)
    {
    case(EVENT_SINGLESHOT):
-      m_currTask = m_current_freq.getOnPeak();
-      emit triggered(m_id, m_currTask);
+      emitTrigger(m_current_freq.onPeakId(), due);
+      m_cronLast = m_cronNext;
       // the reason why the process is restarted on trigger if the trigger type is singleshot,
       // is that the cooldown is defined as trigger-cooldown, and not session cool-down, so next trigger time
       // must be recalculated after each trigger
@@ -343,46 +838,33 @@ void Sauto::onTrigger()
       break;
 
    case(EVENT_CONSTFREQ):
-      m_currTask = m_current_freq.getOnPeak();
-      emit triggered(m_id, m_currTask);
-      msecsToNextTrigger = msecsToNextTrigger_original;
+      emitTrigger(m_current_freq.onPeakId(), due);
+      msecsToNextTrigger += msecsToNextTrigger_original;
       break;
 
    case(EVENT_INTERVAL):
-      m_currTask = m_current_freq.getOnPeak();
-      emit triggered(m_id, m_currTask);
-      msecsToNextTrigger = msecsToNextTrigger_original;
+      emitTrigger(m_current_freq.onPeakId(), due);
+      msecsToNextTrigger += msecsToNextTrigger_original;
       break;
 
    case(EVENT_WAVELET):
+      // a wave point without a task is skipped
       switch(m_wp)
       {
       case(SINKING):
-         if (m_current_freq.hasSinking())
-         {
-            m_currTask = m_current_freq.getOnSinking();
-         }
+         task = m_current_freq.onSinkingId();
          break;
 
       case(PEAK):
-         if (m_current_freq.hasPeak())
-         {
-            m_currTask = m_current_freq.getOnPeak();
-         }
+         task = m_current_freq.onPeakId();
          break;
 
       case(RISING):
-         if (m_current_freq.hasRising())
-         {
-            m_currTask = m_current_freq.getOnRising();
-         }
+         task = m_current_freq.onRisingId();
          break;
 
       case(VALLEY):
-         if (m_current_freq.hasValley())
-         {
-            m_currTask = m_current_freq.getOnValley();
-         }
+         task = m_current_freq.onValleyId();
          break;
 
       default:
@@ -390,10 +872,10 @@ void Sauto::onTrigger()
       }
 
       m_wp = nextWp(m_wp);
-      msecsToNextTrigger = msecsToNextTrigger_original;
-      if (m_currTask != "SKIP")
+      msecsToNextTrigger += msecsToNextTrigger_original;
+      if (task != SAUTO_NO_TASK)
       {
-         emit triggered(m_id, m_currTask);
+         emitTrigger(task, due);
       }
       break;
 
@@ -404,6 +886,26 @@ void Sauto::onTrigger()
    }
 }
 
+//  A clock that delivers its triggers in batches adds them to the batch instead of emitting them,
+//  and leaves it to the receiver to look up the name of the task
+void Sauto::emitTrigger(SautoTaskId task, qint64 due)
+{
+   m_jitter.fired++;
+   if (m_triggerBatch != 0)
+   {
+      SautoTriggerRecord record;
+      record.clockId = m_id;
+      record.task = task;
+      record.scheduledTime = due;
+      record.actualTime = m_lastWall;
+      m_triggerBatch->append(record);
+      return;
+   }
+   const QString taskID = SautoTasks::name(task);
+   emit triggered(m_id, taskID);
+   emit triggeredAt(m_id, taskID, due);
+}
+
 EWavePoint sauto::nextWp(EWavePoint wp)
 {
    switch(wp)
@@ -425,7 +927,6 @@ EWavePoint sauto::nextWp(EWavePoint wp)
 
 void Sauto::onHasDuration()
 {
-   msecsTimeLeft -= m_clockCooldown;
    if(msecsTimeLeft <= 0)
    {
       // this session has ended, find next set of times at next clock timeout
@@ -442,19 +943,65 @@ void Sauto::onHasDuration()
       hasNextSessionTime = false;
       hasNextTriggerTime = false;
    }
-   else
+   else if(m_reportProgress)
    {
       emit timeLeft(m_id, msecsTimeLeft, msecsDuration_original);
    }
 }
 
+//  Reads the time for a calculation, the day of the zone is only found again once the time has left it
+void Sauto::updateDay()
+{
+   m_now = m_time->currentMSecsSinceEpoch();
+   if (!m_day.contains(m_now))
+   {
+      m_day = m_zone.dayContext(m_now);
+   }
+}
+
+//  Plans the next session again from the current time, the way the clock does when it leaves a
+//  session. Returns false when there are no more sessions, then the clock has ended
+bool Sauto::planNextSession()
+{
+   hasNextSessionTime = false;
+   msecsToNextSession = 0;
+   calculateTime_Session();
+   return hasNextSessionTime;
+}
+
 void Sauto::calculateTime_Session()
 {
+   updateDay();
+
+   // CRON replaces the definitions
+   if(m_cron.isValid())
+   {
+      if(!calculateTime_Cron())
+      {
+         // there are nothing more for this thread to do, report and stop
+         stopClock(m_id);
+         emit endReport(m_id, "No future sessions found");
+         this->deleteLater();
+      }
+   }
+
+   // RECURRENCE takes the place of the calendar
+   else if(m_schedule.hasRecurrence())
+   {
+      if(!calculateTime_Recurrence())
+      {
+         // there are nothing more for this thread to do, report and stop
+         stopClock(m_id);
+         emit endReport(m_id, "No future sessions found");
+         this->deleteLater();
+      }
+   }
+
    // CALENDAR has FIRST priority
-   if(m_default_calendar.size() > 0)
+   else if(m_schedule.hasCalendar())
    {
       // there exist a defined calendar, use it
-      if(!calculateTime_Calendar(m_default_calendar))
+      if(!calculateTime_Calendar())
       {
          // there are nothing more for this thread to do, report and stop
          stopClock(m_id);
@@ -464,10 +1011,10 @@ void Sauto::calculateTime_Session()
    }
 
    // WEEK has SECOND priority
-   else if(m_default_week.size() > 0)
+   else if(m_schedule.hasWeek())
    {
       // there exist a week definition, use it
-      if(!calculateTime_Week(m_default_week))
+      if(!calculateTime_Week())
       {
          // there are nothing more for this thread to do, report and stop
          stopClock(m_id);
@@ -477,9 +1024,9 @@ void Sauto::calculateTime_Session()
    }
 
    // INTERVAL has THIRD priority
-   else if(m_default_intervals.size() > 0)
+   else if(m_schedule.hasIntervals())
    {
-      if(!calculateTime_Intervals(m_default_intervals, false, true))
+      if(!calculateTime_Intervals(SCHEDULE_DEFAULT_LIST, false, true))
       {
          // there are nothing more for this thread to do, report and stop
          stopClock(m_id);
@@ -508,372 +1055,242 @@ void Sauto::calculateTime_Session()
    }
 }
 
-bool Sauto::calculateTime_Calendar(CALENDAR_DEF &calendar)
+bool Sauto::calculateTime_Recurrence()
 {
-   if (calendar.size() == 0)
+   const SautoRecurrence &recurrence = m_schedule.recurrence();
+   const qint64 today = daysFromDate(m_day.date);
+
+   // today may have no session left, then the next days of the rule are tried until one has a
+   // session. The rule ends the search at its UNTIL, and a rule that goes on forever is searched as
+   // far as RECURRENCE_SEARCH_YEARS. A later day only has no session when its weekday has none, so
+   // a weekday that has failed once is not tried again
+   const qint64 lastDay = daysFromDate(m_day.date.addYears(RECURRENCE_SEARCH_YEARS));
+   quint8 failedWeekdays = 0;
+   for (qint64 day = recurrence.next(today); day >= 0 && day <= lastDay; day = recurrence.next(day + 1))
    {
-      return calculateTime_Week(m_default_week);
-   }
-
-   bool result = false;
-   QDateTime now = QDateTime::currentDateTime();
-
-   MONTH_ID month = static_cast<MONTH_ID>(now.date().month());
-   QString nowMonthName = makeYear().value(month);
-
-   // calendar is defined
-   CALENDAR_ITERATOR cal_it(calendar);
-   while(cal_it.hasNext())
-   {
-      cal_it.next();
-      if(cal_it.key() >= now.date().year())
+      const int weekday = dayOfWeekFromDays(day);
+      const int intervals = m_schedule.weekdayList(weekday);
+      if(day == today)
       {
-         // found the year at which the next session will occur
-         MONTH_DEF months = cal_it.value().second;
-         if(months.size() == 0)
+         if (calculateTime_Intervals(intervals))
          {
-            // the year was defined, but it had no month definitions. Must use the inherit-option
-            result = calculateTime_Week(m_default_week, cal_it.key());
-            break;
+            return true;
          }
-         else if(months.contains(nowMonthName))
+      }
+      else if((failedWeekdays & (1 << weekday)) == 0)
+      {
+         if (calculateTime_Intervals(intervals, true))
          {
-            // found the month, it is this current month
-            result = calculateTime_Month(months, nowMonthName, cal_it.key());
-            break;
+            placeSession(dateFromDays(day));
+            return true;
          }
-         else
+         failedWeekdays |= 1 << weekday;
+         if (failedWeekdays == 0xFE)
          {
-            QPair<int, QString> nextMonth = findNextMonthInt(months);
-            if (nextMonth.first > now.date().month())
-            {
-               // found the month, it is not this one, but one in the future
-               result = calculateTime_Month(months, nextMonth.second, cal_it.key());
-            }
-            else
-            {
-               // this thread has no sessions in the future, all the defined months belong to the past.
-               // the thread should report that it is finished and stop.
-               result = false;
-            }
+            // every weekday from monday to sunday has failed
+            return false;
          }
       }
    }
-
-   return result;
+   return false;
 }
 
-bool Sauto::calculateTime_Month(MONTH_DEF &months, const QString &name, int year)
+bool Sauto::calculateTime_Calendar()
 {
-   if (!months.contains(name))
+   if (!m_schedule.hasCalendar())
    {
-      // the argument list of months doesnt contain the argument month, which is an error and shouldn't occur.
-      return false;
+      return calculateTime_Week();
    }
 
-   QDateTime now = QDateTime::currentDateTime();
-   int today = now.date().day();
-   DAY_OF_MONTH_DEF monthDef = months.value(name);
+   bool result = false;
+   const QDate &today = m_day.date;
+   const int thisMonth = today.month();
 
-   if (monthDef.first)
+   // calendar is defined, the years are sorted so the search starts at this year
+   const QVector<SautoScheduleYear> &years = m_schedule.years();
+   for (int i = m_schedule.yearIndex(today.year()); i < years.size(); i++)
    {
-      // this month uses inherited settings, go to week calc
-      return calculateTime_Week(m_default_week, year, getMonthAsInt(name));
+      // found the year at which the next session will occur
+      const SautoScheduleYear &year = years.at(i);
+      if(year.months == 0)
+      {
+         // the year was defined, but it had no month definitions. Must use the inherit-option
+         result = calculateTime_Week(year.year);
+         break;
+      }
+      else if(year.months & (1 << thisMonth))
+      {
+         // found the month, it is this current month
+         result = calculateTime_Month(year, thisMonth);
+         break;
+      }
+      else
+      {
+         const int nextMonth = m_schedule.firstMonth(year);
+         if (nextMonth > thisMonth)
+         {
+            // found the month, it is not this one, but one in the future
+            result = calculateTime_Month(year, nextMonth);
+         }
+         else
+         {
+            // this thread has no sessions in the future, all the defined months belong to the past.
+            // the thread should report that it is finished and stop.
+            result = false;
+         }
+      }
    }
 
-   QMap<int, CALENDAR_DATE> days = monthDef.second;
-   if (days.size() == 0)
+   return result;
+}
+
+bool Sauto::calculateTime_Month(const SautoScheduleYear &year, int month)
+{
+   const SautoScheduleMonth &monthDef = year.month[month];
+   if (monthDef.inherit || monthDef.days == 0)
    {
-      // this month does not have any days selected, inherit week settings
-      return calculateTime_Week(m_default_week, year, getMonthAsInt(name));
+      // this month uses inherited settings, or does not have any days selected, go to week calc
+      return calculateTime_Week(year.year, month);
    }
 
-   QMapIterator<int, CALENDAR_DATE> days_it(days);
-   // remember, the map is sorted, so the first day comes first
-   while(days_it.hasNext())
+   // the first selected day from today and on is the day of the next session
+   const SautoScheduleDay *day = m_schedule.nextDay(monthDef, m_day.date.day());
+   if (day == 0)
    {
-      days_it.next();
-      int dayNo = days_it.key();
-      CALENDAR_DATE date = days_it.value();
-      int currDay = QString("%1").arg(dayNo).right(2).toInt();
-      if(currDay >= today)
-      {
-         // found the day of the next session
-         QDate calDate = calendarDate_QDate(date);
-         INTERVAL_LIST intervals = date.second;
-         return calculateTime_Day(calDate, false, intervals);
-      }
+      // reaching this point means that the month has selected days, but they are all in the past
+      // this thread should report this, and stop
+      return false;
    }
-
-   // reaching this point means that the month has selected days, but they are all in the past
-   // this thread should report this, and stop
-   return false;
+   return calculateTime_Day(*day);
 }
 
-bool Sauto::calculateTime_Week(WEEK_DEF &week, int year, int month)
+bool Sauto::calculateTime_Week(int year, int month)
 {
-   if (week.size() == 0)
+   if (!m_schedule.hasWeek())
    {
-      return calculateTime_Intervals(m_default_intervals);
+      return calculateTime_Intervals(SCHEDULE_DEFAULT_LIST);
    }
 
-   QDateTime now = QDateTime::currentDateTime();
-   QDate date = now.date();
-   bool customDate = false;
-   int firstCustomDay = 0;
+   const QDate &today = m_day.date;
+   QDate date = today;
    if(year > 0 && month > 0)
    {
       date.setDate(year, month, 1);
-      while (now.date() > date)
+      if (today > date)
       {
-         date = date.addDays(1);
+         date = today;
       }
-      customDate = true;
-      firstCustomDay = date.dayOfWeek();
    }
 
-   int index = 0;
-   while(true)
+   // jump straight to the enabled days. A week from the first day covers every weekday, and today
+   // both with and without the current time, so a day that isn't found by then is never found
+   int index = m_schedule.daysToEnabledWeekday(date.dayOfWeek());
+   while(index >= 0 && index <= 7)
    {
       QDate checkDate = date.addDays(index);
-      int checkDay = checkDate.dayOfWeek();
-      if(week.contains(checkDay))
+      const int intervals = m_schedule.weekdayList(checkDate.dayOfWeek());
+      if(checkDate == today)
       {
-         DAY_OF_WEEK_DEF day = week[checkDay];
-         bool dayIsEnabled = dayIsToggled(day);
-         if(dayIsEnabled)
+         if (calculateTime_Intervals(intervals))
          {
-            INTERVAL_LIST intervals;
-            bool doInheritInterval = dayInheritsTime(day);
-            if (doInheritInterval)
-            {
-               intervals = m_default_intervals; //< inherit the default interval
-            }
-            else
-            {
-               intervals = day.second; //< use the interval provided
-               if (intervals.size() <= 0)
-               {
-                  intervals = m_default_intervals; //< the interval provided was invalid, so inherit the default interval instead
-               }
-            }
-            
-            if(checkDate == now.date())
-            {
-               if (calculateTime_Intervals(intervals))
-               {
-                  return true;
-               }
-               else
-               {
-                  ++index;
-                  continue;
-               }
-            }
-
-            if(calculateTime_Intervals(intervals, true))
-            {
-               QDateTime tomorrow(now.date().addDays(1), QTime(0,0,0));
-               quint64 msec_restOfToday = tomorrow.toMSecsSinceEpoch() - now.toMSecsSinceEpoch();
-               while(tomorrow.date() < checkDate)
-               {
-                  msecsToNextSession += msecsPer_Day;
-                  tomorrow = tomorrow.addDays(1);
-               }
-               msecsToNextSession += msec_restOfToday;
-               msecsToNextSession_original = msecsToNextSession;
-               return true;
-            }
+            return true;
          }
       }
+      else if(calculateTime_Intervals(intervals, true))
+      {
+         placeSession(checkDate);
+         return true;
+      }
 
       ++index;
+      index += m_schedule.daysToEnabledWeekday(date.addDays(index).dayOfWeek());
    }
-   return false; //< reaching here is an error !!
-
-
-   // ALTERNATIVE ALGORITHM : Starts on week-data day. Problem : can't count into next week
-   //bool lastToggled = false;
-   //WEEK_ITERATOR it(week);
-   //while(it.hasNext())
-   //{
-   //   it.next();
-   //   int dayOfWeek = it.key();
-
-   //   if(customDate && firstCustomDay != dayOfWeek && !lastToggled)
-   //   {
-   //      continue;
-   //   }
-
-   //   DAY_OF_WEEK_DEF day = it.value();
-
-   //   bool isToggled = day.get<0>();
-   //   if(!isToggled)
-   //   {
-   //      // this day is turned off
-   //      lastToggled = true;
-   //      continue;
-   //   }
-
-   //   // find the date corresponding to this day-of-week
-   //   if(date.dayOfWeek() > dayOfWeek) 
-   //   {
-   //      continue;
-   //   }
-   //   while(date.dayOfWeek() < dayOfWeek) 
-   //   {
-   //      date = date.addDays(1);
-   //   }
-
-   //   bool doInheritd         = day.get<1>();
-   //   INTERVAL_LIST intervals = day.get<2>();
-
-   //   if(doInheritd)
-   //   {
-   //      intervals = m_default_intervals;
-   //   }
-
-   //   if(date == now.date())
-   //   {
-   //      if(calculateTime_Intervals(intervals))
-   //      {
-   //         return true;
-   //      }
-   //      else
-   //      {
-   //         continue;
-   //      }
-   //   }
-
-   //   if(calculateTime_Intervals(intervals, true))
-   //   {
-   //      QDateTime tomorrow(now.date().addDays(1), QTime(0,0,0));
-   //      quint64 msec_restOfToday = tomorrow.toMSecsSinceEpoch() - now.toMSecsSinceEpoch();
-   //      while(tomorrow.date() < date)
-   //      {
-   //         msecsToNextSession += msecsPer_Day;
-   //         tomorrow = tomorrow.addDays(1);
-   //      }
-   //      msecsToNextSession += msec_restOfToday;
-   //      msecsToNextSession_original = msecsToNextSession;
-   //      return true;
-   //   }
-   //}
-
-   //return false;
-}
-
-bool Sauto::calculateTime_Day(const QDate &date, bool inherited, INTERVAL_LIST &interval)
+   return false;
+}
+
+bool Sauto::calculateTime_Day(const SautoScheduleDay &day)
 {
    bool iret = false;
-   if(inherited || interval.size() == 0)
-   {
-      // the condition means that caller has specifically asked that the interval be inherited from
-      // a lower level, OR the argument interval for this day doesnt contain any interval and therefore
-      // it must be inherited. 
-      if (m_default_week.size() == 0 || //< doesnt contain any specifications at all
-         !m_default_week.contains(date.dayOfWeek()) || //< doesnt contain specifications for this day
-         !dayIsToggled(m_default_week.value(date.dayOfWeek())) || //< day is toggled off
-         dayInheritsTime(m_default_week.value(date.dayOfWeek())) || //< this day is specified to inherit further down
-         m_default_week.value(date.dayOfWeek()).second.size() == 0) //< the week definition interval for this day had no entries
-      {
-         // this means that either there is no week definition, or it doesnt contain the
-         // definition for this specific day of the week OR the week-level of inheritance specifies this day
-         // to be toggled off or inherited (in which case the calendar priority "overrides" this and skips to next level of inheritance)
-         // The next level of inheritance is therefore the default intervals
-         return calculateTime_Intervals(m_default_intervals);
-      }
-      else
-      {
-         // inherit from the week definition
-         //return calculateTime_Intervals(m_default_week.value(date.dayOfWeek()).second.second, true, date);
-         INTERVAL_LIST weekIntervals = m_default_week.value(date.dayOfWeek()).second;
-         return calculateTime_Intervals(weekIntervals);
-      }
+   if(day.list < 0)
+   {
+      // the date doesnt contain any interval and therefore it must be inherited. The week definition
+      // for this day of the week is used, unless it is toggled off, inherited or empty, in which
+      // case the compiled week already refers to the default intervals
+      return calculateTime_Intervals(m_schedule.weekdayList(day.date.dayOfWeek()));
    }
    else
    {
-      if(date > QDateTime::currentDateTime().date())
+      if(day.date > m_day.date)
       {
-         iret = calculateTime_Intervals(interval, true);
-         msecsToNextSession_original += msecsToTomorrow();
-         QDateTime datetime(date, QTime(0,0,0,0));
-         bool ok = false;
-         int wholeDays = wholeDaysUntilEpochMS(datetime.toMSecsSinceEpoch(), ok);
-         if (ok)
+         iret = calculateTime_Intervals(day.list, true);
+         if (iret)
          {
-            msecsToNextSession_original += wholeDays * msecsPer_Day;
+            placeSession(day.date);
          }
-         msecsToNextSession = msecsToNextSession_original;
       }
       else
       {
-         iret = calculateTime_Intervals(interval);
+         iret = calculateTime_Intervals(day.list);
       }
    }
    return iret;
 }
 
-bool Sauto::calculateTime_Intervals(INTERVAL_LIST &interval, bool ignoreCurrentTime, bool lookTomorrow)
+//  A session that was found with the current time ignored starts at a time of the day, this moves
+//  it to that time of the argument day after today. The day is taken from the zone, so days that a
+//  change of the UTC offset shortens or lengthens are counted as they are
+void Sauto::placeSession(const QDate &date)
 {
-   if (interval.size() == 0)
+   const SautoDayContext day = m_zone.dayContext(date);
+   msecsToNextSession_original = day.toEpoch(msecsToNextSession_original) - m_now;
+   msecsToNextSession = msecsToNextSession_original;
+}
+
+bool Sauto::calculateTime_Intervals(int list, bool ignoreCurrentTime, bool lookTomorrow)
+{
+   const SautoScheduleList &intervals = m_schedule.list(list);
+   if (intervals.inherit)
    {
       return calculateTime_Frequency(m_default_freq, ignoreCurrentTime);
    }
 
-   QMap<int, int> startIdMap;
-   int i = -1;
+   // intervals that are invalid on their own were combined with the default frequency, or
+   // left out, when the schedule was compiled
+   const SautoModel *models = m_schedule.models(intervals);
+   int frontIndex = -1;
+   quint64 frontTime = 0;
    bool ok = false;
-   INTERVAL_ITERATOR_MUTABLE it(interval);
-   while(it.hasNext())
+   for (int i = 0; i < intervals.count; i++)
    {
-      ++i;
-      SautoModel intervalDef = it.next();
-      if(!intervalDef.isValid())
-      {
-         intervalDef.updateHasCustomInterval();
-         if(intervalDef.getHasCustomInterval() && m_default_freq.isValid())
-         {
-            // combine the interval with the default frequency
-            SautoModel combined = m_default_freq;
-            combined.setStartTimeMSecs(intervalDef.getStartTimeMSec());
-            combined.setDuration(intervalDef.getDuration());
-            combined.updateHasCustomInterval();
-            intervalDef = combined;
-            it.setValue(intervalDef);
-         }
-         else
-         {
-            continue;
-         }
-      }
-      quint64 time2next = intervalDef.calculateNextSession(ok, ignoreCurrentTime, lookTomorrow);
+      quint64 time2next = models[i].calculateNextSession(ok, ignoreCurrentTime, lookTomorrow, m_now, m_day);
       if (!ok)
       {
          continue;
       }
-      startIdMap.insert(time2next, i);
+
+      // on equal start times the last interval in the list is used
+      if (frontIndex < 0 || time2next <= frontTime)
+      {
+         frontTime = time2next;
+         frontIndex = i;
+      }
    }
 
-   if (startIdMap.size() <= 0)
+   if (frontIndex < 0)
    {
       return false;
    }
 
-   QMapIterator<int, int> indexIt(startIdMap);
-   indexIt.next();
-   msecsToNextSession_original = indexIt.key();
-   int frontIndex = indexIt.value();
-   
+   msecsToNextSession_original = frontTime;
    msecsToNextSession = msecsToNextSession_original;
-   m_current_freq = interval[frontIndex];
+   m_current_freq = models[frontIndex];
    hasNextSessionTime = true;
    m_eventType = intervalType_to_eventType(m_current_freq.getType());
 
    return true;
 }
 
-bool Sauto::calculateTime_Frequency(SautoModel &freq, bool ignoreCurrentTime)
+bool Sauto::calculateTime_Frequency(const SautoModel &freq, bool ignoreCurrentTime)
 {
    bool ok;
    bool localIgnoreTime = ignoreCurrentTime;
@@ -882,7 +1299,7 @@ bool Sauto::calculateTime_Frequency(SautoModel &freq, bool ignoreCurrentTime)
       localIgnoreTime = true;
    }
 
-   msecsToNextSession_original = freq.calculateNextSession(ok, localIgnoreTime);
+   msecsToNextSession_original = freq.calculateNextSession(ok, localIgnoreTime, false, m_now, m_day);
    if (!ok)
    {
       // unable to locate next session, meaning that it doesnt exist, or it is in the past
@@ -896,6 +1313,33 @@ bool Sauto::calculateTime_Frequency(SautoModel &freq, bool ignoreCurrentTime)
    return true;
 }
 
+//  The next minute that the cron expression matches in the zone of the clock. The expression is
+//  evaluated on the local timeline, a time that the zone skips fires at the transition, and a time
+//  that it repeats only fires the first time around
+bool Sauto::calculateTime_Cron()
+{
+   qint64 local = m_now + static_cast<qint64>(m_zone.offsetAt(m_now)) * 1000;
+   qint64 fire = m_now;
+   for (int i = 0; fire <= m_now || fire <= m_cronLast; i++)
+   {
+      local = m_cron.next(local);
+      if (local < 0 || i >= secsPer_Day / secsPer_Min)
+      {
+         hasNextSessionTime = false;
+         return false;
+      }
+      fire = m_zone.toUtc(local);
+   }
+
+   m_cronNext = fire;
+   m_current_freq.setStartTimeMSecs(local - floorDiv(local, msecsPer_Day) * msecsPer_Day);
+   m_eventType = EVENT_SINGLESHOT;
+   msecsToNextSession_original = fire - m_now;
+   msecsToNextSession = msecsToNextSession_original;
+   hasNextSessionTime = true;
+   return true;
+}
+
 EEventType sauto::intervalType_to_eventType(EIntervalType intervalType)
 {
    switch(intervalType)
@@ -41,19 +41,141 @@
 #include <QObject>
 #include <QString>
 #include <QTimer>
+#include <QVector>
 
 // solution includes
+#include <sautoModel/sautoCron.h>
 #include <sautoModel/sautoDefs.h>
+#include <sautoModel/sautoSchedule.h>
+#include <sautoModel/sautoZone.h>
+
+// local includes
+#include "sautoWheel.h"
 
 namespace sauto {
+
+   // lateness of the triggers, measured in msecs against the monotonic clock, and the triggers
+   // that did not run because the clock was held up, see ELatePolicy
+   struct SautoJitter
+   {
+      SautoJitter() : samples(0), last(0), max(0), total(0), fired(0), coalesced(0), skipped(0) {}
+      inline qreal mean() const { return samples > 0 ? static_cast<qreal>(total) / samples : 0; }
+      inline quint64 dropped() const { return coalesced + skipped; }
+      inline qreal dropRate() const { return fired + dropped() > 0 ? static_cast<qreal>(dropped()) / (fired + dropped()) : 0; }
+      void add(const SautoJitter &other);
+      quint64 samples;
+      qint64 last;
+      qint64 max;
+      qint64 total;
+      quint64 fired;
+      quint64 coalesced;
+      quint64 skipped;
+   };
+
+   // what a clock does with triggers that were due while it could not run, and with triggers that
+   // come within CLOCK_OVERLAP_MSEC of the one before
+   enum ELatePolicy
+   {
+      LATE_COALESCE , //< fire once for all of them
+      LATE_FIRE_ALL , //< fire every one of them, in order
+      LATE_SKIP     , //< fire none, and go on from the next one
+   };
+
+   static const int CLOCK_OVERLAP_MSEC = TRIGGER_SPACING_MSEC;
+
+   // the countdowns of a clock, taken so that another process can go on from them
+   struct SautoClockState
+   {
+      SautoClockState() : id(-1), wallTime(0), running(false), inSession(false), eventType(EVENT_UNDECIDED), wp(WP_NOT_SPECIFIED),
+         hasNextTriggerTime(false), msecsToNextTrigger(0), msecsToNextTrigger_original(0), hasDuration(false),
+         msecsDuration_original(0), msecsTimeLeft(0), sessionStartTime(0), msecsSinceTrigger(-1) {}
+      int id;
+      qint64 wallTime;           //< msecs since epoch when the countdowns were last advanced
+      bool running;
+      bool inSession;
+      quint8 eventType;
+      quint8 wp;
+      bool hasNextTriggerTime;
+      qint64 msecsToNextTrigger;
+      qint64 msecsToNextTrigger_original;
+      bool hasDuration;
+      qint64 msecsDuration_original;
+      qint64 msecsTimeLeft;
+      qint64 sessionStartTime;
+      qint64 msecsSinceTrigger;  //< -1 before the first trigger
+      SautoModel current;        //< the model of the session that is running
+   };
+
+   // the countdowns of a clock as of its last wakeup, for readers that poll instead of listening
+   // to the progress signals
+   struct SautoProgress
+   {
+      SautoProgress() : id(-1), running(false), inSession(false), hasNextSession(false), msecsToSession(0), msecsToSession_original(0),
+         hasNextTrigger(false), msecsToTrigger(0), msecsToTrigger_original(0), hasDuration(false), msecsLeft(0), msecsDuration(0) {}
+      int id;
+      bool running;
+      bool inSession;
+      bool hasNextSession;
+      qint64 msecsToSession;
+      qint64 msecsToSession_original;
+      bool hasNextTrigger;
+      qint64 msecsToTrigger;
+      qint64 msecsToTrigger_original;
+      bool hasDuration;
+      qint64 msecsLeft;
+      qint64 msecsDuration;
+   };
+
+   // a trigger as it is delivered in a batch, see SautoManager::setTriggerBatching()
+   struct SautoTriggerRecord
+   {
+      SautoTriggerRecord() : clockId(-1), task(SAUTO_NO_TASK), scheduledTime(0), actualTime(0) {}
+      inline QString taskID() const { return SautoTasks::name(task); }
+      int clockId;
+      SautoTaskId task;
+      qint64 scheduledTime; //< msecs since epoch when the trigger was due
+      qint64 actualTime;    //< msecs since epoch when the clock woke up to fire it
+   };
+
+   // what a clock did with a definition that was loaded again while it was running
+   enum EReload
+   {
+      RELOAD_UNCHANGED , //< the definition compiled to the schedule that the clock already had
+      RELOAD_SWAPPED   , //< the schedule was swapped in place and the countdowns were kept
+      RELOAD_REPLANNED , //< the current session is not in the new schedule, and was ended
+   };
+
    class Sauto : public QObject
    {
       Q_OBJECT
+      friend class SautoShard;
+      friend class SautoBench; //< only calls planNextSession()
 
    public:
       explicit Sauto(QObject *parent = 0);
       ~Sauto();
-      void init(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF  &def_calendar);
+      void init(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF  &def_calendar, const SautoZone &zone = SautoZone());
+      void setClockMode(EClockMode mode);
+      inline EClockMode clockMode() const { return m_clockMode; }
+      void setWheel(SautoWheel *wheel);
+      void setTimeSource(const SautoTimeSource *time);
+      void setTimeZone(const SautoZone &zone);
+      inline const SautoZone& timeZone() const { return m_zone; }
+      void setCron(const SautoCron &cron, const QString &taskID);
+      inline const SautoCron& cron() const { return m_cron; }
+      void setRecurrence(const SautoRecurrence &recurrence);
+      EReload reload(const SautoSchedule &schedule);
+      SautoClockState state() const;
+      void restore(const SautoClockState &state);
+      bool resume(ELatePolicy policy);
+      void setProgressInterval(int msecs);
+      inline int progressInterval() const { return m_progressInterval; }
+      SautoProgress progress() const;
+      inline void setTriggerBatch(QVector<SautoTriggerRecord> *batch) { m_triggerBatch = batch; }
+      inline void setLatePolicy(ELatePolicy policy) { m_latePolicy = policy; }
+      inline ELatePolicy latePolicy() const { return m_latePolicy; }
+      inline const SautoJitter& jitter() const { return m_jitter; }
+      inline const SautoSchedule& schedule() const { return m_schedule; }
 
    public slots:
       void stopClock(int id);
@@ -66,48 +188,77 @@ namespace sauto {
       void flushAll (int id);
       void triggered(int id);
       void triggered(int clockId, const QString &taskID);
+      void triggeredAt(int clockId, const QString &taskID, qint64 dueMSecsSinceEpoch);
+      void triggersDropped(int id, qint64 count);
       void timeToNextSession(int id, quint64 msecsLeft, quint64 msecsStarted, const QString &msg);
       void timeLeft(int id, quint64 msecsLeft, quint64 msecsStarted);
       void timeToNextTrigger(int id, quint64 msecsLeft, quint64 msecsStarted);
+      void clockAdjusted(int id, qint64 msecsJump);
 
    private slots:
       void timeout();
 
    private: 
-      void measureAccuracy();
       void analyzeDatasets();
-      void handleTimeDelay(qint64 msecs);
+      void advanceCountdowns(qint64 msecs);
+      void replan(qint64 msecsJump, qint64 msecsElapsed);
+      bool sessionUnaffected(const SautoSchedule &schedule) const;
+      void recordJitter(qint64 msecsLate);
+      void recordDropped(qint64 count, ELatePolicy policy);
+      void armDeadline();
+      void scheduleWakeup(qint64 msecs);
+      void cancelWakeup();
       void inSession();
       void outOfSession();
+      void updateDay();
+      bool planNextSession();
       void calculateTime_Session();
-      bool calculateTime_Calendar(CALENDAR_DEF &calendar);
-      bool calculateTime_Month(MONTH_DEF &months, const QString &name, int year);
-      bool calculateTime_Week(WEEK_DEF &week, int year = -1, int month = -1);
-      bool calculateTime_Day(const QDate &date, bool  inherited , INTERVAL_LIST &interval);
-      bool calculateTime_Intervals(INTERVAL_LIST &interval, bool ignoreCurrentTime = false, bool lookTomorrow = false);
-      bool calculateTime_Frequency(SautoModel  &freq, bool ignoreCurrentTime = false);
+      bool calculateTime_Recurrence();
+      bool calculateTime_Calendar();
+      bool calculateTime_Month(const SautoScheduleYear &year, int month);
+      bool calculateTime_Week(int year = -1, int month = -1);
+      bool calculateTime_Day(const SautoScheduleDay &day);
+      void placeSession(const QDate &date);
+      bool calculateTime_Intervals(int list, bool ignoreCurrentTime = false, bool lookTomorrow = false);
+      bool calculateTime_Frequency(const SautoModel &freq, bool ignoreCurrentTime = false);
+      bool calculateTime_Cron();
       void calculateTime_Trigger(SautoModel &freq);
       void onTrigger();
+      void fireTrigger();
+      void emitTrigger(SautoTaskId task, qint64 due);
+      qint64 catchUp(ELatePolicy policy);
       void onHasDuration();
 
    private:
+      EClockMode m_clockMode;
+      ELatePolicy m_latePolicy;
+      int m_progressInterval;
+      bool m_reportProgress;
+      qint64 m_lastProgress;
       EEventType m_eventType;
       EWavePoint m_wp;
-      int m_clockCD;
-      int m_clockAdjustInterv;
-      qint64 m_clockDiff;
-      qint64 m_clockStart;
-      qint64 m_clockStop;
       int m_clockCooldown;
       int m_id;
-      CALENDAR_DEF m_default_calendar;
-      WEEK_DEF m_default_week;
-      INTERVAL_LIST m_default_intervals;
+      bool m_running;
+      SautoSchedule m_schedule;
       SautoModel m_default_freq;
       SautoModel m_current_freq;
       bool isSingleSession;
       bool isInSession;
+      const SautoTimeSource *m_time;
       QTimer *m_timer;
+      SautoWheel *m_wheel;
+      SautoWheelEntry m_wheelEntry;
+      qint64 m_lastWake;
+      qint64 m_lastWall;
+      qint64 m_now;          //< wall clock of the calculation in progress
+      SautoZone m_zone;
+      SautoDayContext m_day; //< the day of m_now in the zone
+      SautoCron m_cron;      //< the schedule of a cron clock, which has no definitions
+      qint64 m_cronNext;     //< msecs since epoch of the next cron trigger
+      qint64 m_cronLast;     //< msecs since epoch of the last cron trigger that was fired
+      SautoJitter m_jitter;
+      QVector<SautoTriggerRecord> *m_triggerBatch;
       bool hasNextSessionTime;
       qint64 msecsToNextSession_original;
       qint64 msecsToNextSession;
@@ -36,11 +36,16 @@
 //h-//////////////////////////////////////////////////////////////////////////
 
 // Qt includes
+#include <QDir>
+#include <QElapsedTimer>
 #include <QMutexLocker>
 #include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent>
 #include <QtDebug>
 
 // solution includes
+#include <sautoXml/sautoBinary.h>
 #include <sautoXml/sautoXml.h>
 
 // local includes
@@ -48,25 +53,271 @@
 
 using namespace sauto;
 
-SautoManager::SautoManager(QObject *parent)
-   :QObject(parent)
+//  Shards on the calling thread are called directly, the others through their event loop, and
+//  the caller waits for them so that every call keeps its synchronous result
+static Qt::ConnectionType shardConnection(const SautoShard *shard)
+{
+   return shard->thread() == QThread::currentThread() ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
+}
+
+//  Runs on the thread pool, the clock file is read and checked but nothing is shared
+static SautoLoadedClock loadClock(const QString &fileName)
 {
+   SautoLoadedClock clock;
+   clock.fileName = fileName;
+   if (!loadClockFile(fileName, clock.frequency, clock.intervals, clock.week, clock.calendar, &clock.error))
+   {
+      if (clock.error.isEmpty())
+      {
+         clock.error = "Failed at loading";
+      }
+      return clock;
+   }
 
+   QString report;
+   if (!verifyScheduleSettings(clock.frequency, clock.intervals, clock.week, clock.calendar, report))
+   {
+      clock.error = report;
+   }
+   return clock;
+}
+
+//  The identity of a clock file is its path without the suffix, so that the XML and its compiled
+//  form are the same clock
+static QString clockFileKey(const QString &fileName)
+{
+   const QFileInfo info(fileName);
+   const QString dir = info.absoluteDir().canonicalPath();
+   return QString("%1/%2").arg(dir.isEmpty() ? info.absolutePath() : dir).arg(info.completeBaseName());
+}
+
+// a snapshot smaller than this is not compacted, the clocks are too few for it to pay off
+static const qint64 SNAPSHOT_MIN_COMPACT = 64 * 1024;
+
+//  Runs on the thread pool, a definition of a snapshot is decoded but nothing is shared
+static SautoLoadedClock decodeClock(const SautoSnapshotClock &snapshot)
+{
+   SautoLoadedClock clock;
+   clock.fileName = snapshot.fileKey;
+   SautoBinary reader;
+   if (!reader.readClockData(reinterpret_cast<const uchar*>(snapshot.definition.constData()), snapshot.definition.size(),
+      clock.frequency, clock.intervals, clock.week, clock.calendar))
+   {
+      clock.error = reader.errorString();
+   }
+   return clock;
+}
+
+SautoManager::SautoManager(QObject *parent)
+   :QObject(parent),
+   m_watcher(0),
+   m_checkpointTimer(0),
+   m_compactedSize(0),
+   m_threads(0),
+   m_clockMode(CLOCK_POLLING),
+   m_latePolicy(LATE_COALESCE),
+   m_progressInterval(0),
+   m_batching(false),
+   m_time(&systemTime())
+{
+   registerShardTypes();
+   startShards(0);
 }
 
 SautoManager::~SautoManager()
 {
-   
+   // the countdowns are checkpointed one last time before the clocks go
+   closeSnapshot();
+   stopShards();
+}
+
+//  Spreads the clocks over the argument number of worker threads, or keeps them on the thread of
+//  the manager when it is 0. Only possible while the manager has no clocks
+bool SautoManager::setThreadCount(int threads)
+{
+   QMutexLocker lock(&m_mutex);
+   if (!m_clocks.isEmpty())
+   {
+      return false;
+   }
+   stopShards();
+   startShards(qMax(0, threads));
+   return true;
+}
+
+void SautoManager::startShards(int threads)
+{
+   m_threads = threads;
+   const int shards = qMax(1, threads);
+   for (int i = 0; i < shards; i++)
+   {
+      SautoShard *shard = new SautoShard;
+      shard->setClockMode(m_clockMode);
+      shard->setTimeSource(m_time);
+      shard->setTriggerBatching(m_batching);
+      if (threads > 0)
+      {
+         QThread *worker = new QThread;
+         worker->setObjectName(QString("sauto shard %1").arg(i));
+         shard->moveToThread(worker);
+         worker->start();
+      }
+      else
+      {
+         shard->setParent(this);
+      }
+
+      connect(shard, SIGNAL(clockFinished(int, const QString &)),
+         this, SLOT(endReport(int, const QString &)));
+
+      connect(shard, SIGNAL(triggeredBatch(const QVector<sauto::SautoTriggerRecord> &)),
+         this, SLOT(shardTriggers(const QVector<sauto::SautoTriggerRecord> &)));
+
+      m_shards.append(shard);
+   }
+}
+
+void SautoManager::stopShards()
+{
+   for (int i = 0; i < m_shards.size(); i++)
+   {
+      SautoShard *shard = m_shards.at(i);
+      QThread *worker = shard->thread();
+      if (worker != thread())
+      {
+         // the clocks and timers are removed on their own thread before it is stopped
+         QMetaObject::invokeMethod(shard, "clear", Qt::BlockingQueuedConnection);
+         worker->quit();
+         worker->wait();
+         delete shard;
+         delete worker;
+      }
+      else
+      {
+         delete shard;
+      }
+   }
+   m_shards.clear();
+   m_clocks.clear();
+   m_tags.clear();
+   m_clockTags.clear();
+}
+
+SautoShard* SautoManager::shardOf(int id) const
+{
+   return m_shards.at(static_cast<int>(qHash(id) % static_cast<uint>(m_shards.size())));
+}
+
+//  The shards and the shard of a clock are looked up with the lock, and called after it is
+//  released. A blocking call waits for the slot that the shard is running, which may be connected
+//  to a clock and call the manager
+QVector<SautoShard*> SautoManager::shards() const
+{
+   QMutexLocker lock(&m_mutex);
+   return m_shards;
+}
+
+SautoShard* SautoManager::clockShard(int id) const
+{
+   QMutexLocker lock(&m_mutex);
+   return m_clocks.value(id, 0);
 }
 
+//  Adds a clock of the definitions. Returns false when there is a clock with the id already
 bool SautoManager::addClock(int id, const SautoModel  &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar)
+{
+   SautoShard *shard = 0;
+   Sauto *newClock = 0;
+   {
+      QMutexLocker lock(&m_mutex);
+      if (m_clocks.contains(id))
+      {
+         return false;
+      }
+      shard = shardOf(id);
+      newClock = createClock(id, def_frequency, def_intervals, def_week, def_calendar);
+      m_clocks.insert(id, shard);
+   }
+   adoptClocks(shard, QVector<Sauto*>(1, newClock));
+
+   return true;
+}
+
+//  Adds a clock that fires the task at every minute that the cron expression matches, in the time
+//  zone of new clocks. Cron clocks run on the shards like any other clock, but they have no
+//  definitions, so they are not recorded in the snapshot
+bool SautoManager::addClock(int id, const SautoCron &cron, const QString &taskID)
+{
+   if (!cron.isValid())
+   {
+      return false;
+   }
+
+   SautoShard *shard = 0;
+   Sauto *newClock = 0;
+   {
+      QMutexLocker lock(&m_mutex);
+      if (m_clocks.contains(id))
+      {
+         return false;
+      }
+      shard = shardOf(id);
+      newClock = createClock();
+      newClock->init(id, SautoModel(), INTERVAL_LIST(), WEEK_DEF(), CALENDAR_DEF(), m_zone);
+      newClock->setCron(cron, taskID);
+      m_clocks.insert(id, shard);
+   }
+   adoptClocks(shard, QVector<Sauto*>(1, newClock));
+
+   return true;
+}
+
+//  Adds a clock whose session days are selected by the recurrence rule instead of a calendar. The
+//  days use the intervals of their weekday from the week definition, or the default intervals.
+//  Like cron clocks, they are not recorded in the snapshot
+bool SautoManager::addClock(int id, const SautoRecurrence &recurrence, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week)
+{
+   if (!recurrence.isValid())
+   {
+      return false;
+   }
+
+   SautoShard *shard = 0;
+   Sauto *newClock = 0;
+   {
+      QMutexLocker lock(&m_mutex);
+      if (m_clocks.contains(id))
+      {
+         return false;
+      }
+      shard = shardOf(id);
+      newClock = createClock();
+      newClock->init(id, def_frequency, def_intervals, def_week, CALENDAR_DEF(), m_zone);
+      newClock->setRecurrence(recurrence);
+      m_clocks.insert(id, shard);
+   }
+   adoptClocks(shard, QVector<Sauto*>(1, newClock));
+
+   return true;
+}
+
+Sauto* SautoManager::createClock(int id, const SautoModel  &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar)
 {
    // create clock object and populate it with time-members
-   Sauto *newClock = new Sauto(this);
-   newClock->init(id, def_frequency, def_intervals, def_week, def_calendar);
+   Sauto *newClock = createClock();
+   newClock->init(id, def_frequency, def_intervals, def_week, def_calendar, m_zone);
+   recordDefinition(id, def_frequency, def_intervals, def_week, def_calendar);
+   return newClock;
+}
 
-   connect(newClock, SIGNAL(endReport(int, const QString &)), 
-      this, SLOT(endReport(int, const QString &)));
+//  A clock with the settings of the manager and its signals passed on, that is not yet initialized
+Sauto* SautoManager::createClock()
+{
+   Sauto *newClock = new Sauto;
+   newClock->setClockMode(m_clockMode);
+   newClock->setLatePolicy(m_latePolicy);
+   newClock->setProgressInterval(m_progressInterval);
+   newClock->setTimeSource(m_time);
 
    connect(newClock ,SIGNAL(triggered(int)), 
       this, SIGNAL(triggered(int)));
@@ -74,6 +325,12 @@ bool SautoManager::addClock(int id, const SautoModel  &def_frequency, const INTE
    connect(newClock, SIGNAL(triggered(int, const QString &)),
       this, SIGNAL(triggered(int, const QString &)));
 
+   connect(newClock, SIGNAL(triggeredAt(int, const QString &, qint64)),
+      this, SIGNAL(triggeredAt(int, const QString &, qint64)));
+
+   connect(newClock, SIGNAL(triggersDropped(int, qint64)),
+      this, SIGNAL(triggersDropped(int, qint64)));
+
    connect(newClock, SIGNAL(flushAll(int)), 
       this, SIGNAL(flushAll(int)));
 
@@ -89,104 +346,955 @@ bool SautoManager::addClock(int id, const SautoModel  &def_frequency, const INTE
    connect(newClock, SIGNAL(constantIntervals(int)), 
       this, SIGNAL(constantIntervals(int)));
 
-   connect(this, SIGNAL(stopClock_sig(int)),
-      newClock, SLOT(stopClock(int)));
+   connect(newClock, SIGNAL(clockAdjusted(int, qint64)),
+      this, SIGNAL(clockAdjusted(int, qint64)));
 
-   connect(this, SIGNAL(pauseClock_sig(int)),
-      newClock, SLOT(pauseClock(int)));
+   return newClock;
+}
 
-   connect(this, SIGNAL(startClock_sig(int)),
-      newClock, SLOT(startClock(int)));
+//  The shard takes the clocks over on its own thread and drives them from its wheel. Called
+//  without the lock, like every other call to a shard
+void SautoManager::adoptClocks(SautoShard *shard, const QVector<Sauto*> &clocks)
+{
+   for (int i = 0; i < clocks.size(); i++)
+   {
+      clocks.at(i)->moveToThread(shard->thread());
+   }
+   QMetaObject::invokeMethod(shard, "adopt", shardConnection(shard),
+      Q_ARG(QVector<sauto::Sauto*>, clocks));
+}
+
+//  Loads the argument clock files on the global thread pool, and adds the ones that loaded in
+//  one step. The clocks get the ids of their files, see clockId()
+SautoLoadReport SautoManager::loadClocks(const QStringList &fileNames, bool start)
+{
+   QElapsedTimer timer;
+   timer.start();
+   const QList<SautoLoadedClock> loaded = QtConcurrent::blockingMapped<QList<SautoLoadedClock> >(fileNames, loadClock);
+
+   SautoLoadReport report;
+   QSet<int> ids;
+   QHash<SautoShard*, QVector<Sauto*> > shardClocks;
+   {
+      QMutexLocker lock(&m_mutex);
+      for (int i = 0; i < loaded.size(); i++)
+      {
+         const SautoLoadedClock &clock = loaded.at(i);
+         SautoLoadResult result;
+         result.fileName = clock.fileName;
+         result.error = clock.error;
+         const int id = clock.error.isEmpty() ? fileId(clock.fileName) : -1;
+         if (id >= 0 && m_clocks.contains(id))
+         {
+            result.error = "The clock of the file is already loaded";
+         }
+         if (result.error.isEmpty())
+         {
+            SautoShard *shard = shardOf(id);
+            shardClocks[shard].append(createClock(id, clock.frequency, clock.intervals, clock.week, clock.calendar));
+            m_clocks.insert(id, shard);
+            ids.insert(id);
+            result.id = id;
+            report.loaded++;
+         }
+         else
+         {
+            report.failed++;
+         }
+         report.files.append(result);
+      }
+   }
 
-   m_clocks.insert(id, newClock);
+   QHashIterator<SautoShard*, QVector<Sauto*> > it(shardClocks);
+   while (it.hasNext())
+   {
+      it.next();
+      adoptClocks(it.key(), it.value());
+   }
 
+   if (start)
+   {
+      startClocks(ids);
+   }
+   report.msecs = timer.elapsed();
+   return report;
+}
+
+//  Loads every clock file of a directory. A compiled file is only loaded on its own when the XML
+//  that it was made from is gone, otherwise it is picked up through the XML
+SautoLoadReport SautoManager::loadClockDirectory(const QString &path, bool start)
+{
+   const QDir dir(path);
+   QStringList fileNames;
+   const QFileInfoList xmlFiles = dir.entryInfoList(QStringList() << "*.xml", QDir::Files, QDir::Name);
+   for (int i = 0; i < xmlFiles.size(); i++)
+   {
+      fileNames << xmlFiles.at(i).filePath();
+   }
+
+   const QFileInfoList binaryFiles = dir.entryInfoList(QStringList() << QString("*.%1").arg(SAUTO_BINARY_SUFFIX), QDir::Files, QDir::Name);
+   for (int i = 0; i < binaryFiles.size(); i++)
+   {
+      if (!dir.exists(binaryFiles.at(i).completeBaseName() + ".xml"))
+      {
+         fileNames << binaryFiles.at(i).filePath();
+      }
+   }
+   return loadClocks(fileNames, start);
+}
+
+//  The id of the clock of a file. It is made from a hash of the path, so the file has the same id
+//  every time it is loaded, also after the clock has been removed and in the next run of the
+//  application, unless another file had the id first
+int SautoManager::clockId(const QString &fileName)
+{
+   QMutexLocker lock(&m_mutex);
+   return fileId(fileName);
+}
+
+int SautoManager::fileId(const QString &fileName)
+{
+   const QString key = clockFileKey(fileName);
+   QHash<QString, int>::const_iterator it = m_fileIds.constFind(key);
+   if (it != m_fileIds.constEnd())
+   {
+      return it.value();
+   }
+
+   // ids are never negative, -1 means no clock
+   int id = static_cast<int>(qHash(key) & 0x7fffffff);
+   while (m_idFiles.contains(id) || m_clocks.contains(id))
+   {
+      id = (id + 1) & 0x7fffffff;
+   }
+   m_fileIds.insert(key, id);
+   m_idFiles.insert(id, key);
+   return id;
+}
+
+//  Reads a clock file again and hands the new definition to its clock, which keeps its countdowns
+//  as far as the change allows, see Sauto::reload(). A file without a running clock gets a new one,
+//  which is started. Returns the id of the clock, -1 when the file did not load
+int SautoManager::reloadClock(const QString &fileName)
+{
+   // only the argument file is read, and it is compiled before the clock is touched
+   const SautoLoadedClock loaded = loadClock(fileName);
+   if (!loaded.error.isEmpty())
+   {
+      emit reloadFailed(fileName, loaded.error);
+      return -1;
+   }
+   SautoSchedule schedule;
+   schedule.compile(loaded.frequency, loaded.intervals, loaded.week, loaded.calendar);
+
+   int id = -1;
+   int result = -1;
+   Sauto *newClock = 0;
+   SautoShard *shard = 0;
+   {
+      QMutexLocker lock(&m_mutex);
+      id = fileId(fileName);
+      shard = m_clocks.value(id, 0);
+      if (shard == 0)
+      {
+         shard = shardOf(id);
+         newClock = createClock(id, loaded.frequency, loaded.intervals, loaded.week, loaded.calendar);
+         m_clocks.insert(id, shard);
+      }
+   }
+
+   if (newClock != 0)
+   {
+      adoptClocks(shard, QVector<Sauto*>(1, newClock));
+      startClock(id);
+      return id;
+   }
+
+   QMetaObject::invokeMethod(shard, "reload", shardConnection(shard),
+      Q_RETURN_ARG(int, result),
+      Q_ARG(int, id),
+      Q_ARG(sauto::SautoSchedule*, &schedule));
+   if (result == RELOAD_SWAPPED || result == RELOAD_REPLANNED)
+   {
+      QMutexLocker lock(&m_mutex);
+      recordDefinition(id, loaded.frequency, loaded.intervals, loaded.week, loaded.calendar);
+   }
+
+   if (result < 0)
+   {
+      // the end report of the clock is still on its way to the manager
+      emit reloadFailed(fileName, "The clock finished while it was reloaded");
+      return -1;
+   }
+   else if (result != RELOAD_UNCHANGED)
+   {
+      emit clockReloaded(id, result == RELOAD_REPLANNED);
+   }
+   return id;
+}
+
+void SautoManager::startWatcher()
+{
+   if (m_watcher != 0)
+   {
+      return;
+   }
+   m_watcher = new QFileSystemWatcher(this);
+
+   connect(m_watcher, SIGNAL(fileChanged(const QString &)),
+      this, SLOT(clockFileChanged(const QString &)));
+
+   connect(m_watcher, SIGNAL(directoryChanged(const QString &)),
+      this, SLOT(clockDirectoryChanged(const QString &)));
+}
+
+//  Reloads the clock of the file whenever the file changes, and loads it now when it isn't loaded.
+//  The clock is stopped when the file is removed
+bool SautoManager::watchClockFile(const QString &fileName)
+{
+   if (!QFileInfo(fileName).exists())
+   {
+      return false;
+   }
+
+   startWatcher();
+   if (!m_watcher->files().contains(fileName))
+   {
+      m_watcher->addPath(fileName);
+   }
+   if (!hasClock(clockId(fileName)))
+   {
+      return reloadClock(fileName) >= 0;
+   }
    return true;
 }
 
+//  Watches every XML clock file of the directory, including the ones that are added to it later.
+//  The files that don't have a clock yet are loaded and started
+bool SautoManager::watchClockDirectory(const QString &path)
+{
+   if (!QFileInfo(path).isDir())
+   {
+      return false;
+   }
+
+   startWatcher();
+   if (!m_watcher->directories().contains(path))
+   {
+      m_watcher->addPath(path);
+   }
+   clockDirectoryChanged(path);
+   return true;
+}
+
+void SautoManager::clockFileChanged(const QString &path)
+{
+   if (QFileInfo(path).exists())
+   {
+      // saving through a temporary file replaces the file, which takes it off the watcher
+      if (!m_watcher->files().contains(path))
+      {
+         m_watcher->addPath(path);
+      }
+      reloadClock(path);
+      return;
+   }
+
+   int id = -1;
+   {
+      QMutexLocker lock(&m_mutex);
+      id = m_fileIds.value(clockFileKey(path), -1);
+   }
+   if (id >= 0)
+   {
+      stopClock(id);
+   }
+}
+
+//  Only the files that are new to the watcher are loaded, changes to the others come through
+//  clockFileChanged(). The compiled files that the manager writes itself are not clock files here
+void SautoManager::clockDirectoryChanged(const QString &path)
+{
+   const QFileInfoList files = QDir(path).entryInfoList(QStringList() << "*.xml", QDir::Files, QDir::Name);
+   const QSet<QString> watched = m_watcher->files().toSet();
+   QStringList added;
+   for (int i = 0; i < files.size(); i++)
+   {
+      const QString fileName = files.at(i).filePath();
+      if (!watched.contains(fileName))
+      {
+         added << fileName;
+      }
+   }
+   if (added.isEmpty())
+   {
+      return;
+   }
+
+   m_watcher->addPaths(added);
+   const SautoLoadReport report = loadClocks(added, true);
+   for (int i = 0; i < report.files.size(); i++)
+   {
+      const SautoLoadResult &result = report.files.at(i);
+      if (result.id < 0)
+      {
+         emit reloadFailed(result.fileName, result.error);
+      }
+   }
+}
+
+void SautoManager::setClockMode(EClockMode mode)
+{
+   {
+      QMutexLocker lock(&m_mutex);
+      m_clockMode = mode;
+   }
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "setClockMode", shardConnection(shardList.at(i)),
+         Q_ARG(int, mode));
+   }
+}
+
+//  Sets where the clocks read the time from. With a virtual time source the wheels are not driven
+//  by a timer, the owner advances the time and calls runExpired() itself
+void SautoManager::setTimeSource(const SautoTimeSource *time)
+{
+   {
+      QMutexLocker lock(&m_mutex);
+      m_time = time;
+   }
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "setTimeSource", shardConnection(shardList.at(i)),
+         Q_ARG(const sauto::SautoTimeSource*, time));
+   }
+}
+
+//  Milliseconds until the earliest armed clock expires, -1 when no clock is armed
+qint64 SautoManager::nextDeadline() const
+{
+   qint64 next = -1;
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      qint64 msecs = -1;
+      QMetaObject::invokeMethod(shardList.at(i), "nextDeadline", shardConnection(shardList.at(i)),
+         Q_RETURN_ARG(qint64, msecs));
+      if (msecs >= 0 && (next < 0 || msecs < next))
+      {
+         next = msecs;
+      }
+   }
+   return next;
+}
+
 bool SautoManager::hasClock(int id)
 {
    QMutexLocker lock(&m_mutex);
    return m_clocks.contains(id);
 }
 
-bool SautoManager::startClock(int id)
+bool SautoManager::jitter(int id, SautoJitter &stats)
+{
+   SautoShard *shard = clockShard(id);
+   bool found = false;
+   if (shard != 0)
+   {
+      QMetaObject::invokeMethod(shard, "jitter", shardConnection(shard),
+         Q_RETURN_ARG(bool, found),
+         Q_ARG(int, id),
+         Q_ARG(sauto::SautoJitter*, &stats));
+   }
+   return found;
+}
+
+//  The statistics of all the clocks together. A drop rate that grows means that the clocks are
+//  held up, by a busy event loop or too many clocks on too few threads
+SautoJitter SautoManager::totalJitter() const
+{
+   SautoJitter total;
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "totalJitter", shardConnection(shardList.at(i)),
+         Q_ARG(sauto::SautoJitter*, &total));
+   }
+   return total;
+}
+
+//  The policy of the clocks that are added from now on
+void SautoManager::setLatePolicy(ELatePolicy policy)
 {
    QMutexLocker lock(&m_mutex);
-   if(m_clocks.contains(id))
+   m_latePolicy = policy;
+}
+
+bool SautoManager::setLatePolicy(int id, ELatePolicy policy)
+{
+   SautoShard *shard = clockShard(id);
+   bool found = false;
+   if (shard != 0)
    {
-      emit startClock_sig(id);
-      return true;
+      QMetaObject::invokeMethod(shard, "setLatePolicy", shardConnection(shard),
+         Q_RETURN_ARG(bool, found),
+         Q_ARG(int, id),
+         Q_ARG(int, policy));
    }
-   return false;
+   return found;
 }
 
-void SautoManager::removeClock(int id)
+//  The time zone of the clocks that are added from now on, as an IANA id like "Europe/Oslo". An
+//  empty id is the local time of the host. Returns false for an id that is not known, the zone is
+//  then left as it was. The zones are not recorded to the snapshot, clocks that are restored from
+//  it are in this zone
+bool SautoManager::setTimeZone(const QByteArray &ianaId)
 {
-   if (!m_clocks.contains(id))
+   const SautoZone zone = SautoZone::find(ianaId);
+   if (!zone.isValid())
+   {
+      return false;
+   }
+   QMutexLocker lock(&m_mutex);
+   m_zone = zone;
+   return true;
+}
+
+bool SautoManager::setTimeZone(int id, const QByteArray &ianaId)
+{
+   SautoShard *shard = clockShard(id);
+   bool found = false;
+   if (shard != 0)
+   {
+      QMetaObject::invokeMethod(shard, "setTimeZone", shardConnection(shard),
+         Q_RETURN_ARG(bool, found),
+         Q_ARG(int, id),
+         Q_ARG(QByteArray, ianaId));
+   }
+   return found;
+}
+
+//  How often every clock reports its countdowns through timeToNextSession(), timeToNextTrigger() and
+//  timeLeft(), see Sauto::setProgressInterval(). Readers that only show the countdowns now and then
+//  can turn the signals off with a negative interval and read progress() instead
+void SautoManager::setProgressInterval(int msecs)
+{
+   {
+      QMutexLocker lock(&m_mutex);
+      m_progressInterval = msecs;
+   }
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "setProgressIntervals", shardConnection(shardList.at(i)),
+         Q_ARG(int, msecs));
+   }
+}
+
+bool SautoManager::setProgressInterval(int id, int msecs)
+{
+   SautoShard *shard = clockShard(id);
+   bool found = false;
+   if (shard != 0)
+   {
+      QMetaObject::invokeMethod(shard, "setProgressInterval", shardConnection(shard),
+         Q_RETURN_ARG(bool, found),
+         Q_ARG(int, id),
+         Q_ARG(int, msecs));
+   }
+   return found;
+}
+
+//  The countdowns of every clock in one batch
+QVector<SautoProgress> SautoManager::progress() const
+{
+   QVector<SautoProgress> progress;
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "progress", shardConnection(shardList.at(i)),
+         Q_ARG(QVector<sauto::SautoProgress>*, &progress));
+   }
+   return progress;
+}
+
+//  With batching the clocks don't emit triggered() and triggeredAt(), every trigger of one pass of
+//  the event loop is delivered in one triggeredBatch() instead, in the order that the shards ran them
+void SautoManager::setTriggerBatching(bool batching)
+{
+   {
+      QMutexLocker lock(&m_mutex);
+      m_batching = batching;
+   }
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "setTriggerBatching", shardConnection(shardList.at(i)),
+         Q_ARG(bool, batching));
+   }
+}
+
+void SautoManager::shardTriggers(const QVector<SautoTriggerRecord> &triggers)
+{
+   // the first batch of a pass schedules the delivery, the other shards join it
+   if (m_triggerBatch.isEmpty())
+   {
+      QMetaObject::invokeMethod(this, "flushTriggers", Qt::QueuedConnection);
+   }
+   m_triggerBatch += triggers;
+}
+
+void SautoManager::flushTriggers()
+{
+   if (m_triggerBatch.isEmpty())
    {
       return;
    }
+   QVector<SautoTriggerRecord> triggers;
+   triggers.swap(m_triggerBatch);
+   emit triggeredBatch(triggers);
+}
 
+bool SautoManager::schedule(int id, SautoSchedule &schedule)
+{
+   // the compiled schedule can be handed to a SautoQuery without touching the clock
+   SautoShard *shard = clockShard(id);
+   bool found = false;
+   if (shard != 0)
+   {
+      QMetaObject::invokeMethod(shard, "schedule", shardConnection(shard),
+         Q_RETURN_ARG(bool, found),
+         Q_ARG(int, id),
+         Q_ARG(sauto::SautoSchedule*, &schedule));
+   }
+   return found;
+}
+
+bool SautoManager::startClock(int id)
+{
+   SautoShard *shard = clockShard(id);
+   if (shard == 0)
+   {
+      return false;
+   }
+   bool started = false;
+   emit startClock_sig(id);
+   QMetaObject::invokeMethod(shard, "startClock", shardConnection(shard),
+      Q_RETURN_ARG(bool, started),
+      Q_ARG(int, id));
+   return started;
+}
+
+void SautoManager::removeClock(int id)
+{
+   // a stopped clock deletes itself
    stopClock(id);
+}
 
-   QMutexLocker lock(&m_mutex);
-   QMutableHashIterator<int, Sauto*> it(m_clocks);
-   while (it.hasNext())
+void SautoManager::stopClock(int id)
+{
+   SautoShard *shard = 0;
    {
-      it.next();
-      if (it.key() == id)
+      QMutexLocker lock(&m_mutex);
+      shard = m_clocks.take(id);
+      if (shard != 0)
       {
-         delete it.value();
-         it.remove();
-         return;
+         forgetClock(id);
       }
    }
+   if (shard != 0)
+   {
+      emit stopClock_sig(id);
+      QMetaObject::invokeMethod(shard, "stopClock", shardConnection(shard),
+         Q_ARG(int, id));
+   }
 }
 
-void SautoManager::stopClock(int id)
+void SautoManager::pauseClock(int id)
+{
+   SautoShard *shard = clockShard(id);
+   if (shard != 0)
+   {
+      emit pauseClock_sig(id);
+      QMetaObject::invokeMethod(shard, "pauseClock", shardConnection(shard),
+         Q_ARG(int, id));
+   }
+}
+
+void SautoManager::endReport(int id, const QString &str)
 {
    QMutexLocker lock(&m_mutex);
-   QMutableHashIterator<int, Sauto*> it(m_clocks);
-   while (it.hasNext())
+   m_clocks.remove(id);
+   forgetClock(id);
+   emit clockFinished(id, str);
+}
+
+int SautoManager::startClocks(const QSet<int> &ids)
+{
+   return controlClocks(ids, CONTROL_START);
+}
+
+int SautoManager::pauseClocks(const QSet<int> &ids)
+{
+   return controlClocks(ids, CONTROL_PAUSE);
+}
+
+int SautoManager::stopClocks(const QSet<int> &ids)
+{
+   return controlClocks(ids, CONTROL_STOP);
+}
+
+int SautoManager::startClocks(const QString &tag)
+{
+   return startClocks(clocksWithTag(tag));
+}
+
+int SautoManager::pauseClocks(const QString &tag)
+{
+   return pauseClocks(clocksWithTag(tag));
+}
+
+int SautoManager::stopClocks(const QString &tag)
+{
+   return stopClocks(clocksWithTag(tag));
+}
+
+//  Runs a bulk operation of the shards on the argument clocks, with one call for each shard that
+//  has any of them. Returns the number of clocks that were found
+int SautoManager::controlClocks(const QSet<int> &ids, EControl control)
+{
+   QHash<SautoShard*, QVector<int> > shardIds;
    {
-      it.next();
-      if (it.key() == id)
+      QMutexLocker lock(&m_mutex);
+      QSetIterator<int> it(ids);
+      while (it.hasNext())
       {
-         emit stopClock_sig(id);
-         it.remove();
-         return;
+         const int id = it.next();
+         SautoShard *shard = control == CONTROL_STOP ? m_clocks.take(id) : m_clocks.value(id, 0);
+         if (shard == 0)
+         {
+            continue;
+         }
+         if (control == CONTROL_STOP)
+         {
+            forgetClock(id);
+         }
+         shardIds[shard].append(id);
       }
    }
+
+   // the signals and the calls to the shards are made without the lock
+   QHashIterator<SautoShard*, QVector<int> > id_it(shardIds);
+   while (id_it.hasNext())
+   {
+      id_it.next();
+      const QVector<int> &shardClocks = id_it.value();
+      for (int i = 0; i < shardClocks.size(); i++)
+      {
+         switch (control)
+         {
+         case(CONTROL_START) :
+            emit startClock_sig(shardClocks.at(i));
+            break;
+
+         case(CONTROL_PAUSE) :
+            emit pauseClock_sig(shardClocks.at(i));
+            break;
+
+         case(CONTROL_STOP) :
+         default:
+            emit stopClock_sig(shardClocks.at(i));
+            break;
+         }
+      }
+   }
+
+   const char *method = control == CONTROL_START ? "startClocks" : control == CONTROL_PAUSE ? "pauseClocks" : "stopClocks";
+   int found = 0;
+   QHashIterator<SautoShard*, QVector<int> > shard_it(shardIds);
+   while (shard_it.hasNext())
+   {
+      shard_it.next();
+      int shardFound = 0;
+      QMetaObject::invokeMethod(shard_it.key(), method, shardConnection(shard_it.key()),
+         Q_RETURN_ARG(int, shardFound),
+         Q_ARG(QVector<int>, shard_it.value()));
+      found += shardFound;
+   }
+   return found;
 }
 
-void SautoManager::pauseClock(int id)
+//  Tags are only known to the manager, a clock can have any number of them
+bool SautoManager::tagClock(int id, const QString &tag)
+{
+   QMutexLocker lock(&m_mutex);
+   if (!m_clocks.contains(id))
+   {
+      return false;
+   }
+   QSet<int> &tagged = m_tags[tag];
+   if (!tagged.contains(id))
+   {
+      tagged.insert(id);
+      m_clockTags.insert(id, tag);
+   }
+   return true;
+}
+
+void SautoManager::untagClock(int id, const QString &tag)
+{
+   QMutexLocker lock(&m_mutex);
+   QHash<QString, QSet<int> >::iterator it = m_tags.find(tag);
+   if (it == m_tags.end() || !it.value().remove(id))
+   {
+      return;
+   }
+   if (it.value().isEmpty())
+   {
+      m_tags.erase(it);
+   }
+   m_clockTags.remove(id, tag);
+}
+
+QSet<int> SautoManager::clocksWithTag(const QString &tag)
 {
    QMutexLocker lock(&m_mutex);
-   QHashIterator<int, Sauto*> it(m_clocks);
+   return m_tags.value(tag);
+}
+
+void SautoManager::dropTags(int id)
+{
+   QMultiHash<int, QString>::iterator it = m_clockTags.find(id);
+   while (it != m_clockTags.end() && it.key() == id)
+   {
+      QHash<QString, QSet<int> >::iterator tag_it = m_tags.find(it.value());
+      if (tag_it != m_tags.end())
+      {
+         tag_it.value().remove(id);
+         if (tag_it.value().isEmpty())
+         {
+            m_tags.erase(tag_it);
+         }
+      }
+      it = m_clockTags.erase(it);
+   }
+}
+
+//  Everything the manager knows of a clock that has gone
+void SautoManager::forgetClock(int id)
+{
+   dropTags(id);
+   if (m_snapshot.isOpen())
+   {
+      m_snapshot.writeRemoval(id);
+   }
+}
+
+void SautoManager::recordDefinition(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar)
+{
+   if (m_snapshot.isOpen())
+   {
+      m_snapshot.writeDefinition(id, m_idFiles.value(id), SautoBinary().clockData(def_frequency, def_intervals, def_week, def_calendar));
+   }
+}
+
+//  Restores the clocks of a snapshot file, and records the clocks to it from then on: definitions
+//  as clocks are added and reloaded, and the countdowns of every clock at each checkpoint. Triggers
+//  that were due while the process was down are handled by the argument policy. Only possible while
+//  the manager has no clocks. Returns the number of clocks that were restored, -1 when the file is
+//  not a snapshot
+int SautoManager::openSnapshot(const QString &fileName, ELatePolicy policy, int checkpointMSecs)
+{
+   {
+      QMutexLocker lock(&m_mutex);
+      if (!m_clocks.isEmpty() || m_snapshot.isOpen())
+      {
+         return -1;
+      }
+   }
+
+   QHash<int, SautoSnapshotClock> found;
+   if (QFileInfo(fileName).exists() && !m_snapshot.read(fileName, found))
+   {
+      qCritical() << m_snapshot.errorString();
+      return -1;
+   }
+
+   // the definitions are decoded on the global thread pool, like clock files are loaded
+   const QList<SautoSnapshotClock> snapshots = found.values();
+   const QList<SautoLoadedClock> loaded = QtConcurrent::blockingMapped<QList<SautoLoadedClock> >(snapshots, decodeClock);
+
+   QSet<int> running;
+   int restored = 0;
+   QHash<SautoShard*, QVector<int> > resumed;
+   QHash<SautoShard*, QVector<Sauto*> > shardClocks;
+   {
+      QMutexLocker lock(&m_mutex);
+      for (int i = 0; i < snapshots.size(); i++)
+      {
+         const SautoSnapshotClock &snapshot = snapshots.at(i);
+         const SautoLoadedClock &clock = loaded.at(i);
+         if (!clock.error.isEmpty())
+         {
+            qWarning() << QString("Clock %1 was not restored : %2").arg(snapshot.id).arg(clock.error);
+            continue;
+         }
+
+         Sauto *newClock = createClock(snapshot.id, clock.frequency, clock.intervals, clock.week, clock.calendar);
+         if (snapshot.hasState)
+         {
+            newClock->restore(snapshot.state);
+         }
+         if (!snapshot.fileKey.isEmpty())
+         {
+            m_fileIds.insert(snapshot.fileKey, snapshot.id);
+            m_idFiles.insert(snapshot.id, snapshot.fileKey);
+         }
+
+         SautoShard *shard = shardOf(snapshot.id);
+         shardClocks[shard].append(newClock);
+         m_clocks.insert(snapshot.id, shard);
+         if (snapshot.hasState)
+         {
+            resumed[shard].append(snapshot.id);
+         }
+         if (!snapshot.hasState || snapshot.state.running)
+         {
+            running.insert(snapshot.id);
+         }
+         ++restored;
+      }
+   }
+
+   // the clocks are adopted and the missed triggers are fired by the shards without the lock,
+   // slots that are called for them may call the manager
+   QHashIterator<SautoShard*, QVector<Sauto*> > it(shardClocks);
    while (it.hasNext())
    {
       it.next();
-      if (it.key() == id)
+      adoptClocks(it.key(), it.value());
+   }
+   QVector<int> finished;
+   QHashIterator<SautoShard*, QVector<int> > resumed_it(resumed);
+   while (resumed_it.hasNext())
+   {
+      resumed_it.next();
+      QMetaObject::invokeMethod(resumed_it.key(), "resume", shardConnection(resumed_it.key()),
+         Q_ARG(QVector<int>, resumed_it.value()),
+         Q_ARG(int, policy),
+         Q_ARG(QVector<int>*, &finished));
+   }
+   if (!finished.isEmpty())
+   {
+      // the clocks that finished while the process was down
+      QMutexLocker lock(&m_mutex);
+      for (int i = 0; i < finished.size(); i++)
       {
-         emit pauseClock_sig(id);
-         return;
+         const int id = finished.at(i);
+         m_clocks.remove(id);
+         m_fileIds.remove(m_idFiles.take(id));
+         running.remove(id);
+         --restored;
       }
    }
+   startClocks(running);
+
+   {
+      // the file starts over with the clocks as they are now
+      const QVector<SautoClockState> states = clockStates();
+      QMutexLocker lock(&m_mutex);
+      if (!m_snapshot.open(fileName) || !m_snapshot.compact(states))
+      {
+         qCritical() << m_snapshot.errorString();
+         m_snapshot.close();
+         return restored;
+      }
+      m_compactedSize = m_snapshot.size();
+   }
+
+   if (m_checkpointTimer == 0)
+   {
+      m_checkpointTimer = new QTimer(this);
+      connect(m_checkpointTimer, SIGNAL(timeout()),
+         this, SLOT(checkpoint()));
+   }
+   if (checkpointMSecs > 0)
+   {
+      m_checkpointTimer->start(checkpointMSecs);
+   }
+   return restored;
 }
 
-void SautoManager::endReport(int id, const QString &str)
+void SautoManager::closeSnapshot()
 {
+   if (!m_snapshot.isOpen())
+   {
+      return;
+   }
+   checkpoint();
+   if (m_checkpointTimer != 0)
+   {
+      m_checkpointTimer->stop();
+   }
    QMutexLocker lock(&m_mutex);
-   QMutableHashIterator<int, Sauto*> it(m_clocks);
-   while (it.hasNext())
+   m_snapshot.close();
+}
+
+//  Appends the countdowns of every clock to the snapshot. Once the states that are out of date take
+//  up as much as the ones of the last compaction, the file is written again with only the new ones
+bool SautoManager::checkpoint()
+{
    {
-      it.next();
-      if (it.key() == id)
+      QMutexLocker lock(&m_mutex);
+      if (!m_snapshot.isOpen())
       {
-         it.remove();
+         return false;
       }
    }
-   emit clockFinished(id, str);
+
+   // the states are taken from the shards without the lock, the snapshot may have closed meanwhile
+   const QVector<SautoClockState> states = clockStates();
+   QMutexLocker lock(&m_mutex);
+   if (!m_snapshot.isOpen())
+   {
+      return false;
+   }
+   if (m_snapshot.size() > 2 * qMax<qint64>(m_compactedSize, SNAPSHOT_MIN_COMPACT))
+   {
+      const bool compacted = m_snapshot.compact(states);
+      m_compactedSize = m_snapshot.size();
+      return compacted;
+   }
+
+   for (int i = 0; i < states.size(); i++)
+   {
+      m_snapshot.writeState(states.at(i));
+   }
+   return m_snapshot.flush();
+}
+
+//  Called without the lock, like the other calls to every shard
+QVector<SautoClockState> SautoManager::clockStates() const
+{
+   QVector<SautoClockState> states;
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "states", shardConnection(shardList.at(i)),
+         Q_ARG(QVector<sauto::SautoClockState>*, &states));
+   }
+   return states;
+}
+
+void SautoManager::runExpired()
+{
+   const QVector<SautoShard*> shardList = shards();
+   for (int i = 0; i < shardList.size(); i++)
+   {
+      QMetaObject::invokeMethod(shardList.at(i), "runExpired", shardConnection(shardList.at(i)));
+   }
 }
 
 void SautoManager::setXml(const QString &xml)
@@ -203,14 +1311,21 @@ void SautoManager::setXml(const QString &xml)
    WEEK_DEF m_default_Week;
    CALENDAR_DEF m_default_Calendar;
  
-   SautoXml xmlReader(this);
-   if(!xmlReader.readClockFile(xml, m_default_Frequency, m_default_TimeIntervals, m_default_Week, m_default_Calendar))
+   // the compiled form of the file is used when it is up to date
+   if(!loadClockFile(xml, m_default_Frequency, m_default_TimeIntervals, m_default_Week, m_default_Calendar))
    {
       qCritical() << QString("Failed at loading");
       return;
    }
 
-   int newID = m_clocks.size();
+   // a file that already has a clock is loaded into it
+   const int newID = clockId(xml);
+   if (hasClock(newID))
+   {
+      reloadClock(xml);
+      return;
+   }
+
    if(!addClock(newID, m_default_Frequency, m_default_TimeIntervals, m_default_Week, m_default_Calendar))
    {
       qCritical() << QString("Failed at adding clock");
@@ -40,16 +40,58 @@
 
 // Qt includes
 #include <QObject>
+#include <QFileSystemWatcher>
 #include <QHash>
+#include <QMultiHash>
 #include <QMutex>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
 
 // solution includes
 #include <sautoModel/sautoDefs.h>
 
 // local includes
 #include "sauto.h"
+#include "sautoShard.h"
+#include "sautoSnapshot.h"
 
 namespace sauto {
+
+   // a clock file that has been read on the thread pool, and is not added yet
+   struct SautoLoadedClock
+   {
+      QString fileName;
+      QString error; //< empty when the file loaded and passed the checks
+      SautoModel frequency;
+      INTERVAL_LIST intervals;
+      WEEK_DEF week;
+      CALENDAR_DEF calendar;
+   };
+
+   struct SautoLoadResult
+   {
+      SautoLoadResult() : id(-1) {}
+      QString fileName;
+      int id;        //< -1 when the file was not loaded
+      QString error;
+   };
+
+   struct SautoLoadReport
+   {
+      SautoLoadReport() : loaded(0), failed(0), msecs(0) {}
+      inline qreal filesPerSec() const { return msecs > 0 ? 1000.0 * (loaded + failed) / msecs : 0; }
+      QList<SautoLoadResult> files;
+      int loaded;
+      int failed;
+      qint64 msecs;
+   };
+
+   // Clocks are spread over shards by their id. Without worker threads there is one shard on the
+   // thread of the manager, with worker threads there is one shard on each of them, and the
+   // signals of the clocks reach the manager through queued connections
    class SautoManager : public QObject
    {
       Q_OBJECT
@@ -60,7 +102,39 @@ namespace sauto {
       void removeClock(int id);
       void pauseClock(int id);
       void stopClock(int id);
+      int startClocks(const QSet<int> &ids);
+      int pauseClocks(const QSet<int> &ids);
+      int stopClocks(const QSet<int> &ids);
+      int startClocks(const QString &tag);
+      int pauseClocks(const QString &tag);
+      int stopClocks(const QString &tag);
+      bool tagClock(int id, const QString &tag);
+      void untagClock(int id, const QString &tag);
+      QSet<int> clocksWithTag(const QString &tag);
+      bool setThreadCount(int threads);
+      inline int threadCount() const { return m_threads; }
+      void setClockMode(EClockMode mode);
+      inline EClockMode clockMode() const { return m_clockMode; }
+      void setTimeSource(const SautoTimeSource *time);
+      inline const SautoTimeSource* timeSource() const { return m_time; }
+      qint64 nextDeadline() const;
+      void runExpired();
       bool hasClock(int id);
+      bool jitter(int id, SautoJitter &stats);
+      SautoJitter totalJitter() const;
+      void setLatePolicy(ELatePolicy policy);
+      inline ELatePolicy latePolicy() const { return m_latePolicy; }
+      bool setLatePolicy(int id, ELatePolicy policy);
+      bool setTimeZone(const QByteArray &ianaId);
+      inline QByteArray timeZone() const { return m_zone.id(); }
+      bool setTimeZone(int id, const QByteArray &ianaId);
+      void setProgressInterval(int msecs);
+      inline int progressInterval() const { return m_progressInterval; }
+      bool setProgressInterval(int id, int msecs);
+      QVector<SautoProgress> progress() const;
+      void setTriggerBatching(bool batching);
+      inline bool triggerBatching() const { return m_batching; }
+      bool schedule(int id, SautoSchedule &schedule);
       bool startClock(int id);
       bool addClock(
          int id,
@@ -69,8 +143,19 @@ namespace sauto {
          const WEEK_DEF &def_week,
          const CALENDAR_DEF &def_calendar
          );
+      bool addClock(int id, const SautoCron &cron, const QString &taskID);
+      bool addClock(int id, const SautoRecurrence &recurrence, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week);
+      SautoLoadReport loadClocks(const QStringList &fileNames, bool start = true);
+      SautoLoadReport loadClockDirectory(const QString &path, bool start = true);
+      int clockId(const QString &fileName);
+      int reloadClock(const QString &fileName);
+      bool watchClockFile(const QString &fileName);
+      bool watchClockDirectory(const QString &path);
+      int openSnapshot(const QString &fileName, ELatePolicy policy = LATE_COALESCE, int checkpointMSecs = 60000);
+      void closeSnapshot();
 
    signals:
+      // emitted for every clock that is controlled, the clocks themselves are not connected to them
       void stopClock_sig(int id);
       void pauseClock_sig(int id);
       void startClock_sig(int id);
@@ -79,19 +164,71 @@ namespace sauto {
       void flushAll (int id);
       void triggered(int id);
       void triggered(int clockId, const QString &taskID);
+      void triggeredAt(int clockId, const QString &taskID, qint64 dueMSecsSinceEpoch);
+      void triggersDropped(int id, qint64 count);
+      void triggeredBatch(const QVector<sauto::SautoTriggerRecord> &triggers);
       void timeToNextSession(int id, quint64 msecsLeft, quint64 msecsStarted, const QString &msg);
       void timeLeft(int id, quint64 msecsLeft, quint64 msecsStarted);
       void timeToNextTrigger(int id, quint64 msecsLeft, quint64 msecsStarted);
+      void clockAdjusted(int id, qint64 msecsJump);
+      void clockReloaded(int id, bool replanned);
+      void reloadFailed(const QString &fileName, const QString &error);
 
    public slots:
       void setXml(const QString &xml);
+      bool checkpoint();
 
    private slots:
       void endReport(int id, const QString &str);
+      void clockFileChanged(const QString &path);
+      void clockDirectoryChanged(const QString &path);
+      void shardTriggers(const QVector<sauto::SautoTriggerRecord> &triggers);
+      void flushTriggers();
+
+   private:
+      enum EControl
+      {
+         CONTROL_START ,
+         CONTROL_PAUSE ,
+         CONTROL_STOP  ,
+      };
+
+      void startShards(int threads);
+      void stopShards();
+      SautoShard* shardOf(int id) const;
+      QVector<SautoShard*> shards() const;
+      SautoShard* clockShard(int id) const;
+      Sauto* createClock(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar);
+      Sauto* createClock();
+      void adoptClocks(SautoShard *shard, const QVector<Sauto*> &clocks);
+      int controlClocks(const QSet<int> &ids, EControl control);
+      void dropTags(int id);
+      void forgetClock(int id);
+      void recordDefinition(int id, const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar);
+      QVector<SautoClockState> clockStates() const;
+      int fileId(const QString &fileName);
+      void startWatcher();
 
    private: // members
-      QMutex m_mutex;
-      QHash<int, Sauto*> m_clocks;
+      mutable QMutex m_mutex;
+      QHash<int, SautoShard*> m_clocks;
+      QVector<SautoShard*> m_shards;
+      QHash<QString, QSet<int> > m_tags;
+      QMultiHash<int, QString> m_clockTags;
+      QHash<QString, int> m_fileIds;
+      QHash<int, QString> m_idFiles;
+      QFileSystemWatcher *m_watcher;
+      SautoSnapshot m_snapshot;
+      QTimer *m_checkpointTimer;
+      qint64 m_compactedSize;
+      int m_threads;
+      EClockMode m_clockMode;
+      ELatePolicy m_latePolicy;
+      SautoZone m_zone;
+      int m_progressInterval;
+      bool m_batching;
+      QVector<SautoTriggerRecord> m_triggerBatch;
+      const SautoTimeSource *m_time;
 
    };
 }
@@ -0,0 +1,417 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoShard.cpp
+//
+//  \brief     Implementation of a group of clocks that share one thread and one timing wheel
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// local includes
+#include "sautoShard.h"
+
+using namespace sauto;
+
+SautoShard::SautoShard(QObject *parent)
+   :QObject(parent),
+   m_clockMode(CLOCK_POLLING),
+   m_time(&systemTime()),
+   m_wheelTimer(0),
+   m_batching(false)
+{
+   // one timer drives every clock of the shard, it is always armed for the earliest entry in the wheel
+   m_wheelTimer = new QTimer(this);
+   m_wheelTimer->setTimerType(Qt::PreciseTimer);
+   m_wheelTimer->setSingleShot(true);
+
+   connect(m_wheelTimer, SIGNAL(timeout()),
+      this, SLOT(wheelTimeout()));
+}
+
+SautoShard::~SautoShard()
+{
+   clear();
+}
+
+//  Takes over clocks that have been moved to the thread of the shard
+void SautoShard::adopt(const QVector<Sauto*> &clocks)
+{
+   m_clocks.reserve(m_clocks.size() + clocks.size());
+   for (int i = 0; i < clocks.size(); i++)
+   {
+      Sauto *clock = clocks.at(i);
+      clock->setParent(this);
+      clock->setWheel(&m_wheel);
+      clock->setTriggerBatch(m_batching ? &m_triggerBatch : 0);
+
+      // control goes straight to the clock through the hash, so it is not connected to any signal
+      connect(clock, SIGNAL(endReport(int, const QString &)),
+         this, SLOT(endReport(int, const QString &)));
+
+      m_clocks.insert(clock->m_id, clock);
+   }
+}
+
+//  Handles the triggers that were due while the process was down for clocks that were restored
+//  from a snapshot, now that they are on the thread of the shard. The clocks that have nothing
+//  left to do are deleted and added to the finished list
+void SautoShard::resume(const QVector<int> &ids, int policy, QVector<int> *finished)
+{
+   for (int i = 0; i < ids.size(); i++)
+   {
+      Sauto *clock = m_clocks.value(ids.at(i), 0);
+      if (clock != 0 && !clock->resume(static_cast<ELatePolicy>(policy)))
+      {
+         m_clocks.remove(ids.at(i));
+         delete clock;
+         finished->append(ids.at(i));
+      }
+   }
+   flushTriggers();
+}
+
+bool SautoShard::startClock(int id)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return false;
+   }
+   clock->startClock(id);
+   armWheel();
+   return true;
+}
+
+void SautoShard::pauseClock(int id)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock != 0)
+   {
+      clock->pauseClock(id);
+      armWheel();
+   }
+}
+
+void SautoShard::stopClock(int id)
+{
+   // the clock deletes itself once it has stopped
+   Sauto *clock = m_clocks.take(id);
+   if (clock != 0)
+   {
+      clock->stopClock(id);
+      armWheel();
+   }
+}
+
+//  The bulk operations return how many of the argument clocks were found, and arm the timer once
+int SautoShard::startClocks(const QVector<int> &ids)
+{
+   int found = 0;
+   for (int i = 0; i < ids.size(); i++)
+   {
+      Sauto *clock = m_clocks.value(ids.at(i), 0);
+      if (clock != 0)
+      {
+         clock->startClock(ids.at(i));
+         ++found;
+      }
+   }
+   armWheel();
+   return found;
+}
+
+int SautoShard::pauseClocks(const QVector<int> &ids)
+{
+   int found = 0;
+   for (int i = 0; i < ids.size(); i++)
+   {
+      Sauto *clock = m_clocks.value(ids.at(i), 0);
+      if (clock != 0)
+      {
+         clock->pauseClock(ids.at(i));
+         ++found;
+      }
+   }
+   armWheel();
+   return found;
+}
+
+int SautoShard::stopClocks(const QVector<int> &ids)
+{
+   int found = 0;
+   for (int i = 0; i < ids.size(); i++)
+   {
+      Sauto *clock = m_clocks.take(ids.at(i));
+      if (clock != 0)
+      {
+         clock->stopClock(ids.at(i));
+         ++found;
+      }
+   }
+   armWheel();
+   return found;
+}
+
+//  Deletes every clock and stops the timer, so that the shard can be deleted after its thread has finished
+void SautoShard::clear()
+{
+   qDeleteAll(m_clocks);
+   m_clocks.clear();
+   m_wheelTimer->stop();
+}
+
+void SautoShard::setClockMode(int mode)
+{
+   m_clockMode = static_cast<EClockMode>(mode);
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      it.value()->setClockMode(m_clockMode);
+   }
+   armWheel();
+}
+
+void SautoShard::setTimeSource(const SautoTimeSource *time)
+{
+   m_time = time;
+   m_wheel.setTimeSource(time);
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      it.value()->setTimeSource(time);
+   }
+   armWheel();
+}
+
+bool SautoShard::jitter(int id, SautoJitter *stats)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return false;
+   }
+   *stats = clock->jitter();
+   return true;
+}
+
+//  Adds the statistics of every clock of the shard to the argument ones
+void SautoShard::totalJitter(SautoJitter *total) const
+{
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      total->add(it.value()->jitter());
+   }
+}
+
+bool SautoShard::setLatePolicy(int id, int policy)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return false;
+   }
+   clock->setLatePolicy(static_cast<ELatePolicy>(policy));
+   return true;
+}
+
+//  The zone tables are shared by every clock in a zone, so they are found here rather than copied
+//  across threads
+bool SautoShard::setTimeZone(int id, const QByteArray &ianaId)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return false;
+   }
+   const SautoZone zone = SautoZone::find(ianaId);
+   if (!zone.isValid())
+   {
+      return false;
+   }
+   clock->setTimeZone(zone);
+   armWheel();
+   return true;
+}
+
+bool SautoShard::setProgressInterval(int id, int msecs)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return false;
+   }
+   clock->setProgressInterval(msecs);
+   armWheel();
+   return true;
+}
+
+void SautoShard::setProgressIntervals(int msecs)
+{
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      it.value()->setProgressInterval(msecs);
+   }
+   armWheel();
+}
+
+//  Appends the countdowns of every clock of the shard
+void SautoShard::progress(QVector<SautoProgress> *progress) const
+{
+   progress->reserve(progress->size() + m_clocks.size());
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      progress->append(it.value()->progress());
+   }
+}
+
+bool SautoShard::schedule(int id, SautoSchedule *schedule)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return false;
+   }
+   *schedule = clock->schedule();
+   return true;
+}
+
+//  Hands a schedule that was compiled on the calling thread to the clock, returns the EReload of
+//  the clock or -1 when it is not in the shard
+int SautoShard::reload(int id, SautoSchedule *schedule)
+{
+   Sauto *clock = m_clocks.value(id, 0);
+   if (clock == 0)
+   {
+      return -1;
+   }
+   const EReload result = clock->reload(*schedule);
+   armWheel();
+   return result;
+}
+
+//  Appends the whole state of every clock of the shard, as it is written to the snapshot
+void SautoShard::states(QVector<SautoClockState> *states) const
+{
+   states->reserve(states->size() + m_clocks.size());
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      states->append(it.value()->state());
+   }
+}
+
+//  Milliseconds until the earliest armed clock of the shard expires, -1 when no clock is armed
+qint64 SautoShard::nextDeadline() const
+{
+   return m_wheel.nextExpiry();
+}
+
+void SautoShard::runExpired()
+{
+   // clocks re-arm themselves from inside their timeout, so only the expired ones are run here
+   m_wheel.advance();
+   SautoWheelEntry *entry = 0;
+   while ((entry = m_wheel.takeExpired()) != 0)
+   {
+      entry->clock->timeout();
+   }
+   flushTriggers();
+   armWheel();
+}
+
+//  Clocks that deliver their triggers in batches add them to the shard while it runs the wheel,
+//  and the shard hands them over once per run
+void SautoShard::setTriggerBatching(bool batching)
+{
+   m_batching = batching;
+   QHashIterator<int, Sauto*> it(m_clocks);
+   while (it.hasNext())
+   {
+      it.next();
+      it.value()->setTriggerBatch(batching ? &m_triggerBatch : 0);
+   }
+   flushTriggers();
+}
+
+void SautoShard::flushTriggers()
+{
+   if (m_triggerBatch.isEmpty())
+   {
+      return;
+   }
+   QVector<SautoTriggerRecord> triggers;
+   triggers.swap(m_triggerBatch);
+   emit triggeredBatch(triggers);
+}
+
+void SautoShard::endReport(int id, const QString &str)
+{
+   m_clocks.remove(id);
+   emit clockFinished(id, str);
+}
+
+void SautoShard::wheelTimeout()
+{
+   runExpired();
+}
+
+void SautoShard::armWheel()
+{
+   const qint64 msecs = m_wheel.nextExpiry();
+   if (msecs < 0 || m_time->isVirtual())
+   {
+      m_wheelTimer->stop();
+      return;
+   }
+   m_wheelTimer->start(static_cast<int>(qMin<qint64>(msecs, msecsPer_Day)));
+}
+
+//  The types that the manager passes to the slots of a shard on another thread
+void sauto::registerShardTypes()
+{
+   qRegisterMetaType<QVector<sauto::Sauto*> >("QVector<sauto::Sauto*>");
+   qRegisterMetaType<const sauto::SautoTimeSource*>("const sauto::SautoTimeSource*");
+   qRegisterMetaType<sauto::SautoJitter*>("sauto::SautoJitter*");
+   qRegisterMetaType<sauto::SautoSchedule*>("sauto::SautoSchedule*");
+   qRegisterMetaType<QVector<int> >("QVector<int>");
+   qRegisterMetaType<QVector<int>*>("QVector<int>*");
+   qRegisterMetaType<QVector<sauto::SautoClockState>*>("QVector<sauto::SautoClockState>*");
+   qRegisterMetaType<QVector<sauto::SautoProgress>*>("QVector<sauto::SautoProgress>*");
+   qRegisterMetaType<QVector<sauto::SautoTriggerRecord> >("QVector<sauto::SautoTriggerRecord>");
+}
@@ -0,0 +1,125 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoShard.h
+//
+//  \brief     Definition of a group of clocks that share one thread and one timing wheel
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_SHARD_H
+#define _SAUTO_SHARD_H
+
+// Qt includes
+#include <QObject>
+#include <QHash>
+#include <QMetaType>
+#include <QTimer>
+#include <QVector>
+
+// local includes
+#include "sauto.h"
+#include "sautoWheel.h"
+
+namespace sauto {
+
+   // A group of clocks that live on the same thread and are driven by the same timing wheel.
+   // The manager owns one shard per worker thread, or a single one on its own thread when it
+   // runs without workers. Every slot must run on the thread of the shard, the manager calls
+   // them directly or through a blocking queued connection. Argument types are spelled out
+   // with their namespace so that they can be invoked by name.
+   class SautoShard : public QObject
+   {
+      Q_OBJECT
+
+   public:
+      explicit SautoShard(QObject *parent = 0);
+      ~SautoShard();
+
+   public slots:
+      void adopt(const QVector<sauto::Sauto*> &clocks);
+      void resume(const QVector<int> &ids, int policy, QVector<int> *finished);
+      bool startClock(int id);
+      void pauseClock(int id);
+      void stopClock(int id);
+      int startClocks(const QVector<int> &ids);
+      int pauseClocks(const QVector<int> &ids);
+      int stopClocks(const QVector<int> &ids);
+      void clear();
+      void setClockMode(int mode);
+      void setTimeSource(const sauto::SautoTimeSource *time);
+      bool jitter(int id, sauto::SautoJitter *stats);
+      void totalJitter(sauto::SautoJitter *total) const;
+      bool setLatePolicy(int id, int policy);
+      bool setTimeZone(int id, const QByteArray &ianaId);
+      bool setProgressInterval(int id, int msecs);
+      void setProgressIntervals(int msecs);
+      void progress(QVector<sauto::SautoProgress> *progress) const;
+      void setTriggerBatching(bool batching);
+      bool schedule(int id, sauto::SautoSchedule *schedule);
+      int reload(int id, sauto::SautoSchedule *schedule);
+      void states(QVector<sauto::SautoClockState> *states) const;
+      qint64 nextDeadline() const;
+      void runExpired();
+
+   signals:
+      void clockFinished(int id, const QString &endReport);
+      void triggeredBatch(const QVector<sauto::SautoTriggerRecord> &triggers);
+
+   private slots:
+      void endReport(int id, const QString &str);
+      void wheelTimeout();
+
+   private:
+      void armWheel();
+      void flushTriggers();
+
+   private:
+      QHash<int, Sauto*> m_clocks;
+      EClockMode m_clockMode;
+      const SautoTimeSource *m_time;
+      SautoWheel m_wheel;
+      QTimer *m_wheelTimer;
+      bool m_batching;
+      QVector<SautoTriggerRecord> m_triggerBatch;
+   };
+
+   void registerShardTypes();
+}
+
+Q_DECLARE_METATYPE(sauto::SautoTriggerRecord)
+Q_DECLARE_METATYPE(const sauto::SautoTimeSource*)
+Q_DECLARE_METATYPE(sauto::SautoJitter*)
+Q_DECLARE_METATYPE(sauto::SautoSchedule*)
+Q_DECLARE_METATYPE(QVector<int>*)
+Q_DECLARE_METATYPE(QVector<sauto::SautoClockState>*)
+Q_DECLARE_METATYPE(QVector<sauto::SautoProgress>*)
+
+#endif
@@ -0,0 +1,89 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoSimulator.cpp
+//
+//  \brief     Implementation of a discrete-event simulator that runs clocks in virtual time
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// Qt includes
+#include <QCoreApplication>
+#include <QEvent>
+
+// local includes
+#include "sautoSimulator.h"
+
+using namespace sauto;
+
+SautoSimulator::SautoSimulator(qint64 startMSecsSinceEpoch, QObject *parent)
+   :QObject(parent),
+   m_time(startMSecsSinceEpoch),
+   m_manager(0)
+{
+   m_manager = new SautoManager(this);
+   m_manager->setTimeSource(&m_time);
+   m_manager->setClockMode(CLOCK_DEADLINE);
+}
+
+SautoSimulator::~SautoSimulator()
+{
+   // the clocks must not outlive the time they read from
+   delete m_manager;
+}
+
+//  Runs every clock up to the argument time and returns the number of wakeups. The time stops at
+//  each deadline on the way, so the clocks see exactly the times they asked for
+quint64 SautoSimulator::runUntil(qint64 msecsSinceEpoch)
+{
+   quint64 wakeups = 0;
+   while (true)
+   {
+      const qint64 msecs = m_manager->nextDeadline();
+      if (msecs < 0 || m_time.currentMSecsSinceEpoch() + msecs > msecsSinceEpoch)
+      {
+         break;
+      }
+      m_time.advance(msecs);
+      m_manager->runExpired();
+      ++wakeups;
+
+      // clocks that have finished delete themselves later, which needs an event loop
+      QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+   }
+
+   m_time.advance(msecsSinceEpoch - m_time.currentMSecsSinceEpoch());
+   return wakeups;
+}
+
+quint64 SautoSimulator::runFor(qint64 msecs)
+{
+   return runUntil(m_time.currentMSecsSinceEpoch() + msecs);
+}
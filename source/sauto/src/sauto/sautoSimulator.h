@@ -0,0 +1,78 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoSimulator.h
+//
+//  \brief     Definition of a discrete-event simulator that runs clocks in virtual time
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_SIMULATOR_H
+#define _SAUTO_SIMULATOR_H
+
+// Qt includes
+#include <QObject>
+
+// solution includes
+#include <sautoModel/sautoTime.h>
+
+// local includes
+#include "sautoManager.h"
+
+namespace sauto {
+
+   // Runs the clocks of a SautoManager in virtual time. Instead of waiting for its timer, the time
+   // jumps straight to the next deadline in the wheel, so weeks of schedules run in seconds.
+   // Connect to the manager before running.
+   //
+   // The clocks are run in CLOCK_DEADLINE mode, not in the CLOCK_POLLING mode that a manager starts
+   // in, since polling would wake every clock every 10 msecs. The triggers and the session starts
+   // and ends come at the same times as in a polling run, but the countdown signals are only
+   // emitted when a clock wakes up, so there are far fewer of them
+   class SautoSimulator : public QObject
+   {
+      Q_OBJECT
+
+   public:
+      explicit SautoSimulator(qint64 startMSecsSinceEpoch, QObject *parent = 0);
+      ~SautoSimulator();
+      inline SautoManager* manager() { return m_manager; }
+      inline SautoVirtualTime& time() { return m_time; }
+      inline qint64 currentMSecsSinceEpoch() const { return m_time.currentMSecsSinceEpoch(); }
+      quint64 runUntil(qint64 msecsSinceEpoch);
+      quint64 runFor(qint64 msecs);
+
+   private:
+      SautoVirtualTime m_time;
+      SautoManager *m_manager;
+   };
+}
+
+#endif
@@ -0,0 +1,354 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoSnapshot.cpp
+//
+//  \brief     Implementation of an append-only file of clock definitions and countdowns
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// Qt includes
+#include <QSaveFile>
+
+// solution includes
+#include <sautoXml/sautoBinary.h>
+
+// local includes
+#include "sautoSnapshot.h"
+
+using namespace sauto;
+
+enum EStateFlag
+{
+   STATE_RUNNING      = 0x1,
+   STATE_IN_SESSION   = 0x2,
+   STATE_HAS_TRIGGER  = 0x4,
+   STATE_HAS_DURATION = 0x8,
+};
+
+SautoSnapshot::SautoSnapshot()
+{
+
+}
+
+SautoSnapshot::~SautoSnapshot()
+{
+   close();
+}
+
+//  Opens the file for appending, it is created when it doesn't exist. A record at the end that
+//  was cut off is cut away, so that the next record follows the last one that is whole
+bool SautoSnapshot::open(const QString &fileName)
+{
+   close();
+   m_file.setFileName(fileName);
+   if (!m_file.open(QIODevice::ReadWrite))
+   {
+      m_error = QString("Failed at opening file '%1'").arg(fileName);
+      return false;
+   }
+
+   const qint64 size = m_file.size();
+   if (size == 0)
+   {
+      QByteArray header;
+      SautoBinary::write<quint32>(header, SAUTO_SNAPSHOT_MAGIC);
+      SautoBinary::write<quint16>(header, SAUTO_SNAPSHOT_VERSION);
+      SautoBinary::write<quint16>(header, 0);
+      m_file.write(header);
+      return true;
+   }
+
+   qint64 valid = -1;
+   uchar *data = m_file.map(0, size);
+   if (data != 0)
+   {
+      valid = scan(data, size, 0);
+      m_file.unmap(data);
+   }
+   else
+   {
+      const QByteArray bytes = m_file.readAll();
+      valid = scan(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(), 0);
+   }
+   if (valid < 0)
+   {
+      m_file.close();
+      return false;
+   }
+   if (valid < size)
+   {
+      m_file.resize(valid);
+   }
+   m_file.seek(valid);
+   return true;
+}
+
+void SautoSnapshot::close()
+{
+   if (m_file.isOpen())
+   {
+      flush();
+      m_file.close();
+   }
+}
+
+//  Replays the file into the clocks that it leaves behind, keyed on their id
+bool SautoSnapshot::read(const QString &fileName, QHash<int, SautoSnapshotClock> &clocks)
+{
+   QFile file(fileName);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      m_error = QString("Failed at opening file '%1'").arg(fileName);
+      return false;
+   }
+
+   const qint64 size = file.size();
+   const uchar *data = size > 0 ? file.map(0, size) : 0;
+   if (data != 0)
+   {
+      return scan(data, size, &clocks) >= 0;
+   }
+   const QByteArray bytes = file.readAll();
+   return scan(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(), &clocks) >= 0;
+}
+
+//  Goes through the records of the file and returns where the last whole one ends, -1 when it is
+//  not a snapshot. The clocks are only filled in when they are asked for
+qint64 SautoSnapshot::scan(const uchar *data, qint64 size, QHash<int, SautoSnapshotClock> *clocks)
+{
+   SautoBinaryReader header(data, qMin<qint64>(size, SAUTO_SNAPSHOT_HEADER_SIZE));
+   const quint32 magic   = header.read<quint32>();
+   const quint16 version = header.read<quint16>();
+   if (!header.ok() || magic != SAUTO_SNAPSHOT_MAGIC)
+   {
+      m_error = "Not a snapshot file";
+      return -1;
+   }
+   if (version != SAUTO_SNAPSHOT_VERSION)
+   {
+      m_error = QString("Unsupported snapshot file version %1").arg(version);
+      return -1;
+   }
+
+   qint64 pos = SAUTO_SNAPSHOT_HEADER_SIZE;
+   while (size - pos >= SAUTO_SNAPSHOT_RECORD_SIZE)
+   {
+      SautoBinaryReader record(data + pos, SAUTO_SNAPSHOT_RECORD_SIZE);
+      const quint8 type      = record.read<quint8>();
+      const qint32 id        = record.read<qint32>();
+      const quint32 payload  = record.read<quint32>();
+      const quint32 checksum = record.read<quint32>();
+      const uchar *body = data + pos + SAUTO_SNAPSHOT_RECORD_SIZE;
+      if (size - pos - SAUTO_SNAPSHOT_RECORD_SIZE < static_cast<qint64>(payload) || crc32(body, payload) != checksum)
+      {
+         break;
+      }
+      pos += SAUTO_SNAPSHOT_RECORD_SIZE + payload;
+      if (clocks == 0)
+      {
+         continue;
+      }
+
+      SautoBinaryReader reader(body, payload);
+      switch (type)
+      {
+      case(RECORD_DEFINE) :
+      {
+         SautoSnapshotClock &clock = (*clocks)[id];
+         clock.id = id;
+         clock.fileKey = reader.readString();
+         clock.definition = QByteArray(reinterpret_cast<const char*>(reader.pos()), static_cast<int>(qMax<qint64>(0, reader.left())));
+         break;
+      }
+
+      case(RECORD_STATE) :
+      {
+         // a state without a definition before it belongs to a clock that was removed
+         QHash<int, SautoSnapshotClock>::iterator it = clocks->find(id);
+         if (it == clocks->end())
+         {
+            break;
+         }
+         SautoClockState state;
+         state.id = id;
+         state.wallTime = reader.read<qint64>();
+         const quint8 flags = reader.read<quint8>();
+         state.running = (flags & STATE_RUNNING) != 0;
+         state.inSession = (flags & STATE_IN_SESSION) != 0;
+         state.hasNextTriggerTime = (flags & STATE_HAS_TRIGGER) != 0;
+         state.hasDuration = (flags & STATE_HAS_DURATION) != 0;
+         state.eventType = reader.read<quint8>();
+         state.wp = reader.read<quint8>();
+         state.msecsToNextTrigger = reader.read<qint64>();
+         state.msecsToNextTrigger_original = reader.read<qint64>();
+         state.msecsDuration_original = reader.read<qint64>();
+         state.msecsTimeLeft = reader.read<qint64>();
+         state.sessionStartTime = reader.read<qint64>();
+         state.msecsSinceTrigger = reader.read<qint64>();
+
+         state.current = reader.readModel();
+         if (reader.ok())
+         {
+            it.value().state = state;
+            it.value().hasState = true;
+         }
+         break;
+      }
+
+      case(RECORD_REMOVE) :
+         clocks->remove(id);
+         break;
+
+      default:
+         break;
+      }
+   }
+   return pos;
+}
+
+void SautoSnapshot::writeDefinition(int id, const QString &fileKey, const QByteArray &definition)
+{
+   QByteArray payload;
+   payload.reserve(4 + fileKey.size() + definition.size());
+   SautoBinary::writeString(payload, fileKey);
+   payload.append(definition);
+   writeRecord(m_pending, RECORD_DEFINE, id, payload);
+}
+
+void SautoSnapshot::writeState(const SautoClockState &state)
+{
+   writeRecord(m_pending, RECORD_STATE, state.id, stateData(state));
+}
+
+void SautoSnapshot::writeRemoval(int id)
+{
+   writeRecord(m_pending, RECORD_REMOVE, id, QByteArray());
+}
+
+//  The records are collected in memory and written in one go
+bool SautoSnapshot::flush()
+{
+   if (!m_file.isOpen())
+   {
+      m_pending.clear();
+      return false;
+   }
+   if (m_pending.isEmpty())
+   {
+      return true;
+   }
+   const bool ok = m_file.write(m_pending) == m_pending.size() && m_file.flush();
+   m_pending.clear();
+   if (!ok)
+   {
+      m_error = QString("Failed at writing file '%1'").arg(m_file.fileName());
+   }
+   return ok;
+}
+
+//  Writes the file again with only the last definition and the argument state of every clock that
+//  has a state, the others are left out. The file is replaced in one step
+bool SautoSnapshot::compact(const QVector<SautoClockState> &states)
+{
+   const QString fileName = m_file.fileName();
+   if (!flush())
+   {
+      return false;
+   }
+   m_file.close();
+
+   QHash<int, SautoSnapshotClock> clocks;
+   if (!read(fileName, clocks))
+   {
+      return false;
+   }
+
+   QByteArray data;
+   SautoBinary::write<quint32>(data, SAUTO_SNAPSHOT_MAGIC);
+   SautoBinary::write<quint16>(data, SAUTO_SNAPSHOT_VERSION);
+   SautoBinary::write<quint16>(data, 0);
+   for (int i = 0; i < states.size(); i++)
+   {
+      const SautoClockState &state = states.at(i);
+      QHash<int, SautoSnapshotClock>::const_iterator it = clocks.constFind(state.id);
+      if (it == clocks.constEnd())
+      {
+         continue;
+      }
+      QByteArray payload;
+      SautoBinary::writeString(payload, it.value().fileKey);
+      payload.append(it.value().definition);
+      writeRecord(data, RECORD_DEFINE, state.id, payload);
+      writeRecord(data, RECORD_STATE, state.id, stateData(state));
+   }
+
+   QSaveFile file(fileName);
+   if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+   {
+      m_error = QString("Failed at writing file '%1'").arg(fileName);
+      open(fileName);
+      return false;
+   }
+   return open(fileName);
+}
+
+void SautoSnapshot::writeRecord(QByteArray &data, ERecord type, int id, const QByteArray &payload) const
+{
+   SautoBinary::write<quint8>(data, static_cast<quint8>(type));
+   SautoBinary::write<qint32>(data, id);
+   SautoBinary::write<quint32>(data, static_cast<quint32>(payload.size()));
+   SautoBinary::write<quint32>(data, crc32(reinterpret_cast<const uchar*>(payload.constData()), payload.size()));
+   data.append(payload);
+}
+
+QByteArray SautoSnapshot::stateData(const SautoClockState &state) const
+{
+   quint8 flags = 0;
+   flags |= state.running ? STATE_RUNNING : 0;
+   flags |= state.inSession ? STATE_IN_SESSION : 0;
+   flags |= state.hasNextTriggerTime ? STATE_HAS_TRIGGER : 0;
+   flags |= state.hasDuration ? STATE_HAS_DURATION : 0;
+
+   QByteArray data;
+   data.reserve(96);
+   SautoBinary::write<qint64>(data, state.wallTime);
+   SautoBinary::write<quint8>(data, flags);
+   SautoBinary::write<quint8>(data, state.eventType);
+   SautoBinary::write<quint8>(data, state.wp);
+   SautoBinary::write<qint64>(data, state.msecsToNextTrigger);
+   SautoBinary::write<qint64>(data, state.msecsToNextTrigger_original);
+   SautoBinary::write<qint64>(data, state.msecsDuration_original);
+   SautoBinary::write<qint64>(data, state.msecsTimeLeft);
+   SautoBinary::write<qint64>(data, state.sessionStartTime);
+   SautoBinary::write<qint64>(data, state.msecsSinceTrigger);
+   SautoBinary::writeModel(data, state.current);
+   return data;
+}
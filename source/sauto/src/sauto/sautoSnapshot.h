@@ -0,0 +1,119 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoSnapshot.h
+//
+//  \brief     Definition of an append-only file of clock definitions and countdowns
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_SNAPSHOT_H
+#define _SAUTO_SNAPSHOT_H
+
+// Qt includes
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// local includes
+#include "sauto.h"
+
+namespace sauto {
+
+   static const quint32 SAUTO_SNAPSHOT_MAGIC   = 0x4e534153; //< "SASN"
+   static const quint16 SAUTO_SNAPSHOT_VERSION = 1;
+   static const int SAUTO_SNAPSHOT_HEADER_SIZE = 8;
+   static const int SAUTO_SNAPSHOT_RECORD_SIZE = 13;
+
+   // a clock as the snapshot left it, the last record of each kind wins
+   struct SautoSnapshotClock
+   {
+      SautoSnapshotClock() : id(-1), hasState(false) {}
+      int id;
+      QString fileKey;       //< identity of the clock file, empty for clocks that were not loaded from one
+      QByteArray definition; //< binary clock data, see SautoBinary::clockData()
+      bool hasState;
+      SautoClockState state;
+   };
+
+   // Clock definitions are appended when clocks are added, their countdowns at every checkpoint and
+   // a removal when they go away, so that a checkpoint only writes what has changed since the last
+   // one. All values are little endian:
+   //
+   //    header : magic u32, version u16, reserved u16
+   //    record : type u8, id i32, payload size u32, CRC-32 of payload u32, payload
+   //    define : file key string, binary clock data
+   //    state  : wall time i64, flags u8, event type u8, wave point u8, 4 x countdown i64,
+   //             session start i64, msecs since trigger i64, model
+   //    model  : as in the binary clock file
+   //    string : size u32, UTF-8 bytes
+   //    remove : no payload
+   //
+   // A record that was cut off by a crash ends the file, it is cut away when the file is opened again
+   class SautoSnapshot
+   {
+   public:
+      SautoSnapshot();
+      ~SautoSnapshot();
+      bool open(const QString &fileName);
+      void close();
+      inline bool isOpen() const { return m_file.isOpen(); }
+      inline QString fileName() const { return m_file.fileName(); }
+      inline qint64 size() const { return m_file.size() + m_pending.size(); }
+      bool read(const QString &fileName, QHash<int, SautoSnapshotClock> &clocks);
+      void writeDefinition(int id, const QString &fileKey, const QByteArray &definition);
+      void writeState(const SautoClockState &state);
+      void writeRemoval(int id);
+      bool flush();
+      bool compact(const QVector<SautoClockState> &states);
+      inline const QString& errorString() const { return m_error; }
+
+   private:
+      enum ERecord
+      {
+         RECORD_DEFINE = 1,
+         RECORD_STATE  = 2,
+         RECORD_REMOVE = 3,
+      };
+
+      void writeRecord(QByteArray &data, ERecord type, int id, const QByteArray &payload) const;
+      QByteArray stateData(const SautoClockState &state) const;
+      qint64 scan(const uchar *data, qint64 size, QHash<int, SautoSnapshotClock> *clocks);
+
+   private:
+      QFile m_file;
+      QByteArray m_pending;
+      QString m_error;
+   };
+}
+
+#endif
@@ -0,0 +1,399 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoWheel.cpp
+//
+//  \brief     Implementation of a hierarchical timing wheel shared by many clocks
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// solution includes
+#include <sautoModel/timeStuff.h>
+
+// local includes
+#include "sautoWheel.h"
+
+using namespace sauto;
+
+// milliseconds covered by one slot on each level, the overflow "slot" is the whole day level
+static const qint64 s_span[WHEEL_EXPIRED] =
+{
+   1,
+   msecsPer_Sec,
+   msecsPer_Min,
+   msecsPer_Hour,
+   msecsPer_Day,
+   qint64(msecsPer_Day) * WHEEL_DAY_SLOTS,
+};
+
+static const int s_slots[WHEEL_OVERFLOW] =
+{
+   WHEEL_MSEC_SLOTS,
+   WHEEL_SEC_SLOTS,
+   WHEEL_MIN_SLOTS,
+   WHEEL_HOUR_SLOTS,
+   WHEEL_DAY_SLOTS,
+};
+
+static void makeEmpty(SautoWheelEntry *head)
+{
+   head->prev = head;
+   head->next = head;
+}
+
+//  Moves the entries of the slot to the end of the other list, they keep their levels
+static void splice(SautoWheelEntry *head, SautoWheelEntry *to)
+{
+   if (head->next == head)
+   {
+      return;
+   }
+   head->next->prev = to->prev;
+   to->prev->next = head->next;
+   head->prev->next = to;
+   to->prev = head->prev;
+   makeEmpty(head);
+}
+
+static void release(SautoWheelEntry *head)
+{
+   SautoWheelEntry *entry = head->next;
+   while (entry != head)
+   {
+      SautoWheelEntry *next = entry->next;
+      entry->prev = 0;
+      entry->next = 0;
+      entry->level = -1;
+      entry = next;
+   }
+   makeEmpty(head);
+}
+
+SautoWheel::SautoWheel()
+   :m_time(&systemTime()),
+   m_current(0),
+   m_size(0)
+{
+   for (int i = 0; i < WHEEL_NO_LEVELS; i++)
+   {
+      m_count[i] = 0;
+   }
+   for (int i = 0; i < WHEEL_MSEC_SLOTS; i++)
+   {
+      makeEmpty(&m_msec[i]);
+   }
+   for (int i = 0; i < WHEEL_SEC_SLOTS; i++)
+   {
+      makeEmpty(&m_sec[i]);
+   }
+   for (int i = 0; i < WHEEL_MIN_SLOTS; i++)
+   {
+      makeEmpty(&m_min[i]);
+   }
+   for (int i = 0; i < WHEEL_HOUR_SLOTS; i++)
+   {
+      makeEmpty(&m_hour[i]);
+   }
+   for (int i = 0; i < WHEEL_DAY_SLOTS; i++)
+   {
+      makeEmpty(&m_day[i]);
+   }
+   makeEmpty(&m_overflow);
+   makeEmpty(&m_expired);
+   m_current = now();
+}
+
+SautoWheel::~SautoWheel()
+{
+   // detach whatever is still armed, the owning clocks may outlive the wheel
+   for (int i = 0; i < WHEEL_MSEC_SLOTS; i++)
+   {
+      release(&m_msec[i]);
+   }
+   for (int i = 0; i < WHEEL_SEC_SLOTS; i++)
+   {
+      release(&m_sec[i]);
+   }
+   for (int i = 0; i < WHEEL_MIN_SLOTS; i++)
+   {
+      release(&m_min[i]);
+   }
+   for (int i = 0; i < WHEEL_HOUR_SLOTS; i++)
+   {
+      release(&m_hour[i]);
+   }
+   for (int i = 0; i < WHEEL_DAY_SLOTS; i++)
+   {
+      release(&m_day[i]);
+   }
+   release(&m_overflow);
+   release(&m_expired);
+}
+
+qint64 SautoWheel::now() const
+{
+   return m_time->elapsed();
+}
+
+//  Entries are kept against the monotonic clock of the source, so the armed ones are moved over to
+//  the new source with the time they have left. Expired entries stay expired
+void SautoWheel::setTimeSource(const SautoTimeSource *time)
+{
+   const qint64 oldNow = now();
+   SautoWheelEntry pending;
+   makeEmpty(&pending);
+   for (int level = WHEEL_MSEC; level < WHEEL_OVERFLOW; level++)
+   {
+      for (int i = 0; i < s_slots[level]; i++)
+      {
+         splice(slot(level, i * s_span[level]), &pending);
+      }
+   }
+   splice(&m_overflow, &pending);
+
+   m_time = time;
+   m_current = now();
+   while (pending.next != &pending)
+   {
+      SautoWheelEntry *entry = pending.next;
+      const qint64 left = entry->expiry - oldNow;
+      unlink(entry);
+      entry->expiry = m_current + qMax<qint64>(0, left);
+      insert(entry);
+   }
+}
+
+void SautoWheel::arm(SautoWheelEntry *entry, qint64 msecs)
+{
+   cancel(entry);
+   const qint64 timeNow = now();
+   if (m_size == 0 && m_current < timeNow)
+   {
+      // nothing to cascade, skip the idle period in one step
+      m_current = timeNow;
+   }
+   entry->expiry = timeNow + qMax<qint64>(0, msecs);
+   insert(entry);
+}
+
+void SautoWheel::cancel(SautoWheelEntry *entry)
+{
+   if (entry->level >= 0)
+   {
+      unlink(entry);
+   }
+}
+
+void SautoWheel::advance()
+{
+   advance(now());
+}
+
+void SautoWheel::advance(qint64 now)
+{
+   while (m_current <= now)
+   {
+      const int level = lowestOccupiedLevel();
+      if (level == WHEEL_MSEC)
+      {
+         SautoWheelEntry *head = slot(WHEEL_MSEC, m_current);
+         while (head->next != head)
+         {
+            SautoWheelEntry *entry = head->next;
+            unlink(entry);
+            link(&m_expired, entry, WHEEL_EXPIRED);
+         }
+         m_current++;
+         cascadeAt(m_current);
+         continue;
+      }
+
+      // the lower levels are empty, so nothing can happen before the next slot on this level
+      qint64 next = now + 1;
+      if (level >= 0)
+      {
+         next = qMin(next, (m_current / s_span[level] + 1) * s_span[level]);
+      }
+      m_current = next;
+      cascadeAt(m_current);
+   }
+}
+
+SautoWheelEntry* SautoWheel::takeExpired()
+{
+   if (m_expired.next == &m_expired)
+   {
+      return 0;
+   }
+   SautoWheelEntry *entry = m_expired.next;
+   unlink(entry);
+   return entry;
+}
+
+qint64 SautoWheel::nextExpiry() const
+{
+   if (m_count[WHEEL_EXPIRED] > 0)
+   {
+      return 0;
+   }
+   const int level = lowestOccupiedLevel();
+   if (level < 0)
+   {
+      return -1;
+   }
+   return qMax<qint64>(0, nextOccupiedTick(level) - now());
+}
+
+void SautoWheel::insert(SautoWheelEntry *entry)
+{
+   const qint64 tick = qMax(entry->expiry, m_current);
+
+   // an entry lives on the lowest level whose parent slot is the one currently running
+   for (int level = WHEEL_MSEC; level < WHEEL_OVERFLOW; level++)
+   {
+      if (tick / s_span[level + 1] == m_current / s_span[level + 1])
+      {
+         link(slot(level, tick), entry, level);
+         return;
+      }
+   }
+   link(&m_overflow, entry, WHEEL_OVERFLOW);
+}
+
+void SautoWheel::link(SautoWheelEntry *head, SautoWheelEntry *entry, int level)
+{
+   entry->prev = head->prev;
+   entry->next = head;
+   head->prev->next = entry;
+   head->prev = entry;
+   entry->level = level;
+   m_count[level]++;
+   m_size++;
+}
+
+void SautoWheel::unlink(SautoWheelEntry *entry)
+{
+   entry->prev->next = entry->next;
+   entry->next->prev = entry->prev;
+   entry->prev = 0;
+   entry->next = 0;
+   m_count[entry->level]--;
+   m_size--;
+   entry->level = -1;
+}
+
+void SautoWheel::cascade(SautoWheelEntry *head)
+{
+   // detach the slot first, overflow entries that are still far away are put back into it
+   SautoWheelEntry pending;
+   makeEmpty(&pending);
+   if (head->next != head)
+   {
+      pending.next = head->next;
+      pending.prev = head->prev;
+      pending.next->prev = &pending;
+      pending.prev->next = &pending;
+      makeEmpty(head);
+   }
+
+   while (pending.next != &pending)
+   {
+      SautoWheelEntry *entry = pending.next;
+      unlink(entry);
+      insert(entry);
+   }
+}
+
+void SautoWheel::cascadeAt(qint64 tick)
+{
+   // higher levels first, so that their entries can fall further down in the same pass
+   for (int level = WHEEL_OVERFLOW; level > WHEEL_MSEC; level--)
+   {
+      if (tick % s_span[level] == 0 && m_count[level] > 0)
+      {
+         cascade(slot(level, tick));
+      }
+   }
+}
+
+SautoWheelEntry* SautoWheel::slot(int level, qint64 tick)
+{
+   switch (level)
+   {
+   case WHEEL_MSEC:
+      return &m_msec[tick % WHEEL_MSEC_SLOTS];
+   case WHEEL_SEC:
+      return &m_sec[(tick / s_span[WHEEL_SEC]) % WHEEL_SEC_SLOTS];
+   case WHEEL_MIN:
+      return &m_min[(tick / s_span[WHEEL_MIN]) % WHEEL_MIN_SLOTS];
+   case WHEEL_HOUR:
+      return &m_hour[(tick / s_span[WHEEL_HOUR]) % WHEEL_HOUR_SLOTS];
+   case WHEEL_DAY:
+      return &m_day[(tick / s_span[WHEEL_DAY]) % WHEEL_DAY_SLOTS];
+   case WHEEL_OVERFLOW:
+      return &m_overflow;
+   default:
+      return &m_expired;
+   }
+}
+
+int SautoWheel::lowestOccupiedLevel() const
+{
+   for (int level = WHEEL_MSEC; level <= WHEEL_OVERFLOW; level++)
+   {
+      if (m_count[level] > 0)
+      {
+         return level;
+      }
+   }
+   return -1;
+}
+
+qint64 SautoWheel::nextOccupiedTick(int level) const
+{
+   if (level == WHEEL_OVERFLOW)
+   {
+      return (m_current / s_span[WHEEL_OVERFLOW] + 1) * s_span[WHEEL_OVERFLOW];
+   }
+
+   // slots before the running one are always empty on this level
+   const qint64 parent = (m_current / s_span[level + 1]) * s_span[level + 1];
+   SautoWheel *self = const_cast<SautoWheel*>(this);
+   for (int i = int((m_current / s_span[level]) % s_slots[level]); i < s_slots[level]; i++)
+   {
+      const qint64 tick = parent + i * s_span[level];
+      const SautoWheelEntry *head = self->slot(level, tick);
+      if (head->next != head)
+      {
+         return tick;
+      }
+   }
+   return parent + s_span[level + 1];
+}
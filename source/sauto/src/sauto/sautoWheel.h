@@ -0,0 +1,117 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoWheel.h
+//
+//  \brief     Definition of a hierarchical timing wheel shared by many clocks
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_WHEEL_H
+#define _SAUTO_WHEEL_H
+
+// solution includes
+#include <sautoModel/sautoTime.h>
+
+namespace sauto {
+
+   class Sauto;
+
+   // intrusive list node, owned by the clock that is armed with it
+   struct SautoWheelEntry
+   {
+      SautoWheelEntry() : prev(0), next(0), expiry(0), level(-1), clock(0) {}
+      SautoWheelEntry *prev;
+      SautoWheelEntry *next;
+      qint64 expiry;
+      int level;
+      Sauto *clock;
+   };
+
+   enum EWheelLevel
+   {
+      WHEEL_MSEC     ,
+      WHEEL_SEC      ,
+      WHEEL_MIN      ,
+      WHEEL_HOUR     ,
+      WHEEL_DAY      ,
+      WHEEL_OVERFLOW ,
+      WHEEL_EXPIRED  ,
+      WHEEL_NO_LEVELS,
+   };
+
+   static const int WHEEL_MSEC_SLOTS = 1000;
+   static const int WHEEL_SEC_SLOTS  = 60;
+   static const int WHEEL_MIN_SLOTS  = 60;
+   static const int WHEEL_HOUR_SLOTS = 24;
+   static const int WHEEL_DAY_SLOTS  = 64;
+
+   class SautoWheel
+   {
+   public:
+      SautoWheel();
+      ~SautoWheel();
+      qint64 now() const;
+      void setTimeSource(const SautoTimeSource *time);
+      void arm(SautoWheelEntry *entry, qint64 msecs);
+      void cancel(SautoWheelEntry *entry);
+      void advance();
+      void advance(qint64 now);
+      SautoWheelEntry* takeExpired();
+      qint64 nextExpiry() const;
+      inline int size() const { return m_size; }
+      inline bool isEmpty() const { return m_size == 0; }
+
+   private:
+      void insert(SautoWheelEntry *entry);
+      void link(SautoWheelEntry *head, SautoWheelEntry *entry, int level);
+      void unlink(SautoWheelEntry *entry);
+      void cascade(SautoWheelEntry *head);
+      void cascadeAt(qint64 tick);
+      SautoWheelEntry* slot(int level, qint64 tick);
+      int lowestOccupiedLevel() const;
+      qint64 nextOccupiedTick(int level) const;
+
+   private:
+      const SautoTimeSource *m_time;
+      qint64 m_current;
+      int m_size;
+      int m_count[WHEEL_NO_LEVELS];
+      SautoWheelEntry m_msec[WHEEL_MSEC_SLOTS];
+      SautoWheelEntry m_sec[WHEEL_SEC_SLOTS];
+      SautoWheelEntry m_min[WHEEL_MIN_SLOTS];
+      SautoWheelEntry m_hour[WHEEL_HOUR_SLOTS];
+      SautoWheelEntry m_day[WHEEL_DAY_SLOTS];
+      SautoWheelEntry m_overflow;
+      SautoWheelEntry m_expired;
+   };
+}
+
+#endif
@@ -0,0 +1,88 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      main.cpp
+//
+//  \brief     Entry point of the scheduling benchmarks
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// Qt includes
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+// local includes
+#include "sautoBench.h"
+
+using namespace sauto;
+
+int main(int argc, char *argv[])
+{
+   QCoreApplication app(argc, argv);
+   app.setOrganizationName("Broentech Solutions AS");
+   app.setOrganizationDomain("broentech.no");
+   app.setApplicationName("sautoBench");
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription("Benchmarks of the scheduling hot paths, written as JSON");
+   parser.addHelpOption();
+   parser.addPositionalArgument("output", "File to write the results to, sautoBench.json by default");
+   QCommandLineOption maxClocks("max-clocks", "Largest number of clocks in the SautoManager runs", "clocks", "100000");
+   QCommandLineOption idleMSecs("idle-msecs", "How long the SautoManager runs idle, in msecs", "msecs", "2000");
+   parser.addOption(maxClocks);
+   parser.addOption(idleMSecs);
+   parser.process(app);
+
+   SautoBench bench;
+   bench.setMaxClocks(parser.value(maxClocks).toInt());
+   bench.setIdleMSecs(parser.value(idleMSecs).toInt());
+   bench.run();
+
+   QTextStream out(stdout);
+   for (int i = 0; i < bench.results().size(); i++)
+   {
+      const SautoBenchResult &result = bench.results().at(i);
+      out << QString("%1 %2 ns/op %3 allocs/op").arg(result.name, -48).arg(result.nsPerOp, 12, 'f', 1).arg(result.allocsPerOp, 8, 'f', 2);
+      if (result.idleCpuNsPerClock >= 0)
+      {
+         out << QString(" %1 idle ns/clock/s").arg(result.idleCpuNsPerClock, 10, 'f', 1);
+      }
+      out << endl;
+   }
+
+   const QString output = parser.positionalArguments().isEmpty() ? QString("sautoBench.json") : parser.positionalArguments().first();
+   if (!bench.write(output))
+   {
+      out << QString("Failed at writing %1").arg(output) << endl;
+      return 1;
+   }
+   return 0;
+}
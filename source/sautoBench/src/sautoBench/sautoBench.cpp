@@ -0,0 +1,1076 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoBench.cpp
+//
+//  \brief     Implementation of the benchmarks for the scheduling hot paths
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// std includes
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <random>
+
+// Qt includes
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QtMath>
+
+// solution includes
+#include <sauto/sauto.h>
+#include <sauto/sautoManager.h>
+#include <sauto/sautoSimulator.h>
+#include <sautoXml/sautoBinary.h>
+#include <sautoXml/sautoXml.h>
+
+// local includes
+#include "sautoBench.h"
+
+using namespace sauto;
+
+// every allocation of the process is counted, so that allocations per operation can be reported
+static std::atomic<quint64> s_allocations(0);
+
+void* operator new(std::size_t size)
+{
+   s_allocations.fetch_add(1, std::memory_order_relaxed);
+   void *memory = std::malloc(size == 0 ? 1 : size);
+   if (memory == 0)
+   {
+      throw std::bad_alloc();
+   }
+   return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+   std::free(memory);
+}
+
+quint64 sauto::benchAllocations()
+{
+   return s_allocations.load(std::memory_order_relaxed);
+}
+
+SautoBench::SautoBench(QObject *parent)
+   :QObject(parent),
+   m_time(QDateTime(QDate(2026, 6, 15), QTime(12, 0, 0)).toMSecsSinceEpoch()),
+   m_maxClocks(100000),
+   m_idleMSecs(2000)
+{
+
+}
+
+SautoBench::~SautoBench()
+{
+
+}
+
+void SautoBench::run()
+{
+   makeSchedules();
+   benchCivil();
+   benchModel();
+   benchTriggers();
+   benchSession();
+   checkClockJump();
+   benchXml();
+   benchReload();
+   benchSnapshot(m_maxClocks);
+   for (int clocks = 1000; clocks <= m_maxClocks; clocks *= 10)
+   {
+      benchManager(CLOCK_DEADLINE, clocks);
+
+      // every polling clock wakes 100 times a second, more than this only measures the event loop
+      if (clocks <= 10000)
+      {
+         benchManager(CLOCK_POLLING, clocks);
+      }
+   }
+}
+
+template<typename Op>
+SautoBenchResult& SautoBench::measure(const QString &name, quint64 iterations, Op op)
+{
+   // one round outside of the measurement, so that tables built on first use don't count
+   op();
+
+   const quint64 allocations = benchAllocations();
+   QElapsedTimer timer;
+   timer.start();
+   for (quint64 i = 0; i < iterations; i++)
+   {
+      op();
+   }
+   const qint64 nsecs = timer.nsecsElapsed();
+
+   SautoBenchResult result;
+   result.name = name;
+   result.iterations = iterations;
+   result.nsPerOp = static_cast<qreal>(nsecs) / iterations;
+   result.allocsPerOp = static_cast<qreal>(benchAllocations() - allocations) / iterations;
+   m_results.append(result);
+   return m_results.last();
+}
+
+//  The virtual time is 12:00 on a monday, the sessions of the schedules are placed around it
+void SautoBench::makeSchedules()
+{
+   m_freq = SautoModel(STATIC, 0, 8 * msecsPer_Hour, 8 * msecsPer_Hour, msecsPer_Sec, true, "frequency");
+
+   m_intervals.clear();
+   m_intervals.append(SautoModel(STATIC, 0, msecsPer_Hour, 13 * msecsPer_Hour, msecsPer_Sec, true, "static"));
+   m_intervals.append(SautoModel(WAVELET, 45, msecsPer_Hour, 15 * msecsPer_Hour, 10 * msecsPer_Sec, true, "peak", "valley", "rising", "sinking"));
+   m_intervals.append(SautoModel(SINGLE, 0, 0, 17 * msecsPer_Hour, 0, true, "single"));
+
+   m_week = makeEmptyWeekData();
+   m_week[SATRUDAY].first.first = false;
+   m_week[SUNDAY].first.first = false;
+   m_week[MONDAY].first.second = false;
+   m_week[MONDAY].second = m_intervals;
+
+   m_calendar.clear();
+   DAY_OF_MONTH_DEF june;
+   june.first = false;
+   for (int day = 20; day <= 28; day++)
+   {
+      CALENDAR_DATE date;
+      date.first.first = QDate(2026, 6, day);
+      date.first.second = false;
+      date.second = m_intervals;
+      june.second.insert(20260600 + day, date);
+   }
+   MONTH_DEF months;
+   months.insert(JUN_STR, june);
+   m_calendar.insert(2026, qMakePair(true, months));
+}
+
+//  daysBetweenDates as it was before the civil date kernel, walking the years in between. It counts
+//  the days left of the last year instead of the days into it, so it is only right within a year
+static int referenceDaysBetweenDates(const QDate &from, const QDate &to, bool &ok)
+{
+   ok = true;
+   int days = 0;
+   int toYear = to.year();
+   int fromYear = from.year();
+   if (fromYear > toYear)
+   {
+      // this date is in the past
+      ok = false;
+      return 0;
+   }
+   else if (fromYear < toYear)
+   {
+      // the time to use is not this year, but a year in the future
+      int daysLeftOfThisYear = from.daysInYear() - from.dayOfYear();
+      int dummyYear = fromYear;
+      while (dummyYear < toYear)
+      {
+         ++dummyYear;
+         QDate dummyDate(dummyYear, 1, 1);
+         if (dummyYear == toYear)
+         {
+            days += to.daysInYear() - to.dayOfYear();
+         }
+         else
+         {
+            days += dummyDate.daysInYear();
+         }
+      }
+      days += daysLeftOfThisYear;
+   }
+   else
+   {
+      days += to.dayOfYear() - from.dayOfYear();
+      if (days < 0)
+      {
+         // this date is in the past
+         ok = false;
+         return 0;
+      }
+   }
+
+   return days;
+}
+
+//  getMonthAsInt as it was before, comparing the name against every month in turn
+static int referenceMonthAsInt(const QString &monthStr)
+{
+   if(monthStr == QString(JAN_STR))
+   {
+      return 1;
+   }
+   else if(monthStr == QString(FEB_STR))
+   {
+      return 2;
+   }
+   else if(monthStr == QString(MAR_STR))
+   {
+      return 3;
+   }
+   else if(monthStr == QString(APR_STR))
+   {
+      return 4;
+   }
+   else if(monthStr == QString(MAY_STR))
+   {
+      return 5;
+   }
+   else if(monthStr == QString(JUN_STR))
+   {
+      return 6;
+   }
+   else if(monthStr == QString(JUL_STR))
+   {
+      return 7;
+   }
+   else if(monthStr == QString(AUG_STR))
+   {
+      return 8;
+   }
+   else if(monthStr == QString(SEP_STR))
+   {
+      return 9;
+   }
+   else if(monthStr == QString(OKT_STR))
+   {
+      return 10;
+   }
+   else if(monthStr == QString(NOV_STR))
+   {
+      return 11;
+   }
+   else if(monthStr == QString(DEC_STR))
+   {
+      return 12;
+   }
+   else
+   {
+      // error
+      return -1;
+   }
+}
+
+//  The integer date kernel is checked against QDate for every day of 1900 - 2099 before it is measured
+void SautoBench::benchCivil()
+{
+   const QDate first(1900, 1, 1);
+   const QDate last(2099, 12, 31);
+   for (QDate date = first; date <= last; date = date.addDays(1))
+   {
+      const qint64 days = daysFromDate(date);
+      const SautoCivilDate civil = civilFromDays(days);
+      if (daysFromCivil(date.year(), date.month(), date.day()) != days ||
+         civil.year != date.year() || civil.month != date.month() || civil.day != date.day() ||
+         dayOfWeekFromDays(days) != date.dayOfWeek() ||
+         daysInMonth(date.year(), date.month()) != date.daysInMonth())
+      {
+         qWarning("The civil date kernel disagrees with QDate at %s", qPrintable(date.toString(Qt::ISODate)));
+         return;
+      }
+   }
+
+   bool ok = false;
+   bool referenceOk = false;
+   for (QDate date = first; date <= last; date = date.addDays(1))
+   {
+      const QDate newYear(date.year(), 1, 1);
+      if (daysBetweenDates(newYear, date, ok) != referenceDaysBetweenDates(newYear, date, referenceOk) || ok != referenceOk ||
+         daysBetweenDates(date, newYear, ok) != referenceDaysBetweenDates(date, newYear, referenceOk) || ok != referenceOk)
+      {
+         qWarning("daysBetweenDates disagrees with the year walk at %s", qPrintable(date.toString(Qt::ISODate)));
+         return;
+      }
+   }
+
+   const QString months[] = { JAN_STR, FEB_STR, MAR_STR, APR_STR, MAY_STR, JUN_STR, JUL_STR, AUG_STR, SEP_STR, OKT_STR, NOV_STR, DEC_STR, "", "ja", "jun", "January", "mai" };
+   const int monthCount = sizeof(months) / sizeof(months[0]);
+   for (int i = 0; i < monthCount; i++)
+   {
+      if (getMonthAsInt(months[i]) != referenceMonthAsInt(months[i]))
+      {
+         qWarning("getMonthAsInt disagrees with the if chain on \"%s\"", qPrintable(months[i]));
+         return;
+      }
+   }
+
+   const qint64 span = daysFromDate(last) - daysFromDate(first) + 1;
+   qint64 day = 0;
+   qint64 sink = 0;
+   measure("daysFromCivil", 1000000, [&]() {
+      const SautoCivilDate civil = civilFromDays(daysFromDate(first) + day++ % span);
+      sink += daysFromCivil(civil.year, civil.month, civil.day);
+   });
+   measure("QDate::toJulianDay", 1000000, [&]() {
+      const QDate date = first.addDays(day++ % span);
+      sink += QDate(date.year(), date.month(), date.day()).toJulianDay();
+   });
+   measure("daysBetweenDates", 1000000, [&]() {
+      sink += daysBetweenDates(first, first.addDays(day++ % span), ok);
+   });
+   measure("daysBetweenDates/year walk", 1000000, [&]() {
+      sink += referenceDaysBetweenDates(first, first.addDays(day++ % span), ok);
+   });
+   measure("getMonthAsInt", 1000000, [&]() {
+      sink += getMonthAsInt(months[day++ % 12]);
+   });
+   measure("getMonthAsInt/if chain", 1000000, [&]() {
+      sink += referenceMonthAsInt(months[day++ % 12]);
+   });
+   if (sink == 0)
+   {
+      qWarning("No dates were converted");
+   }
+}
+
+void SautoBench::benchModel()
+{
+   SautoModel staticModel(STATIC, 0, 8 * msecsPer_Hour, 8 * msecsPer_Hour, 100, true, "peak");
+   SautoModel waveModel(WAVELET, 45, 8 * msecsPer_Hour, 8 * msecsPer_Hour, msecsPer_Sec, true, "peak", "valley", "rising", "sinking");
+   qint64 msecs = 0;
+   bool ok = false;
+   EWavePoint wp = WP_NOT_SPECIFIED;
+
+   measure("SautoModel::calculateNextTrigger/STATIC", 100000, [&]() {
+      staticModel.calculateNextTrigger(msecs, ok, wp, m_time);
+   });
+   measure("SautoModel::calculateNextTrigger/WAVELET", 100000, [&]() {
+      waveModel.calculateNextTrigger(msecs, ok, wp, m_time);
+   });
+   measure("SautoModel::calculateNextSession", 100000, [&]() {
+      staticModel.calculateNextSession(ok, false, false, m_time);
+   });
+
+   // the clocks find the day once, and reuse it for every model of the calculation
+   const qint64 now = m_time.currentMSecsSinceEpoch();
+   const SautoDayContext day = localDayContext(now);
+   measure("localDayContext", 100000, [&]() {
+      localDayContext(now);
+   });
+   measure("SautoModel::calculateNextSession/day", 100000, [&]() {
+      staticModel.calculateNextSession(ok, false, false, now, day);
+   });
+
+   // a clock in a zone of its own finds the day in the transition table of the zone
+   const SautoZone zone = SautoZone::find("Europe/Oslo");
+   if (zone.isValid())
+   {
+      measure("SautoZone::dayContext", 100000, [&]() {
+         zone.dayContext(now);
+      });
+      measure("SautoZone::toUtc", 100000, [&]() {
+         zone.toUtc(now);
+      });
+   }
+
+   // a cron clock finds its next minute with a bit scan per field, however far away it is
+   SautoCron cron;
+   measure("SautoCron::parse", 100000, [&]() {
+      cron.parse("*/15 8-17 * * mon-fri");
+   });
+   measure("SautoCron::next", 1000000, [&]() {
+      cron.next(now);
+   });
+   const SautoCron leapDay("0 12 29 2 *");
+   measure("SautoCron::next/leap day", 1000000, [&]() {
+      leapDay.next(now);
+   });
+
+   // a recurrence expands one period of the rule to find its next day, and keeps no dates
+   const SautoRecurrence secondTuesday("DTSTART:20261013\nRRULE:FREQ=MONTHLY;BYDAY=2TU");
+   const SautoRecurrence lastWorkday("DTSTART:20261001\nRRULE:FREQ=MONTHLY;BYDAY=MO,TU,WE,TH,FR;BYSETPOS=-1");
+   const qint64 today = daysFromDate(day.date);
+   measure("SautoRecurrence::next/2nd tuesday", 1000000, [&]() {
+      secondTuesday.next(today);
+   });
+   measure("SautoRecurrence::next/last workday", 1000000, [&]() {
+      lastWorkday.next(today);
+   });
+   measure("SautoRecurrence::contains", 1000000, [&]() {
+      secondTuesday.contains(today);
+   });
+}
+
+// The full scans of every period of the session that calculateNextTrigger_STATIC and
+// calculateNextTrigger_WAVELET did before they only looked at the period of the current time. They
+// are kept as they were, with the model as an argument, to check the windowed ones against
+
+static bool referenceCleanPhase(const SautoModel &model)
+{
+   return model.getPhase() == 0 || model.getPhase() == 90 || model.getPhase() == 180 || model.getPhase() == 270;
+}
+
+static bool referenceInterval(SautoModel &model, qreal &start, qreal &stop, qint64 now, const SautoDayContext &day)
+{
+   if (model.getType() == SINGLE || model.getType() == NOT_SPECIFIED)
+   {
+      return false;
+   }
+
+   // the amount of epoch milliseconds right now, and the wall clock time of the day
+   quint64 epochMSeconds_RightNow = now;
+   const qint64 msecsOfDay = day.msecsOfDay(now);
+
+   // first check if the wavelet last for 1 day, starting midnight (when no interval is defined)
+   if (model.getStartTimeMSec() == 0 && model.getDuration() == msecsPer_Day && model.getHasCustomInterval() == false)
+   {
+      // what this means, is that the defined interval for the wavelet starts at midnight, and last the entire day
+      // based on this, it is assumed that since the client asks for the next trigger, it is being done for the first time
+      // on this wavelet, for this running session
+
+      // start it now, so that the behaviour reflects the start of the wavelet, as indicated by the GUI
+      model.setStartTimeMSecs(msecsOfDay);
+
+      // last the rest of the day
+      model.setDuration(msecsPer_Day - msecsOfDay);
+   }
+
+   if (model.getStartTimeMSec() < 0 && model.getHasCustomInterval() && model.getDuration() > 0)
+   {
+      start = epochMSeconds_RightNow;
+      stop = epochMSeconds_RightNow + model.getDuration();
+      return true;
+   }
+
+   // the time when this wavelet will start
+   qreal epochMSecs_intervalStart = static_cast<qreal>(day.toEpoch(model.getStartTimeMSec()));
+
+   // see if this wavelet has already started
+   if (epochMSeconds_RightNow < epochMSecs_intervalStart)
+   {
+      // this wavelet has not yet started, it will start in the future
+      return false;
+   }
+
+   // the time when this wavelet will end
+   qreal epochMSecs_intervalStop = epochMSecs_intervalStart + model.getDuration();
+
+   // see if this wavelet has already ended
+   if (epochMSeconds_RightNow > epochMSecs_intervalStop)
+   {
+      // this wavelet has finished in the past
+      return false;
+   }
+
+   start = epochMSecs_intervalStart;
+   stop = epochMSecs_intervalStop;
+   return true;
+}
+
+static bool referenceTrigger_WAVELET(SautoModel &model, qint64 &msecs, EWavePoint &wp, qint64 now, const SautoDayContext &day)
+{
+   // check if there are any tasks at all
+   if (!model.hasPeak() && !model.hasRising() && !model.hasSinking() && !model.hasValley())
+   {
+      wp = WP_NOT_SPECIFIED;
+      return false; //< There wasn't, no need to do anything
+   }
+
+   qreal epochMSecs_waveStart = 0;
+   qreal epochMSecs_waveStop = 0;
+   if (!referenceInterval(model, epochMSecs_waveStart, epochMSecs_waveStop, now, day))
+   {
+      wp = WP_NOT_SPECIFIED;
+      return false;
+   }
+
+   quint64 epochMSeconds_RightNow = now;
+   qreal   epochMSeconds_RightNow_real = static_cast<qreal>(epochMSeconds_RightNow);
+   qreal   startMSec = static_cast<qreal>(model.getStartTimeMSec());
+   if (startMSec < 0)
+   {
+      startMSec = 0;
+   }
+   qreal phaseOffsetMSecs = static_cast<qreal>(model.getPeriodTotMSec() * model.getPhase()) / 360.0;
+   int noPeriods = qRound((startMSec + static_cast<qreal>(model.getDuration())) / static_cast<qreal>(model.getPeriodTotMSec()));
+
+   // go through all the periods to locate the next one to occur
+   for (int i = 0; i < noPeriods; i++)
+   {
+      // start of this period
+      qreal periodStart = epochMSecs_waveStart + static_cast<qreal>(i * model.getPeriodTotMSec());
+
+      // end of this period
+      qreal periodStop = periodStart + static_cast<qreal>(model.getPeriodTotMSec());
+
+      // the wavelet may be backward phased up to 359 degrees, adjust for that
+      periodStart -= phaseOffsetMSecs;
+      periodStop -= phaseOffsetMSecs;
+
+      // see if the current time is within this period
+      if ((epochMSeconds_RightNow_real >= periodStart &&
+         epochMSeconds_RightNow_real < periodStop) == false)
+      {
+         // it wasn't, check next
+         continue;
+      }
+
+      // the amount of seconds for one quarter
+      qreal ninetyDegreesTime = static_cast<qreal>(model.getPeriodTotMSec()) / 4.0;
+
+      // find the quarter of the period that the current time is within
+      for (int j = 0; j < 4; j++)
+      {
+         // quarter interval time definitions
+         qreal quarterStart = periodStart + (static_cast<qreal>(j)* ninetyDegreesTime);
+         qreal quarterStop = quarterStart + ninetyDegreesTime;
+
+         // see if the current time is within this quartet
+         if ((epochMSeconds_RightNow_real >= quarterStart &&
+            epochMSeconds_RightNow_real < quarterStop) == false)
+         {
+            // it wasn't, check next
+            continue;
+         }
+
+         // locate the correct task at the correct time
+         switch (j)
+         {
+         case(0) :
+            if (quarterStart == epochMSeconds_RightNow_real && referenceCleanPhase(model) &&
+               model.hasSinking()) {
+               quarterStop = quarterStart; wp = SINKING;
+            }
+            else if (model.hasPeak())
+            {
+               quarterStop += 0 * ninetyDegreesTime;
+               wp = PEAK;
+            }
+            else if (model.hasRising())
+            {
+               quarterStop += 1 * ninetyDegreesTime;
+               wp = RISING;
+            }
+            else if (model.hasValley())
+            {
+               quarterStop += 2 * ninetyDegreesTime;
+               wp = VALLEY;
+            }
+            else if (model.hasSinking())
+            {
+               quarterStop += 3 * ninetyDegreesTime;
+               wp = SINKING;
+            }
+            break;
+
+         case(1) :
+            if (quarterStart == epochMSeconds_RightNow_real && referenceCleanPhase(model) &&
+               model.hasPeak())
+            {
+               quarterStop = quarterStart; wp = PEAK;
+            }
+            else if (model.hasRising())
+            {
+               quarterStop += 0 * ninetyDegreesTime;
+               wp = RISING;
+            }
+            else if (model.hasValley())
+            {
+               quarterStop += 1 * ninetyDegreesTime;
+               wp = VALLEY;
+            }
+            else if (model.hasSinking())
+            {
+               quarterStop += 2 * ninetyDegreesTime;
+               wp = SINKING;
+            }
+            else if (model.hasPeak())
+            {
+               quarterStop += 3 * ninetyDegreesTime;
+               wp = PEAK;
+            }
+            break;
+
+         case(2) :
+            if (quarterStart == epochMSeconds_RightNow_real && referenceCleanPhase(model) &&
+               model.hasRising())
+            {
+               quarterStop = quarterStart; wp = RISING;
+            }
+            else if (model.hasValley())
+            {
+               quarterStop += 0 * ninetyDegreesTime;
+               wp = VALLEY;
+            }
+            else if (model.hasSinking())
+            {
+               quarterStop += 1 * ninetyDegreesTime;
+               wp = SINKING;
+            }
+            else if (model.hasPeak())
+            {
+               quarterStop += 2 * ninetyDegreesTime;
+               wp = PEAK;
+            }
+            else if (model.hasRising())
+            {
+               quarterStop += 3 * ninetyDegreesTime;
+               wp = RISING;
+            }
+            break;
+
+         case(3) :
+            if (quarterStart == epochMSeconds_RightNow_real && referenceCleanPhase(model) &&
+               model.hasValley())
+            {
+               quarterStop = quarterStart; wp = VALLEY;
+            }
+            else if (model.hasSinking())
+            {
+               quarterStop += 0 * ninetyDegreesTime;
+               wp = SINKING;
+            }
+            else if (model.hasPeak())
+            {
+               quarterStop += 1 * ninetyDegreesTime;
+               wp = PEAK;
+            }
+            else if (model.hasRising())
+            {
+               quarterStop += 2 * ninetyDegreesTime;
+               wp = RISING;
+            }
+            else if (model.hasValley())
+            {
+               quarterStop += 3 * ninetyDegreesTime;
+               wp = VALLEY;
+            }
+            break;
+
+         default:
+         wp = WP_NOT_SPECIFIED;
+         return false;
+         }
+
+         msecs = qFloor(quarterStop - epochMSeconds_RightNow_real);
+         if (msecs <= 100 && quarterStart != epochMSeconds_RightNow_real)
+         {
+            // 2 consecutive triggers that are less than 0.1 seconds between each other is discarded
+            return false;
+         }
+         if (msecs > epochMSecs_waveStop)
+         {
+            // the time found is outside the wavelet interval, so it is rejected
+            return false;
+         }
+
+         // success, task and time found
+         return true;
+
+      }
+   }
+
+   // some decision should have been made at this point, if there were any valid task to identify within the wavelet at this time
+   return false;
+}
+
+static bool referenceTrigger_STATIC(SautoModel &model, qint64 &msecs, qint64 now, const SautoDayContext &day)
+{
+   if (!model.hasPeak())
+   {
+      return false;
+   }
+
+   qreal epochMSecs_intervalStart = 0;
+   qreal epochMSecs_intervalStop = 0;
+   if (!referenceInterval(model, epochMSecs_intervalStart, epochMSecs_intervalStop, now, day))
+   {
+      return false;
+   }
+
+   quint64 epochMSeconds_RightNow = now;
+   qreal   epochMSeconds_RightNow_r = static_cast<qreal>(epochMSeconds_RightNow);
+   qreal   periodMSec = static_cast<qreal>(model.getPeriodTotMSec());
+   qreal   dur = static_cast<qreal>(model.getDuration());
+   quint64 candidate = 0;
+   int     noTriggers = qRound(dur / periodMSec);
+   bool    hit = false;
+
+   for (int i = 0; i<noTriggers; i++)
+   {
+      qreal start = epochMSecs_intervalStart + (static_cast<qreal>(i)*periodMSec);
+      qreal stop = start + periodMSec;
+      if (start == epochMSeconds_RightNow)
+      {
+         candidate = 0;
+         hit = true;
+         break;
+      }
+      else if (stop == epochMSeconds_RightNow_r)
+      {
+         candidate = qRound(periodMSec);
+         hit = true;
+         break;
+      }
+      else if (epochMSeconds_RightNow_r > start && epochMSeconds_RightNow_r < stop)
+      {
+         candidate = qRound(stop - epochMSeconds_RightNow_r);
+         hit = true;
+         break;
+      }
+   }
+
+   if (!hit || candidate > qRound(epochMSecs_intervalStop))
+   {
+      return false;
+   }
+   msecs = candidate;
+   return true;
+}
+
+//  Like SautoModel::calculateNextTrigger(), on a copy of the model since the interval of a wavelet
+//  that lasts the whole day is moved to the current time
+static bool referenceTrigger(SautoModel model, qint64 &msecs, EWavePoint &wp, qint64 now, const SautoDayContext &day)
+{
+   wp = WP_NOT_SPECIFIED;
+   if (model.getType() == WAVELET)
+   {
+      return referenceTrigger_WAVELET(model, msecs, wp, now, day);
+   }
+   return referenceTrigger_STATIC(model, msecs, now, day);
+}
+
+//  The windowed trigger calculations are checked against the full scans over random models, at
+//  random times and on the boundaries of the periods and their quarters, before both are measured
+void SautoBench::benchTriggers()
+{
+   std::mt19937 random(20261017);
+   const qreal phases[] = { 0, 90, 180, 270, 45, 137.5, 359.9, -90, 360, 450, 1e9 };
+   const char *const tasks[] = { "peak", "valley", "rising", "sinking" };
+   const qint64 noon = m_time.currentMSecsSinceEpoch();
+   for (int round = 0; round < 1000; round++)
+   {
+      // up to 2000 periods for the full scan to go through, odd periods give phase offsets with fractions
+      const EIntervalType type = round % 2 == 0 ? STATIC : WAVELET;
+      const quint64 period = 1 + random() % (round % 3 == 0 ? 997 : msecsPer_Hour);
+      const quint64 duration = qMin<quint64>(msecsPer_Day, period * (1 + random() % 2000) + random() % period);
+      const quint64 start = random() % msecsPer_Day;
+      const qreal phase = round % 4 == 0 ? static_cast<qreal>(random() % 720) - 180 : phases[random() % 11];
+      QString onTask[4];
+      const quint32 taskMask = type == STATIC ? 1 : random() % 16;
+      for (int i = 0; i < 4; i++)
+      {
+         if (taskMask & (1 << i))
+         {
+            onTask[i] = tasks[i];
+         }
+      }
+
+      SautoModel model(type, phase, duration, start, period, true, onTask[0], onTask[1], onTask[2], onTask[3]);
+      if (round % 10 == 3)
+      {
+         // a wavelet of the whole day starts when the trigger is first asked for
+         model = SautoModel(type, phase, msecsPer_Day, 0, period, false, onTask[0], onTask[1], onTask[2], onTask[3]);
+      }
+      else if (round % 10 == 7)
+      {
+         // a custom interval without a start time starts at the current time
+         model.setStartTimeMSecs(-1);
+         model.setHasCustomInterval(true);
+      }
+
+      const SautoDayContext today = localDayContext(noon);
+      const qint64 sessionStart = today.toEpoch(qMax<qint64>(0, model.getStartTimeMSec()));
+      const qreal phaseOffset = static_cast<qreal>(period * model.getPhase()) / 360.0;
+      for (int i = 0; i < 64; i++)
+      {
+         qint64 now = 0;
+         if (i % 2 == 0)
+         {
+            now = sessionStart - static_cast<qint64>(period) + static_cast<qint64>(random() % (duration + 2 * period));
+         }
+         else
+         {
+            const qint64 periodIndex = random() % (duration / period + 2);
+            const qreal boundary = sessionStart + periodIndex * static_cast<qreal>(period) - phaseOffset + (random() % 4) * static_cast<qreal>(period) / 4.0;
+            now = qFloor(boundary) + static_cast<qint64>(random() % 3) - 1;
+         }
+
+         const SautoDayContext day = localDayContext(now);
+         qint64 expectedMSecs = 0;
+         EWavePoint expectedWp = WP_NOT_SPECIFIED;
+         const bool expected = referenceTrigger(model, expectedMSecs, expectedWp, now, day);
+
+         SautoModel windowed = model;
+         qint64 msecs = 0;
+         bool ok = false;
+         EWavePoint wp = WP_NOT_SPECIFIED;
+         windowed.calculateNextTrigger(msecs, ok, wp, now, day);
+         if (ok != expected || (ok && (msecs != expectedMSecs || wp != expectedWp)))
+         {
+            qWarning("The windowed %s trigger disagrees with the full scan at %lld, period %llu, phase %g : %s %lld %d against %s %lld %d",
+               type == STATIC ? "STATIC" : "WAVELET", now, period, model.getPhase(),
+               ok ? "true" : "false", msecs, wp, expected ? "true" : "false", expectedMSecs, expectedWp);
+            return;
+         }
+      }
+   }
+
+   // the same models as benchModel(), a session of 8 hours has 288000 periods of 100 msecs
+   const SautoModel staticModel(STATIC, 0, 8 * msecsPer_Hour, 8 * msecsPer_Hour, 100, true, "peak");
+   const SautoModel waveModel(WAVELET, 45, 8 * msecsPer_Hour, 8 * msecsPer_Hour, msecsPer_Sec, true, "peak", "valley", "rising", "sinking");
+   const SautoDayContext day = localDayContext(noon);
+   qint64 msecs = 0;
+   EWavePoint wp = WP_NOT_SPECIFIED;
+   measure("SautoModel::calculateNextTrigger/STATIC full scan", 1000, [&]() {
+      referenceTrigger(staticModel, msecs, wp, noon, day);
+   });
+   measure("SautoModel::calculateNextTrigger/WAVELET full scan", 1000, [&]() {
+      referenceTrigger(waveModel, msecs, wp, noon, day);
+   });
+}
+
+void SautoBench::benchSession()
+{
+   struct Schedule
+   {
+      const char *name;
+      INTERVAL_LIST intervals;
+      WEEK_DEF week;
+      CALENDAR_DEF calendar;
+   };
+   const Schedule schedules[] =
+   {
+      { "frequency", INTERVAL_LIST(), WEEK_DEF(), CALENDAR_DEF() },
+      { "interval", m_intervals, WEEK_DEF(), CALENDAR_DEF() },
+      { "week", m_intervals, m_week, CALENDAR_DEF() },
+      { "calendar", m_intervals, m_week, m_calendar },
+   };
+
+   for (int i = 0; i < 4; i++)
+   {
+      Sauto *clock = new Sauto;
+      clock->setTimeSource(&m_time);
+      clock->init(0, m_freq, schedules[i].intervals, schedules[i].week, schedules[i].calendar);
+      measure(QString("Sauto::planNextSession/%1").arg(schedules[i].name), 20000, [&]() {
+         clock->planNextSession();
+      });
+      delete clock;
+   }
+}
+
+//  The triggers of a clock with a session of an hour from 12:10 and one trigger a minute, run in
+//  virtual time from 12:00 for an hour and a half. The wall clock is stepped by the argument msecs
+//  at 12:40, in the middle of the session
+static int sessionTriggers(qint64 msecsJump)
+{
+   SautoSimulator simulator(QDateTime(QDate(2026, 6, 15), QTime(12, 0, 0)).toMSecsSinceEpoch());
+   SautoManager *manager = simulator.manager();
+   int fired = 0;
+   QObject::connect(manager, static_cast<void (SautoManager::*)(int, const QString &)>(&SautoManager::triggered),
+      [&fired](int, const QString &) { ++fired; });
+
+   INTERVAL_LIST intervals;
+   intervals.append(SautoModel(STATIC, 0, msecsPer_Hour, 12 * msecsPer_Hour + 10 * msecsPer_Min, msecsPer_Min, true, "jump"));
+   manager->addClock(1, SautoModel(), intervals, WEEK_DEF(), CALENDAR_DEF());
+   manager->startClock(1);
+   simulator.runFor(40 * msecsPer_Min);
+   simulator.time().stepWallClock(msecsJump);
+   simulator.runFor(50 * msecsPer_Min);
+   return fired;
+}
+
+//  A step of the wall clock in the middle of a session leaves the rest of the session as it was, it
+//  fires the same triggers as it does without the step, forward and backward
+void SautoBench::checkClockJump()
+{
+   const int expected = sessionTriggers(0);
+   const qint64 jumps[] = { 3 * msecsPer_Hour, -3 * msecsPer_Hour };
+   for (int i = 0; i < 2; i++)
+   {
+      const int fired = sessionTriggers(jumps[i]);
+      if (expected == 0 || fired != expected)
+      {
+         qWarning("A session fired %d triggers when the wall clock was stepped %lld msecs in the middle of it, and %d without the step",
+            fired, jumps[i], expected);
+      }
+   }
+}
+
+void SautoBench::benchXml()
+{
+   QTemporaryDir dir;
+   const QString fileName = dir.path() + "/sautoBench.xml";
+   {
+      SautoXml writer;
+      if (!writer.writeClockFile(fileName, m_freq, m_intervals, m_week, m_calendar))
+      {
+         return;
+      }
+   }
+
+   measure("SautoXml::readClockFile", 500, [&]() {
+      SautoModel freq;
+      INTERVAL_LIST intervals;
+      WEEK_DEF week;
+      CALENDAR_DEF calendar;
+      SautoXml reader;
+      reader.readClockFile(fileName, freq, intervals, week, calendar);
+   });
+
+   const QString binaryFileName = binaryClockFileName(fileName);
+   if (!convertClockFile(fileName, binaryFileName))
+   {
+      return;
+   }
+
+   measure("SautoBinary::readClockFile", 500, [&]() {
+      SautoModel freq;
+      INTERVAL_LIST intervals;
+      WEEK_DEF week;
+      CALENDAR_DEF calendar;
+      SautoBinary reader;
+      reader.readClockFile(binaryFileName, freq, intervals, week, calendar);
+   });
+}
+
+//  Reloads a clock from its file, which is read, compiled and compared against the running clock
+void SautoBench::benchReload()
+{
+   QTemporaryDir dir;
+   const QString fileName = dir.path() + "/sautoReload.xml";
+   {
+      SautoXml writer;
+      if (!writer.writeClockFile(fileName, m_freq, m_intervals, m_week, m_calendar))
+      {
+         return;
+      }
+   }
+
+   SautoManager *manager = new SautoManager;
+   manager->setTimeSource(&m_time);
+   if (manager->loadClocks(QStringList() << fileName).loaded == 1)
+   {
+      measure("SautoManager::reloadClock", 200, [&]() {
+         manager->reloadClock(fileName);
+      });
+   }
+   delete manager;
+}
+
+//  Records the clocks to a snapshot, and measures how long a new manager takes to restore them
+void SautoBench::benchSnapshot(int clocks)
+{
+   QTemporaryDir dir;
+   const QString fileName = dir.path() + "/sautoBench.snapshot";
+   {
+      SautoManager manager;
+      if (manager.openSnapshot(fileName, LATE_SKIP, 0) < 0)
+      {
+         return;
+      }
+      for (int id = 0; id < clocks; id++)
+      {
+         manager.addClock(id, m_freq, m_intervals, m_week, CALENDAR_DEF());
+      }
+      manager.checkpoint();
+   }
+
+   measure(QString("SautoManager::openSnapshot/%1").arg(clocks), 1, [&]() {
+      SautoManager manager;
+      manager.openSnapshot(fileName, LATE_SKIP, 0);
+   });
+}
+
+//  Adds and starts the clocks on the real time, and measures the CPU time that they use afterwards
+//  while they wait for their sessions
+void SautoBench::benchManager(EClockMode mode, int clocks)
+{
+   const QString modeName = mode == CLOCK_DEADLINE ? "deadline" : "polling";
+   SautoManager *manager = new SautoManager;
+   manager->setClockMode(mode);
+
+   int id = 0;
+   measure(QString("SautoManager::addClock/%1/%2").arg(modeName).arg(clocks), clocks, [&]() {
+      manager->addClock(id++, m_freq, m_intervals, m_week, CALENDAR_DEF());
+   });
+
+   id = 0;
+   SautoBenchResult &result = measure(QString("SautoManager::startClock/%1/%2").arg(modeName).arg(clocks), clocks, [&]() {
+      manager->startClock(id++);
+   });
+
+   // let every clock plan its first session before the idle time is measured
+   QEventLoop loop;
+   QTimer::singleShot(200, &loop, SLOT(quit()));
+   loop.exec();
+
+   const std::clock_t cpuStart = std::clock();
+   QTimer::singleShot(m_idleMSecs, &loop, SLOT(quit()));
+   loop.exec();
+   const std::clock_t cpuStop = std::clock();
+
+   const qreal cpuNSecs = static_cast<qreal>(cpuStop - cpuStart) * 1e9 / CLOCKS_PER_SEC;
+   result.idleCpuNsPerClock = cpuNSecs / clocks / (m_idleMSecs / 1000.0);
+   delete manager;
+}
+
+bool SautoBench::write(const QString &fileName) const
+{
+   QJsonArray results;
+   for (int i = 0; i < m_results.size(); i++)
+   {
+      const SautoBenchResult &result = m_results.at(i);
+      QJsonObject entry;
+      entry.insert("name", result.name);
+      entry.insert("iterations", static_cast<double>(result.iterations));
+      entry.insert("nsPerOp", result.nsPerOp);
+      entry.insert("allocsPerOp", result.allocsPerOp);
+      if (result.idleCpuNsPerClock >= 0)
+      {
+         entry.insert("idleCpuNsPerClockPerSec", result.idleCpuNsPerClock);
+      }
+      results.append(entry);
+   }
+
+   QJsonObject root;
+   root.insert("format", 1);
+   root.insert("qtVersion", QString(qVersion()));
+   root.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+   root.insert("results", results);
+
+   QFile file(fileName);
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+   {
+      return false;
+   }
+   file.write(QJsonDocument(root).toJson());
+   return true;
+}
@@ -0,0 +1,101 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoBench.h
+//
+//  \brief     Definition of the benchmarks for the scheduling hot paths
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_BENCH_H
+#define _SAUTO_BENCH_H
+
+// Qt includes
+#include <QObject>
+#include <QList>
+#include <QString>
+
+// solution includes
+#include <sautoModel/sautoDefs.h>
+#include <sautoModel/sautoTime.h>
+
+namespace sauto {
+
+   struct SautoBenchResult
+   {
+      SautoBenchResult() : iterations(0), nsPerOp(0), allocsPerOp(0), idleCpuNsPerClock(-1) {}
+      QString name;
+      quint64 iterations;
+      qreal nsPerOp;
+      qreal allocsPerOp;
+      qreal idleCpuNsPerClock; //< CPU time per clock per second of idling, -1 when not measured
+   };
+
+   class SautoBench : public QObject
+   {
+      Q_OBJECT
+
+   public:
+      explicit SautoBench(QObject *parent = 0);
+      ~SautoBench();
+      inline void setMaxClocks(int clocks) { m_maxClocks = clocks; }
+      inline void setIdleMSecs(int msecs) { m_idleMSecs = msecs; }
+      inline const QList<SautoBenchResult>& results() const { return m_results; }
+      void run();
+      bool write(const QString &fileName) const;
+
+   private:
+      template<typename Op> SautoBenchResult& measure(const QString &name, quint64 iterations, Op op);
+      void benchCivil();
+      void benchModel();
+      void benchTriggers();
+      void benchSession();
+      void checkClockJump();
+      void benchXml();
+      void benchReload();
+      void benchSnapshot(int clocks);
+      void benchManager(EClockMode mode, int clocks);
+      void makeSchedules();
+
+   private:
+      SautoVirtualTime m_time;
+      int m_maxClocks;
+      int m_idleMSecs;
+      SautoModel m_freq;
+      INTERVAL_LIST m_intervals;
+      WEEK_DEF m_week;
+      CALENDAR_DEF m_calendar;
+      QList<SautoBenchResult> m_results;
+   };
+
+   quint64 benchAllocations();
+}
+
+#endif
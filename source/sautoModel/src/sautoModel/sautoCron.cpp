@@ -0,0 +1,380 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoCron.cpp
+//
+//  \brief     Implementation of a schedule given as a cron expression
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// Qt includes
+#include <QStringList>
+
+// local includes
+#include "sautoCron.h"
+
+using namespace sauto;
+
+namespace {
+   struct CronField
+   {
+      const char *name;
+      int low;
+      int high;
+      const char *const *names; //< names of the values from low and up, 0 if the field has none
+   };
+
+   const char *const s_monthNames[] = { "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec", 0 };
+   const char *const s_weekdayNames[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat", 0 };
+
+   const CronField s_fields[5] = {
+      { "minute",       0, 59, 0 },
+      { "hour",         0, 23, 0 },
+      { "day of month", 1, 31, 0 },
+      { "month",        1, 12, s_monthNames },
+      { "day of week",  0, 7,  s_weekdayNames },
+   };
+
+   const qint64 s_minutesPerDay = secsPer_Day / secsPer_Min;
+   const int s_minutesPerHour = secsPer_Hour / secsPer_Min;
+
+   bool cronValue(const QString &text, const CronField &field, int &value)
+   {
+      bool ok;
+      value = text.toInt(&ok);
+      if (ok)
+      {
+         return value >= field.low && value <= field.high;
+      }
+      for (int i = 0; field.names != 0 && field.names[i] != 0; i++)
+      {
+         if (text.compare(QLatin1String(field.names[i]), Qt::CaseInsensitive) == 0)
+         {
+            value = field.low + i;
+            return true;
+         }
+      }
+      return false;
+   }
+
+   //  The bits of the mask from the argument bit and up
+   inline quint64 bitsFrom(quint64 mask, int bit)
+   {
+      return bit > 63 ? 0 : mask & (~Q_UINT64_C(0) << bit);
+   }
+}
+
+SautoCron::SautoCron()
+   :m_minutes(0),
+   m_hours(0),
+   m_days(0),
+   m_months(0),
+   m_weekdays(0),
+   m_anyDay(true),
+   m_anyWeekday(true)
+{
+
+}
+
+SautoCron::SautoCron(const QString &expression)
+   :m_minutes(0),
+   m_hours(0),
+   m_days(0),
+   m_months(0),
+   m_weekdays(0),
+   m_anyDay(true),
+   m_anyWeekday(true)
+{
+   parse(expression);
+}
+
+void SautoCron::clear()
+{
+   m_expression.clear();
+   m_minutes = 0;
+   m_hours = 0;
+   m_days = 0;
+   m_months = 0;
+   m_weekdays = 0;
+   m_anyDay = true;
+   m_anyWeekday = true;
+}
+
+//  Compiles the expression, an expression that is not valid leaves the cron empty, and says why in
+//  the error string
+bool SautoCron::parse(const QString &expression, QString *error)
+{
+   clear();
+   QString text = expression.simplified();
+   if (text.startsWith(QLatin1Char('@')))
+   {
+      const QString name = text.toLower();
+      if (name == "@yearly" || name == "@annually")
+      {
+         text = "0 0 1 1 *";
+      }
+      else if (name == "@monthly")
+      {
+         text = "0 0 1 * *";
+      }
+      else if (name == "@weekly")
+      {
+         text = "0 0 * * 0";
+      }
+      else if (name == "@daily" || name == "@midnight")
+      {
+         text = "0 0 * * *";
+      }
+      else if (name == "@hourly")
+      {
+         text = "0 * * * *";
+      }
+      else
+      {
+         if (error != 0)
+         {
+            *error = QString("Unknown cron shorthand \"%1\"").arg(text);
+         }
+         return false;
+      }
+   }
+
+   const QStringList fields = text.split(QLatin1Char(' '));
+   if (fields.size() != 5)
+   {
+      if (error != 0)
+      {
+         *error = QString("A cron expression has 5 fields, \"%1\" has %2").arg(expression).arg(fields.size());
+      }
+      return false;
+   }
+
+   quint64 masks[5];
+   for (int i = 0; i < 5; i++)
+   {
+      if (!parseField(fields.at(i), i, masks[i], error))
+      {
+         return false;
+      }
+   }
+
+   m_expression = expression;
+   m_minutes = masks[0];
+   m_hours = static_cast<quint32>(masks[1]);
+   m_days = static_cast<quint32>(masks[2]);
+   m_months = static_cast<quint16>(masks[3]);
+
+   // 7 is sunday as well as 0
+   m_weekdays = static_cast<quint8>((masks[4] | (masks[4] >> 7)) & 0x7F);
+
+   // like cron, a field that starts with * leaves the day to the other field, also when it has a step
+   m_anyDay = fields.at(2).startsWith(QLatin1Char('*'));
+   m_anyWeekday = fields.at(4).startsWith(QLatin1Char('*'));
+   return true;
+}
+
+//  One field of the expression, a list of *, a or a-b, each with an optional /step. A single value
+//  with a step runs to the end of the range, like 5/15 in the minute field is 5,20,35,50
+bool SautoCron::parseField(const QString &text, int index, quint64 &mask, QString *error) const
+{
+   const CronField &field = s_fields[index];
+   mask = 0;
+   const QStringList items = text.split(QLatin1Char(','));
+   for (int i = 0; i < items.size(); i++)
+   {
+      const QString &item = items.at(i);
+      QString range = item;
+      int step = 1;
+      const int slash = item.indexOf(QLatin1Char('/'));
+      if (slash >= 0)
+      {
+         bool ok;
+         step = item.mid(slash + 1).toInt(&ok);
+         range = item.left(slash);
+         if (!ok || step < 1)
+         {
+            if (error != 0)
+            {
+               *error = QString("The step of \"%1\" in the %2 field is not a positive number").arg(item).arg(field.name);
+            }
+            return false;
+         }
+      }
+
+      int first = field.low;
+      int last = field.high;
+      if (range != "*")
+      {
+         const int dash = range.indexOf(QLatin1Char('-'));
+         bool ok = cronValue(dash < 0 ? range : range.left(dash), field, first);
+         if (ok && dash >= 0)
+         {
+            ok = cronValue(range.mid(dash + 1), field, last);
+         }
+         else if (slash < 0)
+         {
+            last = first;
+         }
+
+         if (!ok || last < first)
+         {
+            if (error != 0)
+            {
+               *error = QString("\"%1\" is not valid in the %2 field, it takes %3 to %4").arg(item).arg(field.name).arg(field.low).arg(field.high);
+            }
+            return false;
+         }
+      }
+
+      for (int value = first; value <= last; value += step)
+      {
+         mask |= Q_UINT64_C(1) << value;
+      }
+   }
+   return true;
+}
+
+bool SautoCron::operator==(const SautoCron &other) const
+{
+   return m_minutes == other.m_minutes &&
+      m_hours == other.m_hours &&
+      m_days == other.m_days &&
+      m_months == other.m_months &&
+      m_weekdays == other.m_weekdays &&
+      m_anyDay == other.m_anyDay &&
+      m_anyWeekday == other.m_anyWeekday;
+}
+
+//  The days of a month that the expression matches, bit n is day n. The weekday field is laid out
+//  over the month from the weekday of the 1st, so no day is looked at on its own
+quint32 SautoCron::dayMask(int year, int month) const
+{
+   const quint32 valid = ((quint32(1) << daysInMonth(year, month)) - 1) << 1;
+   if (m_anyWeekday)
+   {
+      return m_days & valid;
+   }
+
+   // bit n of the week is the weekday of day n + 1, rotated from the weekday of the 1st
+   const int first = dayOfWeekFromDays(daysFromCivil(year, month, 1)) % 7;
+   const quint32 week = ((static_cast<quint32>(m_weekdays) >> first) | (static_cast<quint32>(m_weekdays) << (7 - first))) & 0x7F;
+   const quint64 weeks = static_cast<quint64>(week) | (static_cast<quint64>(week) << 7) | (static_cast<quint64>(week) << 14) |
+      (static_cast<quint64>(week) << 21) | (static_cast<quint64>(week) << 28);
+   const quint32 weekdays = static_cast<quint32>(weeks << 1) & valid;
+   if (m_anyDay)
+   {
+      return weekdays;
+   }
+   return (m_days & valid) | weekdays;
+}
+
+//  The first minute that the expression matches strictly after the argument time, -1 if there is
+//  none. Each field moves on to its first match at or after where the search is, with one bit
+//  scan, and the fields below it start over when it has moved. Only a field that has nothing left
+//  carries into the one above it, so a match is found in a few rounds however far away it is
+qint64 SautoCron::next(qint64 localMSecs) const
+{
+   if (!isValid())
+   {
+      return -1;
+   }
+
+   const qint64 from = floorDiv(localMSecs, msecsPer_Min) + 1;
+   const qint64 fromDay = floorDiv(from, s_minutesPerDay);
+   const SautoCivilDate date = civilFromDays(fromDay);
+   int year = date.year;
+   int month = date.month;
+   int day = date.day;
+   int hour = static_cast<int>(from - fromDay * s_minutesPerDay) / s_minutesPerHour;
+   int minute = static_cast<int>(from - fromDay * s_minutesPerDay) % s_minutesPerHour;
+
+   const int lastYear = year + CRON_SEARCH_YEARS;
+   while (year <= lastYear)
+   {
+      const quint64 months = bitsFrom(m_months, month);
+      if (months == 0)
+      {
+         year++;
+         month = 1;
+         day = 1;
+         hour = 0;
+         minute = 0;
+         continue;
+      }
+      if (static_cast<int>(qCountTrailingZeroBits(months)) != month)
+      {
+         month = qCountTrailingZeroBits(months);
+         day = 1;
+         hour = 0;
+         minute = 0;
+      }
+
+      const quint64 days = bitsFrom(dayMask(year, month), day);
+      if (days == 0)
+      {
+         month++;
+         day = 1;
+         hour = 0;
+         minute = 0;
+         continue;
+      }
+      if (static_cast<int>(qCountTrailingZeroBits(days)) != day)
+      {
+         day = qCountTrailingZeroBits(days);
+         hour = 0;
+         minute = 0;
+      }
+
+      const quint64 hours = bitsFrom(m_hours, hour);
+      if (hours == 0)
+      {
+         day++;
+         hour = 0;
+         minute = 0;
+         continue;
+      }
+      if (static_cast<int>(qCountTrailingZeroBits(hours)) != hour)
+      {
+         hour = qCountTrailingZeroBits(hours);
+         minute = 0;
+      }
+
+      const quint64 minutes = bitsFrom(m_minutes, minute);
+      if (minutes == 0)
+      {
+         hour++;
+         minute = 0;
+         continue;
+      }
+      minute = qCountTrailingZeroBits(minutes);
+      return (daysFromCivil(year, month, day) * s_minutesPerDay + hour * s_minutesPerHour + minute) * msecsPer_Min;
+   }
+   return -1;
+}
@@ -0,0 +1,101 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoCron.h
+//
+//  \brief     Definition of a schedule given as a cron expression
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _SAUTO_CRON_H
+#define _SAUTO_CRON_H
+
+// Qt includes
+#include <QString>
+
+// local includes
+#include "timeStuff.h"
+
+namespace sauto {
+
+   // a day of the week in a cron expression, 7 is read as sunday too
+   static const int CRON_SUNDAY = 0;
+
+   // every combination of leap year and weekday has come around within this many years, a day that
+   // is not found by then never comes, like the 30th of february
+   static const int CRON_SEARCH_YEARS = 28;
+
+   // The five fields of a cron expression, minute hour day-of-month month day-of-week, compiled
+   // into one bitset each. A field takes *, numbers, ranges a-b, steps */n and a-b/n and lists of
+   // them separated by commas, and months and weekdays may be given by their english three letter
+   // names. @yearly, @annually, @monthly, @weekly, @daily and @hourly are the usual shorthands.
+   //
+   // Like cron, a day matches when either of the two day fields does, unless one of them is *,
+   // then only the other one counts.
+   //
+   // The times are msecs on the timeline of the zone the clock runs in, that is msecs since epoch
+   // plus the UTC offset, so the expression knows nothing about time zones or DST
+   class SautoCron
+   {
+   public:
+      SautoCron();
+      explicit SautoCron(const QString &expression);
+      bool parse(const QString &expression, QString *error = 0);
+      void clear();
+      bool operator==(const SautoCron &other) const;
+      inline bool operator!=(const SautoCron &other) const { return !(*this == other); }
+
+      inline bool isValid() const { return m_minutes != 0; }
+      inline const QString& expression() const { return m_expression; }
+      inline quint64 minutes() const { return m_minutes; }
+      inline quint32 hours() const { return m_hours; }
+      inline quint32 daysOfMonth() const { return m_days; }
+      inline quint16 months() const { return m_months; }
+      inline quint8 daysOfWeek() const { return m_weekdays; }
+      qint64 next(qint64 localMSecs) const;
+      quint32 dayMask(int year, int month) const;
+
+   private:
+      bool parseField(const QString &field, int index, quint64 &mask, QString *error) const;
+
+   private:
+      QString m_expression;
+      quint64 m_minutes;   //< bit n is minute n
+      quint32 m_hours;     //< bit n is hour n
+      quint32 m_days;      //< bit n is day n of the month
+      quint16 m_months;    //< bit n is month n, 1 is january
+      quint8 m_weekdays;   //< bit n is weekday n, 0 is sunday
+      bool m_anyDay;       //< the day of month field is *
+      bool m_anyWeekday;   //< the day of week field is *
+   };
+}
+
+#endif
@@ -84,9 +84,9 @@ QPair<int, QString> sauto::findNextMonthInt(const MONTH_DEF &month)
 
 //  Check if there are any future sessions in the argument date, for the argument
 //  intervals
-bool sauto::dateHasSessionInFront(const QDate &date, const INTERVAL_LIST &interval)
+bool sauto::dateHasSessionInFront(const QDate &date, const INTERVAL_LIST &interval, const SautoTimeSource &time)
 {
-   const QDateTime now = QDateTime::currentDateTime();
+   const QDateTime now = time.currentDateTime();
    if (now.date() > date)
    {
       // the argument date is in the past, no need the check the intervals
@@ -103,14 +103,18 @@ bool sauto::dateHasSessionInFront(const QDate &date, const INTERVAL_LIST &interv
       return false;
    }
 
-   // the interval list is not empty, check them
-   INTERVAL_ITERATOR it(interval);
-   while (it.hasNext())
+   // the interval list is not empty, every interval starts that day if the date is ahead of today
+   if (now.date() < date)
+   {
+      return true;
+   }
+
+   // compare the start times with the time of day, the start time wraps around midnight
+   const qint64 nowMs = get_MSEC_sinceMidnight(now.time());
+   for (int i = 0; i < interval.size(); i++)
    {
-      SautoModel def = it.next();
-      quint64 startMs = def.getStartTimeMSec();
-      QTime time = QTime(0, 0, 0).addMSecs(startMs);
-      if (QDateTime(date, time) >= now)
+      const qint64 startMs = (interval.at(i).getStartTimeMSec() % msecsPer_Day + msecsPer_Day) % msecsPer_Day;
+      if (startMs >= nowMs)
       {
          // the current interval is in the future
          return true;
@@ -121,34 +125,14 @@ bool sauto::dateHasSessionInFront(const QDate &date, const INTERVAL_LIST &interv
 
 DAYS sauto::getDayStringAsID(const QString &dayStr)
 {
-   DAYS day = NO_SPECIFIC_DAY;
-   QMap<DAYS, QString> week = makeWeek();
-   QMapIterator<DAYS, QString> it(week);
-   while (it.hasNext())
-   {
-      it.next();
-      if (it.value() == dayStr)
-      {
-         day = it.key();
-         break;
-      }
-   }
-   return day;
+   const int day = getDayAsInt(dayStr);
+   return day < 0 ? NO_SPECIFIC_DAY : static_cast<DAYS>(day);
 }
 
 MONTH_ID sauto::getMonthStringAsID(const QString &monthName)
 {
-   QMap<MONTH_ID, QString> year = makeYear();
-   QMapIterator<MONTH_ID, QString> it(year);
-   while (it.hasNext())
-   {
-      it.next();
-      if (it.value() == monthName)
-      {
-         return it.key();
-      }
-   }
-   return NO_SPECIFIC_MONTH;
+   const int month = getMonthAsInt(monthName);
+   return month < 0 ? NO_SPECIFIC_MONTH : static_cast<MONTH_ID>(month);
 }
 
 QString sauto::getDayIDasString(DAYS day)
@@ -97,7 +97,7 @@ namespace sauto {
 
    WEEK_DEF makeEmptyWeekData();
    QPair<int, QString> findNextMonthInt(const MONTH_DEF &month);
-   bool dateHasSessionInFront(const QDate &date, const INTERVAL_LIST &interval);
+   bool dateHasSessionInFront(const QDate &date, const INTERVAL_LIST &interval, const SautoTimeSource &time = systemTime());
    DAYS getDayStringAsID(const QString &dayStr);
    MONTH_ID getMonthStringAsID(const QString &monthName);
    QString getDayIDasString(DAYS day);
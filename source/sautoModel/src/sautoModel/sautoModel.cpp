@@ -42,16 +42,19 @@
 
 using namespace sauto;
 
+// the schedules keep their models in flat arrays, see SautoSchedule
+Q_STATIC_ASSERT(sizeof(SautoModel) <= 48);
+
 SautoModel::SautoModel()
-   :m_type(NOT_SPECIFIED),
-   m_phase(0.0),
-   m_durationMSecs(msecsPer_Day),
+   :m_phase(0.0),
    m_startTimeMSecs(0),
+   m_durationMSecs(msecsPer_Day),
    m_periodTotalMSecs(0),
-   m_periodMSecs(0),
-   m_periodSeconds(0),
-   m_periodMinutes(0),
-   m_periodHours(0),
+   m_onPeak(SAUTO_NO_TASK),
+   m_onValley(SAUTO_NO_TASK),
+   m_onRising(SAUTO_NO_TASK),
+   m_onSinking(SAUTO_NO_TASK),
+   m_type(NOT_SPECIFIED),
    m_hasCustomInterval(false)
 {
 
@@ -67,14 +70,15 @@ SautoModel::SautoModel(EIntervalType type,
    const   QString &onValley,
    const   QString &onRising,
    const   QString &onSinking)
-   :m_type(NOT_SPECIFIED),
-   m_phase(0.0),
-   m_durationMSecs(msecsPer_Day),
+   :m_phase(0.0),
    m_startTimeMSecs(startTimeMSecs),
+   m_durationMSecs(msecsPer_Day),
    m_periodTotalMSecs(0),
-   m_periodSeconds(0),
-   m_periodMinutes(0),
-   m_periodHours(0),
+   m_onPeak(SAUTO_NO_TASK),
+   m_onValley(SAUTO_NO_TASK),
+   m_onRising(SAUTO_NO_TASK),
+   m_onSinking(SAUTO_NO_TASK),
+   m_type(NOT_SPECIFIED),
    m_hasCustomInterval(false)
 {
    setType(type);
@@ -89,44 +93,25 @@ SautoModel::SautoModel(EIntervalType type,
    setHasCustomInterval(hasCustom);
 }
 
-SautoModel::SautoModel(const SautoModel &other)
-{
-   *this = other;
-}
-
-SautoModel::~SautoModel()
+//  Two models are equal when they make the same sessions and triggers, the period fields follow the total
+bool SautoModel::operator==(const SautoModel &arg) const
 {
-
+   return m_type == arg.m_type &&
+      qFuzzyCompare(1.0 + m_phase, 1.0 + arg.m_phase) &&
+      m_durationMSecs == arg.m_durationMSecs &&
+      m_startTimeMSecs == arg.m_startTimeMSecs &&
+      m_periodTotalMSecs == arg.m_periodTotalMSecs &&
+      m_hasCustomInterval == arg.m_hasCustomInterval &&
+      m_onPeak == arg.m_onPeak &&
+      m_onValley == arg.m_onValley &&
+      m_onRising == arg.m_onRising &&
+      m_onSinking == arg.m_onSinking;
 }
 
-SautoModel& SautoModel::operator=(const SautoModel &arg)
+//  Replaces one of the parts of the period, the others are left as they are
+void SautoModel::setPeriodPart(unsigned short oldValue, unsigned short newValue, quint32 unitMSecs)
 {
-   this->setType(arg.getType());
-   this->setPhase(arg.getPhase());
-   this->setDuration(arg.getDuration());
-   this->setStartTimeMSecs(arg.getStartTimeMSec());
-   this->setPeriodTotMSecs(arg.getPeriodTotMSec());
-   this->setOnPeak(arg.getOnPeak());
-   this->setOnValley(arg.getOnValley());
-   this->setOnRising(arg.getOnRising());
-   this->setOnSinking(arg.getOnSinking());
-   this->setHasCustomInterval(arg.getHasCustomInterval());
-   return *this;
-}
-
-void SautoModel::calcTimeToPeriod()
-{
-   m_periodTotalMSecs = ((m_periodHours * 60 * 60 +
-      m_periodMinutes * 60 +
-      m_periodSeconds) * 1000) + m_periodMSecs;
-}
-
-void SautoModel::calcPeriodToTime()
-{
-   m_periodHours = qFloor(static_cast<qreal>(m_periodTotalMSecs) / (1000 * 60 * 60));
-   m_periodMinutes = qFloor(static_cast<qreal>(m_periodTotalMSecs) / (1000 * 60.0) - (m_periodHours * 60));
-   m_periodSeconds = qFloor(static_cast<qreal>(m_periodTotalMSecs) / (1000) - (m_periodHours * 60 * 60) - (m_periodMinutes * 60));
-   m_periodMSecs = m_periodTotalMSecs - (m_periodHours * 60 * 60 * 1000) - (m_periodMinutes * 60 * 1000) - (m_periodSeconds * 1000);
+   m_periodTotalMSecs = m_periodTotalMSecs - oldValue * unitMSecs + newValue * unitMSecs;
 }
 
 void SautoModel::setDuration(quint64 duration)
@@ -134,7 +119,7 @@ void SautoModel::setDuration(quint64 duration)
    if (duration <= msecsPer_Day)
    {
       // only allow wavelet durations that are less than 1 day
-      m_durationMSecs = duration;
+      m_durationMSecs = static_cast<quint32>(duration);
    }
 }
 
@@ -153,9 +138,7 @@ void SautoModel::setPeriodTotMSecs(quint64 msecs)
 {
    if (msecs <= m_maxTimeletPeriod)
    {
-      m_periodTotalMSecs = msecs;
-      calcPeriodToTime();
-      getHasCustomInterval();
+      m_periodTotalMSecs = static_cast<quint32>(msecs);
    }
 }
 
@@ -163,8 +146,7 @@ void SautoModel::setMSecs(unsigned short msecs)
 {
    if (msecs < 1000)
    {
-      m_periodMSecs = msecs;
-      calcTimeToPeriod();
+      setPeriodPart(getMSecs(), msecs, 1);
    }
 }
 
@@ -172,8 +154,7 @@ void SautoModel::setSeconds(unsigned short seconds)
 {
    if (seconds < 60)
    {
-      m_periodSeconds = seconds;
-      calcTimeToPeriod();
+      setPeriodPart(getSecs(), seconds, msecsPer_Sec);
    }
 }
 
@@ -181,8 +162,7 @@ void SautoModel::setMinutes(unsigned short minutes)
 {
    if (minutes < 60)
    {
-      m_periodMinutes = minutes;
-      calcTimeToPeriod();
+      setPeriodPart(getMins(), minutes, msecsPer_Min);
    }
 }
 
@@ -190,8 +170,7 @@ void SautoModel::setHours(unsigned short hours)
 {
    if (hours < 24)
    {
-      m_periodHours = hours;
-      calcTimeToPeriod();
+      setPeriodPart(getHours(), hours, msecsPer_Hour);
    }
 }
 
@@ -218,8 +197,7 @@ bool SautoModel::isValid() const
    }
    else if (m_type == WAVELET)
    {
-      if (m_periodTotalMSecs <= 0 ||
-         (m_periodSeconds <= 0 && m_periodMinutes <= 0 && m_periodHours <= 0 && m_periodMSecs <= 0))
+      if (m_periodTotalMSecs <= 0)
       {
          return false;
       }
@@ -254,22 +232,25 @@ void SautoModel::reset()
    m_durationMSecs = 0;
    m_startTimeMSecs = 0;
    m_periodTotalMSecs = 0;
-   m_periodMSecs = 0;
-   m_periodSeconds = 0;
-   m_periodMinutes = 0;
-   m_periodHours = 0;
    m_hasCustomInterval = false;
-   m_onPeak = "";
-   m_onValley = "";
-   m_onRising = "";
-   m_onSinking = "";
+   m_onPeak = SAUTO_NO_TASK;
+   m_onValley = SAUTO_NO_TASK;
+   m_onRising = SAUTO_NO_TASK;
+   m_onSinking = SAUTO_NO_TASK;
 }
 
 
 //  Find the amount of seconds until the interval starts, starting from now.
 //  NOTE : this function will not care about what type of interval it is
 //  so it can be WAVELET, STATIC or SINGLE.
-quint64 SautoModel::calculateNextSession(bool &ok, bool ignoreCurrentTime, bool lookTomorrow)
+quint64 SautoModel::calculateNextSession(bool &ok, bool ignoreCurrentTime, bool lookTomorrow, const SautoTimeSource &time) const
+{
+   const qint64 now = time.currentMSecsSinceEpoch();
+   return calculateNextSession(ok, ignoreCurrentTime, lookTomorrow, now, localDayContext(now));
+}
+
+//  The start time of the model is a wall clock time of the argument day
+quint64 SautoModel::calculateNextSession(bool &ok, bool ignoreCurrentTime, bool lookTomorrow, qint64 now, const SautoDayContext &day) const
 {
    ok = true;
    if (ignoreCurrentTime)
@@ -282,22 +263,17 @@ quint64 SautoModel::calculateNextSession(bool &ok, bool ignoreCurrentTime, bool
    }
 
    qint64 mSecsToNextSession = 0;
-   QDateTime now = QDateTime::currentDateTime();
-   quint64 msecRightNow = get_MSEC_sinceMidnight(now.time());
-   QDateTime midnight(now.date(), QTime(0, 0, 0));
-   quint64 midnightMsec = midnight.toMSecsSinceEpoch();
-   quint64 msecStart = midnightMsec + m_startTimeMSecs;
+   const qint64 msecStart = day.toEpoch(m_startTimeMSecs);
    bool hasEnded = true;
    if (m_type != SINGLE)
    {
-      quint64 endTime = msecStart + m_durationMSecs - 200;
-      quint64 nowMsecEpo = now.toMSecsSinceEpoch();
-      if (endTime < nowMsecEpo)
+      const qint64 endTime = msecStart + m_durationMSecs - 200;
+      if (endTime < now)
       {
          // this interval has ended
          if (lookTomorrow)
          {
-            return msecsPer_Day - msecRightNow + m_startTimeMSecs;
+            return day.msecsToTomorrow(now) + m_startTimeMSecs;
          }
          else
          {
@@ -314,7 +290,7 @@ quint64 SautoModel::calculateNextSession(bool &ok, bool ignoreCurrentTime, bool
    // now, find the amount of seconds from the start of this day, until the session begins
    if (m_hasCustomInterval)
    {
-      mSecsToNextSession = msecStart - msecRightNow - midnightMsec;
+      mSecsToNextSession = msecStart - now;
    }
 
    if (0 > mSecsToNextSession)
@@ -334,24 +310,30 @@ quint64 SautoModel::calculateNextSession(bool &ok, bool ignoreCurrentTime, bool
 //  NOTE : Assumes UTC time
 //  this function will see when the next trigger from the wavelet will occur, given that
 //  the current time is within the boundaries of the wavelet
-EIntervalType SautoModel::calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoint &wp)
+EIntervalType SautoModel::calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoint &wp, const SautoTimeSource &time)
+{
+   const qint64 now = time.currentMSecsSinceEpoch();
+   return calculateNextTrigger(msecs, ok, wp, now, localDayContext(now));
+}
+
+EIntervalType SautoModel::calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoint &wp, qint64 now, const SautoDayContext &day)
 {
    ok = true;
    switch (m_type)
    {
 
    case(WAVELET) :
-      if (ok = (calculateNextTrigger_WAVELET(msecs, wp))) return WAVELET;
+      if (ok = (calculateNextTrigger_WAVELET(msecs, wp, now, day))) return WAVELET;
       break;
 
    case(STATIC) :
       wp = WP_NOT_SPECIFIED;
-      if (ok = (calculateNextTrigger_STATIC(msecs))) return STATIC;
+      if (ok = (calculateNextTrigger_STATIC(msecs, now, day))) return STATIC;
       break;
 
    case(SINGLE) :
       wp = WP_NOT_SPECIFIED;
-      if (ok = (calculateNextTrigger_SINGLE(msecs))) return SINGLE;
+      if (ok = (calculateNextTrigger_SINGLE(msecs, now, day))) return SINGLE;
       break;
 
    default:
@@ -363,7 +345,7 @@ EIntervalType SautoModel::calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoi
 
 //  Given the current time, this function will find if, and when, the next trigger
 //  in the wavelet will occur, and what kind of task this trigger will perform
-bool SautoModel::calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp)
+bool SautoModel::calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp, qint64 now, const SautoDayContext &day)
 {
    // check if there are any tasks at all
    if (!hasPeak() && !hasRising() && !hasSinking() && !hasValley())
@@ -374,13 +356,13 @@ bool SautoModel::calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp)
 
    qreal epochMSecs_waveStart = 0;
    qreal epochMSecs_waveStop = 0;
-   if (!currentInterval(epochMSecs_waveStart, epochMSecs_waveStop))
+   if (!currentInterval(epochMSecs_waveStart, epochMSecs_waveStop, now, day))
    {
       wp = WP_NOT_SPECIFIED;
       return false;
    }
 
-   quint64 epochMSeconds_RightNow = QDateTime::currentDateTime().toMSecsSinceEpoch();
+   quint64 epochMSeconds_RightNow = now;
    qreal   epochMSeconds_RightNow_real = static_cast<qreal>(epochMSeconds_RightNow);
    qreal   startMSec = static_cast<qreal>(getStartTimeMSec());
    if (startMSec < 0)
@@ -390,8 +372,14 @@ bool SautoModel::calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp)
    qreal phaseOffsetMSecs = static_cast<qreal>(getPeriodTotMSec() * getPhase()) / 360.0;
    int noPeriods = qRound((startMSec + static_cast<qreal>(getDuration())) / static_cast<qreal>(getPeriodTotMSec()));
 
-   // go through all the periods to locate the next one to occur
-   for (int i = 0; i < noPeriods; i++)
+   // only the period that the current time falls into can match, its neighbours are
+   // checked as well so that rounding of the phase offset gives the same result as a full scan
+   qreal periodsElapsed = qBound<qreal>(-1, (epochMSeconds_RightNow_real - epochMSecs_waveStart + phaseOffsetMSecs) / static_cast<qreal>(getPeriodTotMSec()), noPeriods);
+   int firstPeriod = qMax(0, qFloor(periodsElapsed) - 1);
+   int lastPeriod = qMin(noPeriods, qFloor(periodsElapsed) + 2);
+
+   // go through the candidate periods to locate the next one to occur
+   for (int i = firstPeriod; i < lastPeriod; i++)
    {
       // start of this period
       qreal periodStart = epochMSecs_waveStart + static_cast<qreal>(i * getPeriodTotMSec());
@@ -549,7 +537,7 @@ bool SautoModel::calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp)
          }
 
          msecs = qFloor(quarterStop - epochMSeconds_RightNow_real);
-         if (msecs <= 100 && quarterStart != epochMSeconds_RightNow_real)
+         if (msecs <= TRIGGER_SPACING_MSEC && quarterStart != epochMSeconds_RightNow_real)
          {
             // 2 consecutive triggers that are less than 0.1 seconds between each other is discarded
             return false;
@@ -570,7 +558,7 @@ bool SautoModel::calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp)
    return false;
 }
 
-bool SautoModel::calculateNextTrigger_STATIC(qint64 &msecs)
+bool SautoModel::calculateNextTrigger_STATIC(qint64 &msecs, qint64 now, const SautoDayContext &day)
 {
    if (!hasPeak())
    {
@@ -579,12 +567,12 @@ bool SautoModel::calculateNextTrigger_STATIC(qint64 &msecs)
 
    qreal epochMSecs_intervalStart = 0;
    qreal epochMSecs_intervalStop = 0;
-   if (!currentInterval(epochMSecs_intervalStart, epochMSecs_intervalStop))
+   if (!currentInterval(epochMSecs_intervalStart, epochMSecs_intervalStop, now, day))
    {
       return false;
    }
 
-   quint64 epochMSeconds_RightNow = QDateTime::currentDateTime().toMSecsSinceEpoch();
+   quint64 epochMSeconds_RightNow = now;
    qreal   epochMSeconds_RightNow_r = static_cast<qreal>(epochMSeconds_RightNow);
    qreal   periodMSec = static_cast<qreal>(this->getPeriodTotMSec());
    qreal   dur = static_cast<qreal>(this->getDuration());
@@ -592,7 +580,13 @@ bool SautoModel::calculateNextTrigger_STATIC(qint64 &msecs)
    int     noTriggers = qRound(dur / periodMSec);
    bool    hit = false;
 
-   for (int i = 0; i<noTriggers; i++)
+   // the current time is within period i = floor((now - start) / period), or on the boundary
+   // closing period i - 1, so there is no need to go through the periods before that
+   qreal   periodsElapsed = qBound<qreal>(-1, (epochMSeconds_RightNow_r - epochMSecs_intervalStart) / periodMSec, noTriggers);
+   int     firstTrigger = qMax(0, qFloor(periodsElapsed) - 1);
+   int     lastTrigger = qMin(noTriggers, qFloor(periodsElapsed) + 2);
+
+   for (int i = firstTrigger; i<lastTrigger; i++)
    {
       qreal start = epochMSecs_intervalStart + (static_cast<qreal>(i)*periodMSec);
       qreal stop = start + periodMSec;
@@ -624,15 +618,14 @@ bool SautoModel::calculateNextTrigger_STATIC(qint64 &msecs)
    return true;
 }
 
-bool SautoModel::calculateNextTrigger_SINGLE(qint64 &msecs)
+bool SautoModel::calculateNextTrigger_SINGLE(qint64 &msecs, qint64 now, const SautoDayContext &day)
 {
    if (m_type != SINGLE)
    {
       return false;
    }
-   quint64 epochMSeconds_MidnightToday = QDateTime(QDate::currentDate(), QTime(0, 0, 0, 0)).toMSecsSinceEpoch();
-   quint64 epochMSeconds_RightNow = QDateTime::currentDateTime().toMSecsSinceEpoch();
-   quint64 triggerTime = epochMSeconds_MidnightToday + this->getStartTimeMSec();
+   quint64 epochMSeconds_RightNow = now;
+   quint64 triggerTime = day.toEpoch(this->getStartTimeMSec());
    if (epochMSeconds_RightNow > triggerTime)
    {
       return false;
@@ -641,31 +634,29 @@ bool SautoModel::calculateNextTrigger_SINGLE(qint64 &msecs)
    return true;
 }
 
-bool SautoModel::currentInterval(qreal &start, qreal &stop)
+bool SautoModel::currentInterval(qreal &start, qreal &stop, qint64 now, const SautoDayContext &day)
 {
    if (m_type == SINGLE || m_type == NOT_SPECIFIED)
    {
       return false;
    }
 
-   // the amount of epoch milliseconds at midnight, today
-   quint64 epochMSeconds_MidnightToday = QDateTime(QDate::currentDate(), QTime(0, 0, 0, 0)).toMSecsSinceEpoch();
-
-   // the amount of epoch milliseconds right now
-   quint64 epochMSeconds_RightNow = QDateTime::currentDateTime().toMSecsSinceEpoch();
+   // the amount of epoch milliseconds right now, and the wall clock time of the day
+   quint64 epochMSeconds_RightNow = now;
+   const qint64 msecsOfDay = day.msecsOfDay(now);
 
    // first check if the wavelet last for 1 day, starting midnight (when no interval is defined)
-   if (m_startTimeMSecs == 0 && m_durationMSecs == msecsPer_Day && m_hasCustomInterval == false)
+   if (startsWhenAsked())
    {
       // what this means, is that the defined interval for the wavelet starts at midnight, and last the entire day
       // based on this, it is assumed that since the client asks for the next trigger, it is being done for the first time
       // on this wavelet, for this running session
 
       // start it now, so that the behaviour reflects the start of the wavelet, as indicated by the GUI
-      setStartTimeMSecs(epochMSeconds_RightNow - epochMSeconds_MidnightToday);
+      setStartTimeMSecs(msecsOfDay);
 
       // last the rest of the day
-      setDuration(msecsPer_Day - (epochMSeconds_RightNow - epochMSeconds_MidnightToday));
+      setDuration(msecsPer_Day - msecsOfDay);
    }
 
    if (m_startTimeMSecs < 0 && m_hasCustomInterval && m_durationMSecs > 0)
@@ -676,8 +667,7 @@ bool SautoModel::currentInterval(qreal &start, qreal &stop)
    }
 
    // the time when this wavelet will start
-   qreal startMSec = static_cast<qreal>(m_startTimeMSecs);
-   qreal epochMSecs_intervalStart = epochMSeconds_MidnightToday + startMSec;
+   qreal epochMSecs_intervalStart = static_cast<qreal>(day.toEpoch(m_startTimeMSecs));
 
    // see if this wavelet has already started
    if (epochMSeconds_RightNow < epochMSecs_intervalStart)
@@ -701,6 +691,29 @@ bool SautoModel::currentInterval(qreal &start, qreal &stop)
    return true;
 }
 
+//  A whole day model without an interval of its own starts its session at the time it is asked for
+//  the next trigger, and runs for the rest of that day, see currentInterval()
+bool SautoModel::startsWhenAsked() const
+{
+   return m_startTimeMSecs == 0 && m_durationMSecs == msecsPer_Day && m_hasCustomInterval == false;
+}
+
+//  The msecs from one trigger of a session to the next, 0 when a session has only one trigger
+qint64 SautoModel::triggerStep() const
+{
+   switch (m_type)
+   {
+   case(WAVELET) :
+      return qRound(static_cast<qreal>(m_periodTotalMSecs) / 4);
+
+   case(STATIC) :
+      return m_periodTotalMSecs;
+
+   default:
+      return 0;
+   }
+}
+
 bool SautoModel::hasCleanPhase() const
 {
    if (getPhase() == 0 ||
@@ -727,63 +740,47 @@ void SautoModel::setPhase(qreal phase)
 
 void SautoModel::setOnPeak(const QString &file)
 {
-   m_onPeak = file;
+   m_onPeak = SautoTasks::intern(file);
 }
 
 void SautoModel::setOnValley(const QString &file)
 {
-   m_onValley = file;
+   m_onValley = SautoTasks::intern(file);
 }
 
 void SautoModel::setOnRising(const QString &file)
 {
-   m_onRising = file;
+   m_onRising = SautoTasks::intern(file);
 }
 
 void SautoModel::setOnSinking(const QString &file)
 {
-   m_onSinking = file;
+   m_onSinking = SautoTasks::intern(file);
 }
 
 bool SautoModel::hasPeak() const
 {
-   if (m_onPeak != "")
-   {
-      return true;
-   }
-   return false;
+   return m_onPeak != SAUTO_NO_TASK;
 }
 
 bool SautoModel::hasValley() const
 {
-   if (m_onValley != "")
-   {
-      return true;
-   }
-   return false;
+   return m_onValley != SAUTO_NO_TASK;
 }
 
 bool SautoModel::hasRising() const
 {
-   if (m_onRising != "")
-   {
-      return true;
-   }
-   return false;
+   return m_onRising != SAUTO_NO_TASK;
 }
 
 bool SautoModel::hasSinking() const
 {
-   if (m_onSinking != "")
-   {
-      return true;
-   }
-   return false;
+   return m_onSinking != SAUTO_NO_TASK;
 }
 
 void SautoModel::updateHasCustomInterval()
 {
-   if (m_durationMSecs - m_startTimeMSecs == msecsPer_Day || m_durationMSecs > msecsPer_Day)
+   if (getDuration() - m_startTimeMSecs == msecsPer_Day || m_durationMSecs > msecsPer_Day)
    {
       m_hasCustomInterval = false;
    }
@@ -38,14 +38,18 @@
 #include <QString>
 
 // local includes
+#include "sautoTasks.h"
 #include "timeStuff.h"
 
 namespace sauto {
+   // The model is copied by value everywhere, from the interval lists to the compiled schedules, so
+   // it is kept small and trivially copyable. The period is stored once as a total, and its hours,
+   // minutes, seconds and msecs are derived from it when they are asked for. Copies and moves are
+   // left to the compiler
    class SautoModel
    {
    public:
       explicit SautoModel();
-      SautoModel(const SautoModel &other);
       explicit SautoModel(EIntervalType type,
          qreal   phase,
          quint64 durationMSecs,
@@ -56,28 +60,36 @@ namespace sauto {
          const   QString &onValley = "",
          const   QString &onRising = "",
          const   QString &onSinking = "");
-      ~SautoModel();
-      SautoModel& operator=(const SautoModel &arg);
+      bool operator==(const SautoModel &arg) const;
+      inline bool operator!=(const SautoModel &arg) const { return !(*this == arg); }
 
       const QString getTypeString() const;
       bool isValid() const;
       void reset();
-      EIntervalType calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoint &wp);
-      quint64 calculateNextSession(bool &ok, bool ignoreCurrentTime = false, bool lookTomorrow = false);
+      EIntervalType calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoint &wp, const SautoTimeSource &time = systemTime());
+      EIntervalType calculateNextTrigger(qint64 &msecs, bool &ok, EWavePoint &wp, qint64 now, const SautoDayContext &day);
+      quint64 calculateNextSession(bool &ok, bool ignoreCurrentTime = false, bool lookTomorrow = false, const SautoTimeSource &time = systemTime()) const;
+      quint64 calculateNextSession(bool &ok, bool ignoreCurrentTime, bool lookTomorrow, qint64 now, const SautoDayContext &day) const;
+      bool startsWhenAsked() const;
+      qint64 triggerStep() const;
 
       inline EIntervalType getType()    const { return m_type; }
       inline qreal getPhase()           const { return m_phase; }
-      inline QString getOnPeak()        const { return m_onPeak; }
-      inline QString getOnValley()      const { return m_onValley; }
-      inline QString getOnRising()      const { return m_onRising; }
-      inline QString getOnSinking()     const { return m_onSinking; }
+      inline QString getOnPeak()        const { return SautoTasks::name(m_onPeak); }
+      inline QString getOnValley()      const { return SautoTasks::name(m_onValley); }
+      inline QString getOnRising()      const { return SautoTasks::name(m_onRising); }
+      inline QString getOnSinking()     const { return SautoTasks::name(m_onSinking); }
+      inline SautoTaskId onPeakId()     const { return m_onPeak; }
+      inline SautoTaskId onValleyId()   const { return m_onValley; }
+      inline SautoTaskId onRisingId()   const { return m_onRising; }
+      inline SautoTaskId onSinkingId()  const { return m_onSinking; }
       inline quint64 getPeriodTotMSec() const { return m_periodTotalMSecs; }
       inline quint64 getDuration()      const { return m_durationMSecs; }
       inline qint64 getStartTimeMSec()  const { return m_startTimeMSecs; }
-      inline unsigned short getMSecs()  const { return m_periodMSecs; }
-      inline unsigned short getSecs()   const { return m_periodSeconds; }
-      inline unsigned short getMins()   const { return m_periodMinutes; }
-      inline unsigned short getHours()  const { return m_periodHours; }
+      inline unsigned short getMSecs()  const { return static_cast<unsigned short>(m_periodTotalMSecs % msecsPer_Sec); }
+      inline unsigned short getSecs()   const { return static_cast<unsigned short>(m_periodTotalMSecs / msecsPer_Sec % secsPer_Min); }
+      inline unsigned short getMins()   const { return static_cast<unsigned short>(m_periodTotalMSecs / msecsPer_Min % 60); }
+      inline unsigned short getHours()  const { return static_cast<unsigned short>(m_periodTotalMSecs / msecsPer_Hour); }
 
       inline void setHasCustomInterval(bool val) { m_hasCustomInterval = val; }
       bool getHasCustomInterval() const;
@@ -101,30 +113,28 @@ namespace sauto {
       void setHours(unsigned short hours);
 
    private:
-      void calcTimeToPeriod();
-      void calcPeriodToTime();
+      void setPeriodPart(unsigned short oldValue, unsigned short newValue, quint32 unitMSecs);
       bool hasCleanPhase() const;
-      bool currentInterval(qreal &start, qreal &stop);
-      bool calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp);
-      bool calculateNextTrigger_STATIC(qint64 &msecs);
-      bool calculateNextTrigger_SINGLE(qint64 &msecs);
+      bool currentInterval(qreal &start, qreal &stop, qint64 now, const SautoDayContext &day);
+      bool calculateNextTrigger_WAVELET(qint64 &msecs, EWavePoint &wp, qint64 now, const SautoDayContext &day);
+      bool calculateNextTrigger_STATIC(qint64 &msecs, qint64 now, const SautoDayContext &day);
+      bool calculateNextTrigger_SINGLE(qint64 &msecs, qint64 now, const SautoDayContext &day);
 
    private:
-      EIntervalType m_type;
+      // widest first, both the duration and the period are at most a day
       qreal   m_phase;
-      quint64 m_durationMSecs;
       qint64  m_startTimeMSecs;
-      quint64 m_periodTotalMSecs;
-      unsigned short m_periodMSecs;
-      unsigned short m_periodSeconds;
-      unsigned short m_periodMinutes;
-      unsigned short m_periodHours;
+      quint32 m_durationMSecs;
+      quint32 m_periodTotalMSecs;
+      SautoTaskId m_onPeak;
+      SautoTaskId m_onValley;
+      SautoTaskId m_onRising;
+      SautoTaskId m_onSinking;
+      EIntervalType m_type;
       bool m_hasCustomInterval;
-      QString m_onPeak;
-      QString m_onValley;
-      QString m_onRising;
-      QString m_onSinking;
    };
 }
 
+Q_DECLARE_TYPEINFO(sauto::SautoModel, Q_MOVABLE_TYPE);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,377 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoQuery.cpp
+//
+//  \brief     Implementation of a lazy query for the upcoming occurrences of a schedule
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// local includes
+#include "sautoQuery.h"
+
+using namespace sauto;
+
+SautoQuery::SautoQuery(const SautoSchedule &schedule, qint64 fromMSecsSinceEpoch, qint64 untilMSecsSinceEpoch, const SautoZone &zone)
+   :m_schedule(schedule),
+   m_zone(zone),
+   m_from(fromMSecsSinceEpoch),
+   m_until(untilMSecsSinceEpoch),
+   m_lastYear(0),
+   m_singleSession(false)
+{
+   init();
+}
+
+SautoQuery::SautoQuery(const SautoModel &def_frequency,
+   const INTERVAL_LIST &def_intervals,
+   const WEEK_DEF &def_week,
+   const CALENDAR_DEF &def_calendar,
+   qint64 fromMSecsSinceEpoch,
+   qint64 untilMSecsSinceEpoch,
+   const SautoZone &zone)
+   :m_zone(zone),
+   m_from(fromMSecsSinceEpoch),
+   m_until(untilMSecsSinceEpoch),
+   m_lastYear(0),
+   m_singleSession(false)
+{
+   m_schedule.compile(def_frequency, def_intervals, def_week, def_calendar);
+   init();
+}
+
+void SautoQuery::init()
+{
+   if (m_schedule.hasCalendar())
+   {
+      m_lastYear = m_schedule.years().last().year;
+   }
+
+   // a session that started the day before may still be running when the query starts
+   m_day = m_zone.dayContext(m_zone.dateAt(m_from).addDays(-1));
+}
+
+bool SautoQuery::next(SautoOccurrence &occurrence)
+{
+   while (true)
+   {
+      int front = -1;
+      for (int i = 0; i < m_cursors.size(); i++)
+      {
+         if (front < 0 || m_cursors.at(i).next < m_cursors.at(front).next)
+         {
+            front = i;
+         }
+      }
+
+      // sessions of a day that is not loaded yet can't start before its midnight
+      const bool moreDays = m_day.midnight <= m_until && (!m_schedule.hasCalendar() || m_day.date.year() <= m_lastYear);
+      if (moreDays && (front < 0 || m_cursors.at(front).next >= m_day.midnight))
+      {
+         loadDay();
+         continue;
+      }
+
+      if (front < 0 || m_cursors.at(front).next > m_until)
+      {
+         return false;
+      }
+
+      Cursor &cursor = m_cursors[front];
+      const SautoModel &def = model(cursor);
+      occurrence.type = cursor.type;
+      occurrence.msecsSinceEpoch = cursor.next;
+      occurrence.sessionStart = cursor.start;
+      occurrence.sessionStop = cursor.stop;
+      occurrence.intervalType = def.getType();
+      occurrence.wp = WP_NOT_SPECIFIED;
+      occurrence.taskID.clear();
+      if (cursor.type == OCCURRENCE_TRIGGER)
+      {
+         SautoTaskId task;
+         wavePointTask(def, cursor.k, occurrence.wp, task);
+         occurrence.taskID = SautoTasks::name(task);
+      }
+
+      if (!advance(cursor))
+      {
+         m_cursors.remove(front);
+      }
+      return true;
+   }
+}
+
+bool SautoQuery::nextTrigger(SautoOccurrence &occurrence)
+{
+   while (next(occurrence))
+   {
+      if (occurrence.type == OCCURRENCE_TRIGGER)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+QList<SautoOccurrence> SautoQuery::triggers(int count)
+{
+   QList<SautoOccurrence> found;
+   SautoOccurrence occurrence;
+   while (found.size() < count && nextTrigger(occurrence))
+   {
+      found.append(occurrence);
+   }
+   return found;
+}
+
+void SautoQuery::loadDay()
+{
+   const SautoDayContext day = m_day;
+   const int list = m_schedule.dayList(day.date);
+   m_day = m_zone.dayContext(day.nextMidnight);
+   if (list < 0)
+   {
+      return;
+   }
+
+   const SautoScheduleList &intervals = m_schedule.list(list);
+   if (intervals.inherit)
+   {
+      // an empty list means that the default frequency is used
+      if (m_schedule.frequency().isValid())
+      {
+         addSession(-1, 0, day);
+      }
+      return;
+   }
+
+   for (int i = 0; i < intervals.count; i++)
+   {
+      addSession(list, i, day);
+   }
+}
+
+void SautoQuery::addSession(int list, int index, const SautoDayContext &day)
+{
+   Cursor cursor;
+   cursor.list = list;
+   cursor.index = index;
+   cursor.k = 0;
+
+   const SautoModel &def = model(cursor);
+   if (def.getStartTimeMSec() < 0)
+   {
+      // the session starts along with the clock, and it only runs once
+      if (m_singleSession)
+      {
+         return;
+      }
+      m_singleSession = true;
+      cursor.start = m_from;
+   }
+   else if (def.startsWhenAsked())
+   {
+      // the clock asks for it at midnight, or when it is started on the day
+      cursor.start = qMax(day.midnight, m_from);
+   }
+   else
+   {
+      cursor.start = day.toEpoch(def.getStartTimeMSec());
+   }
+
+   // a SINGLE model is a session of one trigger, at its start
+   cursor.stop = cursor.start;
+   cursor.step = def.triggerStep();
+   if (def.startsWhenAsked())
+   {
+      cursor.stop = day.nextMidnight;
+   }
+   else if (def.getType() == STATIC || def.getType() == WAVELET)
+   {
+      cursor.stop += def.getDuration();
+   }
+
+   if (cursor.stop < m_from)
+   {
+      // the session ended before the query starts
+      return;
+   }
+
+   if (cursor.start >= m_from)
+   {
+      cursor.type = OCCURRENCE_SESSION_START;
+      cursor.next = cursor.start;
+   }
+   else if (!firstTrigger(cursor, m_from))
+   {
+      cursor.type = OCCURRENCE_SESSION_END;
+      cursor.next = cursor.stop;
+   }
+   m_cursors.append(cursor);
+}
+
+//  The first trigger of the session that a clock finds when it asks the model at the argument time.
+//  When the model drops a trigger that is too close, the clock asks again after its cooldown, until
+//  the dropped one has passed. Returns false when there are no triggers in the session
+bool SautoQuery::firstTrigger(Cursor &cursor, qint64 at) const
+{
+   // the model is a copy, a whole day model moves its start to the time it is asked at
+   SautoModel def = model(cursor);
+   const qint64 last = qMin(cursor.stop, at + TRIGGER_SPACING_MSEC + CLOCK_COOLDOWN_MSEC);
+   for (; at <= last; at += CLOCK_COOLDOWN_MSEC)
+   {
+      qint64 msecs = 0;
+      bool ok = false;
+      EWavePoint wp = WP_NOT_SPECIFIED;
+      def.calculateNextTrigger(msecs, ok, wp, at, m_zone.dayContext(at));
+      if (!ok)
+      {
+         continue;
+      }
+      if (at + msecs >= cursor.stop && cursor.step > 0)
+      {
+         return false;
+      }
+
+      cursor.type = OCCURRENCE_TRIGGER;
+      cursor.next = at + msecs;
+      switch (wp)
+      {
+      case(PEAK) :    cursor.k = 1; break;
+      case(SINKING) : cursor.k = 2; break;
+      case(VALLEY) :  cursor.k = 3; break;
+      default:        cursor.k = 0; break;
+      }
+      return true;
+   }
+   return false;
+}
+
+//  Moves the cursor on to the next trigger of the session that has a task, a step at a time like the
+//  countdown of a clock. Returns false when there are no more triggers in the session
+bool SautoQuery::nextTrigger(Cursor &cursor) const
+{
+   if (cursor.step <= 0)
+   {
+      return false;
+   }
+
+   // at least one of four wave points in a row has a task, if any of them has
+   const SautoModel &def = model(cursor);
+   EWavePoint wp;
+   SautoTaskId task;
+   for (int i = 0; i < 4; i++)
+   {
+      cursor.k++;
+      cursor.next += cursor.step;
+      if (cursor.next >= cursor.stop)
+      {
+         return false;
+      }
+      if (wavePointTask(def, cursor.k, wp, task))
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+bool SautoQuery::advance(Cursor &cursor) const
+{
+   switch (cursor.type)
+   {
+   case(OCCURRENCE_SESSION_START) :
+      if (firstTrigger(cursor, cursor.start))
+      {
+         return true;
+      }
+      break;
+
+   case(OCCURRENCE_TRIGGER) :
+      if (nextTrigger(cursor))
+      {
+         return true;
+      }
+      break;
+
+   case(OCCURRENCE_SESSION_END) :
+   default:
+      return false;
+   }
+
+   cursor.type = OCCURRENCE_SESSION_END;
+   cursor.next = cursor.stop;
+   return true;
+}
+
+const SautoModel& SautoQuery::model(const Cursor &cursor) const
+{
+   if (cursor.list < 0)
+   {
+      return m_schedule.frequency();
+   }
+   return m_schedule.models(m_schedule.list(cursor.list))[cursor.index];
+}
+
+//  The wave point of trigger number quarter and its task, false if there is no task for it.
+//  Models that are not wavelets only have the peak task
+bool sauto::wavePointTask(const SautoModel &model, qint64 quarter, EWavePoint &wp, SautoTaskId &task)
+{
+   if (model.getType() != WAVELET)
+   {
+      wp = WP_NOT_SPECIFIED;
+      task = model.onPeakId();
+      return task != SAUTO_NO_TASK;
+   }
+
+   switch (quarter % 4)
+   {
+   case(1) :
+      wp = PEAK;
+      task = model.onPeakId();
+      break;
+
+   case(2) :
+      wp = SINKING;
+      task = model.onSinkingId();
+      break;
+
+   case(3) :
+      wp = VALLEY;
+      task = model.onValleyId();
+      break;
+
+   default:
+      wp = RISING;
+      task = model.onRisingId();
+      break;
+   }
+   return task != SAUTO_NO_TASK;
+}
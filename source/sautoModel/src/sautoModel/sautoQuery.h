@@ -0,0 +1,132 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoQuery.h
+//
+//  \brief     Definition of a lazy query for the upcoming occurrences of a schedule
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_QUERY_H
+#define _SAUTO_QUERY_H
+
+// Qt includes
+#include <QList>
+#include <QVector>
+
+// local includes
+#include "sautoSchedule.h"
+#include "sautoZone.h"
+
+namespace sauto {
+
+   enum EOccurrenceType
+   {
+      OCCURRENCE_SESSION_START ,
+      OCCURRENCE_TRIGGER       ,
+      OCCURRENCE_SESSION_END   ,
+   };
+
+   struct SautoOccurrence
+   {
+      SautoOccurrence() : type(OCCURRENCE_TRIGGER), msecsSinceEpoch(0), sessionStart(0), sessionStop(0), intervalType(NOT_SPECIFIED), wp(WP_NOT_SPECIFIED) {}
+      EOccurrenceType type;
+      qint64 msecsSinceEpoch;
+      qint64 sessionStart;
+      qint64 sessionStop;
+      EIntervalType intervalType;
+      EWavePoint wp;
+      QString taskID; //< empty for session starts and ends
+   };
+
+   // Walks a schedule from an arbitrary point in time, one day at a time, and hands out its session
+   // starts, triggers and session ends in time order. Nothing is calculated before it is asked for,
+   // and neither the schedule nor any clock is changed.
+   //
+   // Sessions run from start to start + duration, triggers are at the start of every period of a
+   // STATIC session and at every 90 degrees of a WAVELET session, where the wave points follow each
+   // other as peak, sinking, valley and rising. Wave points without a task are left out. The days
+   // are the days of the zone, so a start time is a time of day in it, also across DST changes.
+   //
+   // The first trigger of a session is planned by the model, the way a running clock plans it, so
+   // the same rules apply: a trigger too close to the time it is planned at is dropped, and a whole
+   // day model starts when it is asked, see SautoModel::startsWhenAsked().
+   class SautoQuery
+   {
+   public:
+      explicit SautoQuery(const SautoSchedule &schedule, qint64 fromMSecsSinceEpoch, qint64 untilMSecsSinceEpoch, const SautoZone &zone = SautoZone());
+      explicit SautoQuery(const SautoModel &def_frequency,
+         const INTERVAL_LIST &def_intervals,
+         const WEEK_DEF &def_week,
+         const CALENDAR_DEF &def_calendar,
+         qint64 fromMSecsSinceEpoch,
+         qint64 untilMSecsSinceEpoch,
+         const SautoZone &zone = SautoZone());
+
+      bool next(SautoOccurrence &occurrence);
+      bool nextTrigger(SautoOccurrence &occurrence);
+      QList<SautoOccurrence> triggers(int count);
+
+   private:
+      struct Cursor
+      {
+         int list;     //< -1 for the default frequency
+         int index;
+         EOccurrenceType type;
+         qint64 start;
+         qint64 stop;
+         qint64 next;
+         qint64 k;     //< number of the next trigger, its wave point is k % 4 from the rising one
+         qint64 step;  //< from one trigger to the next, see SautoModel::triggerStep()
+      };
+
+      void init();
+      void loadDay();
+      void addSession(int list, int index, const SautoDayContext &day);
+      bool firstTrigger(Cursor &cursor, qint64 at) const;
+      bool nextTrigger(Cursor &cursor) const;
+      bool advance(Cursor &cursor) const;
+      const SautoModel& model(const Cursor &cursor) const;
+
+   private:
+      SautoSchedule m_schedule;
+      SautoZone m_zone;
+      qint64 m_from;
+      qint64 m_until;
+      SautoDayContext m_day; //< the next day to load
+      int m_lastYear;
+      bool m_singleSession;
+      QVector<Cursor> m_cursors;
+   };
+
+   bool wavePointTask(const SautoModel &model, qint64 quarter, EWavePoint &wp, SautoTaskId &task);
+}
+
+#endif
@@ -0,0 +1,819 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoRecurrence.cpp
+//
+//  \brief     Implementation of a recurrence rule that selects the days of a schedule
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// std includes
+#include <algorithm>
+#include <limits>
+
+// Qt includes
+#include <QStringList>
+#include <QtAlgorithms>
+
+// local includes
+#include "sautoRecurrence.h"
+
+using namespace sauto;
+
+namespace {
+   const char *const s_weekdayNames[] = { "MO", "TU", "WE", "TH", "FR", "SA", "SU", 0 };
+
+   bool fail(QString *error, const QString &message)
+   {
+      if (error != 0)
+      {
+         *error = message;
+      }
+      return false;
+   }
+
+   qint64 floorMod(qint64 value, qint64 divisor)
+   {
+      return value - floorDiv(value, divisor) * divisor;
+   }
+
+   //  The lowest bit of the mask after the n lowest are cleared
+   quint32 nthBit(quint32 mask, int n)
+   {
+      for (int i = 0; i < n; i++)
+      {
+         mask &= mask - 1;
+      }
+      return mask & (0u - mask);
+   }
+
+   //  Bit n - 1 of the week is weekday n of the mask, counted from the argument weekday
+   quint32 rotateWeek(quint8 weekdays, int firstWeekday)
+   {
+      const int shift = firstWeekday - 1;
+      return ((static_cast<quint32>(weekdays) >> shift) | (static_cast<quint32>(weekdays) << (7 - shift))) & 0x7F;
+   }
+
+   //  The date part of an iCalendar DATE or DATE-TIME, yyyyMMdd, as days since 1970-01-01
+   bool parseDate(const QString &value, qint64 &day)
+   {
+      if (value.size() < 8)
+      {
+         return false;
+      }
+      bool yearOk, monthOk, dayOk;
+      const int year = value.left(4).toInt(&yearOk);
+      const int month = value.mid(4, 2).toInt(&monthOk);
+      const int dayOfMonth = value.mid(6, 2).toInt(&dayOk);
+      if (!yearOk || !monthOk || !dayOk || month < JANUARY || month > DECEMBER || dayOfMonth < 1 || dayOfMonth > daysInMonth(year, month))
+      {
+         return false;
+      }
+      day = daysFromCivil(year, month, dayOfMonth);
+      return true;
+   }
+
+   //  MO to SU as 1 to 7
+   int parseWeekday(const QString &value)
+   {
+      for (int i = 0; s_weekdayNames[i] != 0; i++)
+      {
+         if (value == QLatin1String(s_weekdayNames[i]))
+         {
+            return i + 1;
+         }
+      }
+      return 0;
+   }
+}
+
+SautoRecurrence::SautoRecurrence()
+{
+   clear();
+}
+
+SautoRecurrence::SautoRecurrence(const QString &text)
+{
+   parse(text);
+}
+
+void SautoRecurrence::clear()
+{
+   m_text.clear();
+   m_frequency = RECUR_NONE;
+   m_interval = 1;
+   m_start = 0;
+   m_until = std::numeric_limits<qint64>::max();
+   m_startDate = civilFromDays(0);
+   m_weekAnchor = MONDAY - THURSDAY;
+   m_months = 0;
+   m_monthDays = 0;
+   m_lastMonthDays = 0;
+   m_weekdays = 0;
+   for (int i = 0; i < 5; i++)
+   {
+      m_nth[i] = 0;
+      m_lastNth[i] = 0;
+   }
+   m_setPositions.clear();
+   m_exdates.clear();
+}
+
+//  Reads the DTSTART, RRULE and EXDATE lines of the text, a line with only the rule is read as
+//  RRULE. A text that is not valid leaves the recurrence empty, and says why in the error string
+bool SautoRecurrence::parse(const QString &text, QString *error)
+{
+   clear();
+   QString rule;
+   bool hasStart = false;
+   const QStringList lines = text.split(QLatin1Char('\n'), QString::SkipEmptyParts);
+   for (int i = 0; i < lines.size(); i++)
+   {
+      const QString line = lines.at(i).trimmed();
+      if (line.isEmpty())
+      {
+         continue;
+      }
+
+      // parameters like TZID are not needed for the dates
+      const int colon = line.indexOf(QLatin1Char(':'));
+      const QString name = colon < 0 ? QString("RRULE") : line.left(colon).section(QLatin1Char(';'), 0, 0).trimmed().toUpper();
+      const QString value = colon < 0 ? line : line.mid(colon + 1).trimmed();
+      if (name == "DTSTART")
+      {
+         if (!parseDate(value, m_start))
+         {
+            clear();
+            return fail(error, QString("DTSTART \"%1\" is not a date").arg(value));
+         }
+         hasStart = true;
+      }
+      else if (name == "RRULE")
+      {
+         rule = value;
+      }
+      else if (name == "EXDATE")
+      {
+         const QStringList dates = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+         for (int j = 0; j < dates.size(); j++)
+         {
+            qint64 day;
+            if (!parseDate(dates.at(j).trimmed(), day))
+            {
+               clear();
+               return fail(error, QString("EXDATE \"%1\" is not a date").arg(dates.at(j)));
+            }
+            m_exdates.append(day);
+         }
+      }
+      else
+      {
+         clear();
+         return fail(error, QString("The property %1 is not supported").arg(name));
+      }
+   }
+
+   if (!hasStart || rule.isEmpty())
+   {
+      clear();
+      return fail(error, "A recurrence needs both DTSTART and RRULE");
+   }
+   m_startDate = civilFromDays(m_start);
+   if (!parseRule(rule, error))
+   {
+      clear();
+      return false;
+   }
+
+   std::sort(m_exdates.begin(), m_exdates.end());
+   m_text = text;
+   return true;
+}
+
+bool SautoRecurrence::parseRule(const QString &rule, QString *error)
+{
+   int weekStart = MONDAY;
+   const QStringList parts = rule.split(QLatin1Char(';'), QString::SkipEmptyParts);
+   for (int i = 0; i < parts.size(); i++)
+   {
+      const int equals = parts.at(i).indexOf(QLatin1Char('='));
+      const QString key = parts.at(i).left(equals).trimmed().toUpper();
+      const QString value = parts.at(i).mid(equals + 1).trimmed().toUpper();
+      const QStringList values = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+      if (equals < 0 || values.isEmpty())
+      {
+         return fail(error, QString("\"%1\" is not a rule part").arg(parts.at(i)));
+      }
+
+      if (key == "FREQ")
+      {
+         if (value == "DAILY")
+         {
+            m_frequency = RECUR_DAILY;
+         }
+         else if (value == "WEEKLY")
+         {
+            m_frequency = RECUR_WEEKLY;
+         }
+         else if (value == "MONTHLY")
+         {
+            m_frequency = RECUR_MONTHLY;
+         }
+         else if (value == "YEARLY")
+         {
+            m_frequency = RECUR_YEARLY;
+         }
+         else
+         {
+            return fail(error, QString("FREQ=%1 is not supported, a recurrence selects whole days").arg(value));
+         }
+      }
+      else if (key == "INTERVAL")
+      {
+         bool ok;
+         m_interval = value.toInt(&ok);
+         if (!ok || m_interval < 1)
+         {
+            return fail(error, QString("INTERVAL=%1 is not a positive number").arg(value));
+         }
+      }
+      else if (key == "UNTIL")
+      {
+         if (!parseDate(value, m_until))
+         {
+            return fail(error, QString("UNTIL=%1 is not a date").arg(value));
+         }
+      }
+      else if (key == "WKST")
+      {
+         weekStart = parseWeekday(value);
+         if (weekStart == 0)
+         {
+            return fail(error, QString("WKST=%1 is not a weekday").arg(value));
+         }
+      }
+      else if (key == "BYMONTH")
+      {
+         for (int j = 0; j < values.size(); j++)
+         {
+            bool ok;
+            const int month = values.at(j).toInt(&ok);
+            if (!ok || month < JANUARY || month > DECEMBER)
+            {
+               return fail(error, QString("BYMONTH=%1 is not a month").arg(values.at(j)));
+            }
+            m_months |= 1 << month;
+         }
+      }
+      else if (key == "BYMONTHDAY")
+      {
+         for (int j = 0; j < values.size(); j++)
+         {
+            bool ok;
+            const int day = values.at(j).toInt(&ok);
+            if (!ok || day == 0 || day < -31 || day > 31)
+            {
+               return fail(error, QString("BYMONTHDAY=%1 is not a day of the month").arg(values.at(j)));
+            }
+            if (day > 0)
+            {
+               m_monthDays |= quint32(1) << day;
+            }
+            else
+            {
+               m_lastMonthDays |= quint32(1) << -day;
+            }
+         }
+      }
+      else if (key == "BYDAY")
+      {
+         for (int j = 0; j < values.size(); j++)
+         {
+            const QString &item = values.at(j);
+            const int weekday = parseWeekday(item.right(2));
+            bool ok = true;
+            const int ordinal = item.size() > 2 ? item.left(item.size() - 2).toInt(&ok) : 0;
+            if (!ok || weekday == 0 || ordinal < -5 || ordinal > 5 || (ordinal == 0 && item.size() > 2))
+            {
+               return fail(error, QString("BYDAY=%1 is not a weekday, an ordinal counts in the month and takes 1 to 5 or -1 to -5").arg(item));
+            }
+            if (ordinal > 0)
+            {
+               m_nth[ordinal - 1] |= 1 << (weekday - 1);
+            }
+            else if (ordinal < 0)
+            {
+               m_lastNth[-ordinal - 1] |= 1 << (weekday - 1);
+            }
+            else
+            {
+               m_weekdays |= 1 << (weekday - 1);
+            }
+         }
+      }
+      else if (key == "BYSETPOS")
+      {
+         for (int j = 0; j < values.size(); j++)
+         {
+            bool ok;
+            const int position = values.at(j).toInt(&ok);
+            if (!ok || position == 0 || position < -366 || position > 366)
+            {
+               return fail(error, QString("BYSETPOS=%1 is not a position").arg(values.at(j)));
+            }
+            m_setPositions.append(position);
+         }
+      }
+      else
+      {
+         return fail(error, QString("%1 is not supported").arg(key));
+      }
+   }
+
+   quint8 ordinals = 0;
+   for (int i = 0; i < 5; i++)
+   {
+      ordinals |= m_nth[i] | m_lastNth[i];
+   }
+   const bool byMonthDay = m_monthDays != 0 || m_lastMonthDays != 0;
+   const bool byDay = m_weekdays != 0 || ordinals != 0;
+
+   switch (m_frequency)
+   {
+   case(RECUR_DAILY) :
+      if (ordinals != 0 || !m_setPositions.isEmpty())
+      {
+         return fail(error, "A DAILY rule takes neither ordinal BYDAY nor BYSETPOS");
+      }
+      break;
+
+   case(RECUR_WEEKLY) :
+      if (ordinals != 0 || byMonthDay)
+      {
+         return fail(error, "A WEEKLY rule takes neither ordinal BYDAY nor BYMONTHDAY");
+      }
+      if (!byDay)
+      {
+         // the weekday of the start
+         m_weekdays = 1 << (dayOfWeekFromDays(m_start) - 1);
+      }
+      break;
+
+   case(RECUR_MONTHLY) :
+      if (!byDay && !byMonthDay)
+      {
+         // the day of the month of the start, months that are too short for it are left out
+         m_monthDays = quint32(1) << m_startDate.day;
+      }
+      break;
+
+   case(RECUR_YEARLY) :
+      if (ordinals != 0 && m_months == 0)
+      {
+         return fail(error, "A YEARLY rule with an ordinal BYDAY needs BYMONTH");
+      }
+      if (!byDay && !byMonthDay)
+      {
+         // the date of the start, the 29th of february is only in leap years
+         m_monthDays = quint32(1) << m_startDate.day;
+         if (m_months == 0)
+         {
+            m_months = 1 << m_startDate.month;
+         }
+      }
+      break;
+
+   case(RECUR_NONE) :
+   default:
+      return fail(error, "The rule has no FREQ");
+   }
+
+   // 1970-01-01 was a thursday, the weeks are counted from a day that is the first day of its week
+   m_weekAnchor = weekStart - THURSDAY;
+   return true;
+}
+
+bool SautoRecurrence::operator==(const SautoRecurrence &other) const
+{
+   if (m_frequency != other.m_frequency ||
+      m_interval != other.m_interval ||
+      m_start != other.m_start ||
+      m_until != other.m_until ||
+      m_weekAnchor != other.m_weekAnchor ||
+      m_months != other.m_months ||
+      m_monthDays != other.m_monthDays ||
+      m_lastMonthDays != other.m_lastMonthDays ||
+      m_weekdays != other.m_weekdays ||
+      m_setPositions != other.m_setPositions ||
+      m_exdates != other.m_exdates)
+   {
+      return false;
+   }
+   for (int i = 0; i < 5; i++)
+   {
+      if (m_nth[i] != other.m_nth[i] || m_lastNth[i] != other.m_lastNth[i])
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+bool SautoRecurrence::excluded(qint64 day) const
+{
+   return std::binary_search(m_exdates.constBegin(), m_exdates.constEnd(), day);
+}
+
+//  The days of the month that BYMONTH, BYMONTHDAY and BYDAY select, bit n is day n. When both
+//  BYMONTHDAY and BYDAY are given a day must be in both. The weekdays are laid out over the month
+//  from the weekday of the 1st
+quint32 SautoRecurrence::monthDays(int year, int month) const
+{
+   if (m_months != 0 && (m_months & (1 << month)) == 0)
+   {
+      return 0;
+   }
+
+   const int length = daysInMonth(year, month);
+   const quint32 valid = ((quint32(1) << length) - 1) << 1;
+   quint32 monthDays = m_monthDays & valid;
+   for (quint32 last = m_lastMonthDays; last != 0; last &= last - 1)
+   {
+      const int n = qCountTrailingZeroBits(last);
+      if (n <= length)
+      {
+         monthDays |= quint32(1) << (length + 1 - n);
+      }
+   }
+
+   const int first = dayOfWeekFromDays(daysFromCivil(year, month, 1));
+   const quint64 week = rotateWeek(m_weekdays, first);
+   const quint64 weeks = week | (week << 7) | (week << 14) | (week << 21) | (week << 28);
+   quint32 weekdays = static_cast<quint32>(weeks << 1) & valid;
+   quint8 ordinals = 0;
+   const int lastWeekday = (first - 1 + length - 1) % 7 + 1;
+   for (int n = 0; n < 5; n++)
+   {
+      ordinals |= m_nth[n] | m_lastNth[n];
+      for (quint32 bits = m_nth[n]; bits != 0; bits &= bits - 1)
+      {
+         const int weekday = qCountTrailingZeroBits(bits) + 1;
+         const int day = 1 + (weekday - first + 7) % 7 + 7 * n;
+         if (day <= length)
+         {
+            weekdays |= quint32(1) << day;
+         }
+      }
+      for (quint32 bits = m_lastNth[n]; bits != 0; bits &= bits - 1)
+      {
+         const int weekday = qCountTrailingZeroBits(bits) + 1;
+         const int day = length - (lastWeekday - weekday + 7) % 7 - 7 * n;
+         if (day >= 1)
+         {
+            weekdays |= quint32(1) << day;
+         }
+      }
+   }
+
+   const bool byMonthDay = m_monthDays != 0 || m_lastMonthDays != 0;
+   const bool byDay = m_weekdays != 0 || ordinals != 0;
+   if (byMonthDay && byDay)
+   {
+      return monthDays & weekdays;
+   }
+   if (byMonthDay)
+   {
+      return monthDays;
+   }
+   if (byDay)
+   {
+      return weekdays;
+   }
+   return valid;
+}
+
+//  The selected days of the month for the rules that are counted in days or months. A MONTHLY
+//  month that is not an INTERVAL from the start has none
+quint32 SautoRecurrence::monthSet(int year, int month) const
+{
+   quint32 days = monthDays(year, month);
+   if (days == 0)
+   {
+      return 0;
+   }
+
+   if (m_frequency == RECUR_MONTHLY)
+   {
+      const qint64 months = static_cast<qint64>(year - m_startDate.year) * 12 + month - m_startDate.month;
+      if (floorMod(months, m_interval) != 0)
+      {
+         return 0;
+      }
+      return selectPositions(days);
+   }
+
+   if (m_interval > 1)
+   {
+      // every INTERVAL day from the start
+      quint32 aligned = 0;
+      for (qint64 day = floorMod(m_start - daysFromCivil(year, month, 1), m_interval) + 1; day <= 31; day += m_interval)
+      {
+         aligned |= quint32(1) << day;
+      }
+      days &= aligned;
+   }
+   return days;
+}
+
+//  The selected days of each month of the year, BYSETPOS counts through the whole year
+void SautoRecurrence::yearSet(int year, quint32 days[13]) const
+{
+   days[0] = 0;
+   int total = 0;
+   for (int month = JANUARY; month <= DECEMBER; month++)
+   {
+      days[month] = monthDays(year, month);
+      total += qPopulationCount(days[month]);
+   }
+   if (m_setPositions.isEmpty())
+   {
+      return;
+   }
+
+   quint32 selected[13] = { 0 };
+   for (int i = 0; i < m_setPositions.size(); i++)
+   {
+      const int position = m_setPositions.at(i);
+      int index = position > 0 ? position - 1 : total + position;
+      if (index < 0 || index >= total)
+      {
+         continue;
+      }
+      for (int month = JANUARY; month <= DECEMBER; month++)
+      {
+         const int count = qPopulationCount(days[month]);
+         if (index < count)
+         {
+            selected[month] |= nthBit(days[month], index);
+            break;
+         }
+         index -= count;
+      }
+   }
+   for (int month = JANUARY; month <= DECEMBER; month++)
+   {
+      days[month] = selected[month];
+   }
+}
+
+//  The selected days of a week, bit n is day n from the start of the week
+quint32 SautoRecurrence::weekSet(qint64 week) const
+{
+   const qint64 first = m_weekAnchor + week * 7;
+   quint32 days = rotateWeek(m_weekdays, dayOfWeekFromDays(first));
+   if (m_months != 0)
+   {
+      for (quint32 bits = days; bits != 0; bits &= bits - 1)
+      {
+         const int day = qCountTrailingZeroBits(bits);
+         if ((m_months & (1 << civilFromDays(first + day).month)) == 0)
+         {
+            days &= ~(quint32(1) << day);
+         }
+      }
+   }
+   return selectPositions(days);
+}
+
+//  The days of the set at the BYSETPOS positions, from the start of the set when positive and
+//  from its end when negative
+quint32 SautoRecurrence::selectPositions(quint32 set) const
+{
+   if (m_setPositions.isEmpty() || set == 0)
+   {
+      return set;
+   }
+
+   const int count = qPopulationCount(set);
+   quint32 selected = 0;
+   for (int i = 0; i < m_setPositions.size(); i++)
+   {
+      const int position = m_setPositions.at(i);
+      const int index = position > 0 ? position - 1 : count + position;
+      if (index >= 0 && index < count)
+      {
+         selected |= nthBit(set, index);
+      }
+   }
+   return selected;
+}
+
+bool SautoRecurrence::contains(qint64 day) const
+{
+   if (!isValid() || day < m_start || day > m_until || excluded(day))
+   {
+      return false;
+   }
+
+   const SautoCivilDate date = civilFromDays(day);
+   switch (m_frequency)
+   {
+   case(RECUR_WEEKLY) :
+   {
+      const qint64 week = floorDiv(day - m_weekAnchor, 7);
+      if (floorMod(week - floorDiv(m_start - m_weekAnchor, 7), m_interval) != 0)
+      {
+         return false;
+      }
+      return (weekSet(week) & (quint32(1) << (day - m_weekAnchor - week * 7))) != 0;
+   }
+
+   case(RECUR_YEARLY) :
+   {
+      if (floorMod(date.year - m_startDate.year, m_interval) != 0)
+      {
+         return false;
+      }
+      quint32 days[13];
+      yearSet(date.year, days);
+      return (days[date.month] & (quint32(1) << date.day)) != 0;
+   }
+
+   case(RECUR_DAILY) :
+   case(RECUR_MONTHLY) :
+      return (monthSet(date.year, date.month) & (quint32(1) << date.day)) != 0;
+
+   case(RECUR_NONE) :
+   default:
+      return false;
+   }
+}
+
+//  The first selected day from the argument day and on, -1 if there is none. Periods that are not
+//  an INTERVAL from the start are jumped over, and a period is expanded into a bitset of its days
+//  that is searched with one bit scan, so a day that is far away is found as fast as one that is
+//  close. Each excluded date only makes the search go on once
+qint64 SautoRecurrence::next(qint64 day) const
+{
+   if (!isValid())
+   {
+      return -1;
+   }
+
+   day = qMax(day, m_start);
+   for (int i = 0; i <= m_exdates.size() && day <= m_until; i++)
+   {
+      qint64 found;
+      switch (m_frequency)
+      {
+      case(RECUR_WEEKLY) :
+         found = nextInWeeks(day);
+         break;
+
+      case(RECUR_YEARLY) :
+         found = nextInYears(day);
+         break;
+
+      default:
+         found = nextInMonths(day);
+         break;
+      }
+
+      if (found < 0 || found > m_until)
+      {
+         return -1;
+      }
+      if (!excluded(found))
+      {
+         return found;
+      }
+      day = found + 1;
+   }
+   return -1;
+}
+
+QDate SautoRecurrence::next(const QDate &date) const
+{
+   const qint64 day = next(daysFromDate(date));
+   return day < 0 ? QDate() : dateFromDays(day);
+}
+
+qint64 SautoRecurrence::nextInMonths(qint64 day) const
+{
+   const SautoCivilDate date = civilFromDays(day);
+   const qint64 startMonth = static_cast<qint64>(m_startDate.year) * 12 + m_startDate.month - 1;
+   qint64 month = static_cast<qint64>(date.year) * 12 + date.month - 1;
+   const qint64 lastMonth = month + 12 * RECURRENCE_SEARCH_YEARS;
+   const int step = m_frequency == RECUR_MONTHLY ? m_interval : 1;
+   int from = date.day;
+   while (month <= lastMonth)
+   {
+      const qint64 offset = floorMod(month - startMonth, step);
+      if (offset != 0)
+      {
+         month += step - offset;
+         from = 1;
+         continue;
+      }
+
+      const int year = static_cast<int>(floorDiv(month, 12));
+      const int monthNo = static_cast<int>(month - static_cast<qint64>(year) * 12) + 1;
+      const quint32 ahead = monthSet(year, monthNo) & (~quint32(0) << from);
+      if (ahead != 0)
+      {
+         return daysFromCivil(year, monthNo, qCountTrailingZeroBits(ahead));
+      }
+      month += step;
+      from = 1;
+   }
+   return -1;
+}
+
+qint64 SautoRecurrence::nextInYears(qint64 day) const
+{
+   const SautoCivilDate date = civilFromDays(day);
+   int year = date.year;
+   int month = date.month;
+   int from = date.day;
+   const int lastYear = year + RECURRENCE_SEARCH_YEARS;
+   while (year <= lastYear)
+   {
+      const int offset = static_cast<int>(floorMod(year - m_startDate.year, m_interval));
+      if (offset != 0)
+      {
+         year += m_interval - offset;
+         month = JANUARY;
+         from = 1;
+         continue;
+      }
+
+      quint32 days[13];
+      yearSet(year, days);
+      for (; month <= DECEMBER; month++, from = 1)
+      {
+         const quint32 ahead = days[month] & (~quint32(0) << from);
+         if (ahead != 0)
+         {
+            return daysFromCivil(year, month, qCountTrailingZeroBits(ahead));
+         }
+      }
+      year += m_interval;
+      month = JANUARY;
+      from = 1;
+   }
+   return -1;
+}
+
+qint64 SautoRecurrence::nextInWeeks(qint64 day) const
+{
+   const qint64 startWeek = floorDiv(m_start - m_weekAnchor, 7);
+   qint64 week = floorDiv(day - m_weekAnchor, 7);
+   const qint64 lastWeek = week + static_cast<qint64>(RECURRENCE_SEARCH_YEARS) * 53;
+   int from = static_cast<int>(day - m_weekAnchor - week * 7);
+   while (week <= lastWeek)
+   {
+      const qint64 offset = floorMod(week - startWeek, m_interval);
+      if (offset != 0)
+      {
+         week += m_interval - offset;
+         from = 0;
+         continue;
+      }
+
+      const quint32 ahead = weekSet(week) & (~quint32(0) << from);
+      if (ahead != 0)
+      {
+         return m_weekAnchor + week * 7 + qCountTrailingZeroBits(ahead);
+      }
+      week += m_interval;
+      from = 0;
+   }
+   return -1;
+}
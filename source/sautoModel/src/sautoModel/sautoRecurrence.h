@@ -0,0 +1,128 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoRecurrence.h
+//
+//  \brief     Definition of a recurrence rule that selects the days of a schedule
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _SAUTO_RECURRENCE_H
+#define _SAUTO_RECURRENCE_H
+
+// Qt includes
+#include <QDate>
+#include <QString>
+#include <QVector>
+
+// local includes
+#include "timeStuff.h"
+
+namespace sauto {
+
+   enum ERecurrenceFrequency
+   {
+      RECUR_NONE    ,
+      RECUR_DAILY   ,
+      RECUR_WEEKLY  ,
+      RECUR_MONTHLY ,
+      RECUR_YEARLY  ,
+   };
+
+   // the gregorian calendar repeats itself every 400 years, a rule that has no day by then never will
+   static const int RECURRENCE_SEARCH_YEARS = 400;
+
+   // The days of an iCalendar recurrence, given as the DTSTART, RRULE and EXDATE properties:
+   //
+   //    DTSTART:20261013
+   //    RRULE:FREQ=MONTHLY;BYDAY=TU;BYSETPOS=2
+   //    EXDATE:20261208
+   //
+   // The rule takes FREQ DAILY, WEEKLY, MONTHLY or YEARLY, INTERVAL, UNTIL, WKST, BYMONTH,
+   // BYMONTHDAY, BYDAY and BYSETPOS. Only the dates count, the time of the day comes from the
+   // intervals of the schedule. The rule is kept as bitsets and expanded one period at a time when
+   // it is asked, so it takes the same memory however far ahead it runs. An ordinal BYDAY counts in
+   // the month, so a YEARLY rule with one must have BYMONTH.
+   //
+   // Days are counted from 1970-01-01, like daysFromCivil()
+   class SautoRecurrence
+   {
+   public:
+      SautoRecurrence();
+      explicit SautoRecurrence(const QString &text);
+      bool parse(const QString &text, QString *error = 0);
+      void clear();
+      bool operator==(const SautoRecurrence &other) const;
+      inline bool operator!=(const SautoRecurrence &other) const { return !(*this == other); }
+
+      inline bool isValid() const { return m_frequency != RECUR_NONE; }
+      inline const QString& text() const { return m_text; }
+      inline ERecurrenceFrequency frequency() const { return m_frequency; }
+      inline int interval() const { return m_interval; }
+      inline qint64 start() const { return m_start; }
+      inline qint64 until() const { return m_until; }
+      bool contains(qint64 day) const;
+      inline bool contains(const QDate &date) const { return contains(daysFromDate(date)); }
+      qint64 next(qint64 day) const;
+      QDate next(const QDate &date) const;
+
+   private:
+      bool parseRule(const QString &rule, QString *error);
+      qint64 nextInMonths(qint64 day) const;
+      qint64 nextInYears(qint64 day) const;
+      qint64 nextInWeeks(qint64 day) const;
+      bool excluded(qint64 day) const;
+      quint32 monthDays(int year, int month) const;
+      quint32 monthSet(int year, int month) const;
+      void yearSet(int year, quint32 days[13]) const;
+      quint32 weekSet(qint64 week) const;
+      quint32 selectPositions(quint32 set) const;
+
+   private:
+      QString m_text;
+      ERecurrenceFrequency m_frequency;
+      int m_interval;
+      qint64 m_start;            //< the day of DTSTART
+      qint64 m_until;            //< the last day that may be selected
+      SautoCivilDate m_startDate;
+      qint64 m_weekAnchor;       //< a day that a week starts on, from WKST
+      quint16 m_months;          //< bit n is month n, 0 when any month will do
+      quint32 m_monthDays;       //< bit n is day n of the month
+      quint32 m_lastMonthDays;   //< bit n is the n-th last day of the month
+      quint8 m_weekdays;         //< bit n - 1 is weekday n, 1 is monday
+      quint8 m_nth[5];           //< weekdays of the 1st to 5th of their kind in the month
+      quint8 m_lastNth[5];       //< weekdays of the last to 5th last of their kind in the month
+      QVector<int> m_setPositions;
+      QVector<qint64> m_exdates; //< sorted
+   };
+}
+
+#endif
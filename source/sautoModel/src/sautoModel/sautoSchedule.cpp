@@ -0,0 +1,355 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoSchedule.cpp
+//
+//  \brief     Implementation of a compiled, flat representation of a schedule
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// std includes
+#include <algorithm>
+
+// Qt includes
+#include <QtAlgorithms>
+
+// local includes
+#include "sautoSchedule.h"
+
+using namespace sauto;
+
+SautoSchedule::SautoSchedule()
+   :m_hasWeek(false),
+   m_weekMask(0)
+{
+   clear();
+}
+
+void SautoSchedule::clear()
+{
+   m_frequency.reset();
+   m_models.clear();
+   m_lists.clear();
+   m_days.clear();
+   m_years.clear();
+   m_recurrence.clear();
+   m_hasWeek = false;
+   m_weekMask = 0;
+   for (int i = 0; i < 8; i++)
+   {
+      m_weekList[i] = SCHEDULE_DEFAULT_LIST;
+   }
+
+   // the default list must always exist, it is what the other levels inherit
+   m_lists.append(SautoScheduleList());
+}
+
+void SautoSchedule::compile(const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar)
+{
+   m_frequency = def_frequency;
+   m_models.clear();
+   m_lists.clear();
+   m_days.clear();
+   m_years.clear();
+   m_recurrence.clear();
+
+   // INTERVAL, the level that the week and calendar inherit
+   addList(def_intervals);
+
+   // WEEK, days that are toggled off are left out of the mask, and fall back to the default list
+   // when a calendar date inherits them
+   m_hasWeek = def_week.size() > 0;
+   m_weekMask = 0;
+   for (int i = 0; i < 8; i++)
+   {
+      m_weekList[i] = SCHEDULE_DEFAULT_LIST;
+   }
+   WEEK_ITERATOR week_it(def_week);
+   while (week_it.hasNext())
+   {
+      week_it.next();
+      const int dayOfWeek = week_it.key();
+      const DAY_OF_WEEK_DEF &day = week_it.value();
+      if (dayOfWeek < MONDAY || dayOfWeek > SUNDAY || !dayIsToggled(day))
+      {
+         continue;
+      }
+      m_weekMask |= 1 << (dayOfWeek - 1);
+      if (!dayInheritsTime(day) && day.second.size() > 0)
+      {
+         m_weekList[dayOfWeek] = addList(day.second);
+      }
+   }
+
+   // CALENDAR, the map is sorted so the years end up in ascending order
+   m_years.reserve(def_calendar.size());
+   CALENDAR_ITERATOR cal_it(def_calendar);
+   while (cal_it.hasNext())
+   {
+      cal_it.next();
+      SautoScheduleYear year;
+      year.year = cal_it.key();
+
+      MONTH_ITERATOR month_it(cal_it.value().second);
+      while (month_it.hasNext())
+      {
+         month_it.next();
+         const int monthNo = getMonthAsInt(month_it.key());
+         if (monthNo < JANUARY || monthNo > DECEMBER)
+         {
+            continue;
+         }
+         year.months |= 1 << monthNo;
+
+         SautoScheduleMonth &month = year.month[monthNo];
+         month.inherit = month_it.value().first;
+         month.firstDay = m_days.size();
+
+         // the days are keyed on yyyymmdd, the first key of a day number is the one that is used
+         SautoScheduleDay days[32];
+         QMapIterator<int, CALENDAR_DATE> days_it(month_it.value().second);
+         while (days_it.hasNext())
+         {
+            days_it.next();
+            const int dayNo = days_it.key() % 100;
+            if (dayNo < 0 || dayNo > 31 || (month.days & (quint32(1) << dayNo)))
+            {
+               continue;
+            }
+            month.days |= quint32(1) << dayNo;
+            days[dayNo].date = calendarDate_QDate(days_it.value());
+            if (days_it.value().second.size() > 0)
+            {
+               days[dayNo].list = addList(days_it.value().second);
+            }
+         }
+         for (int i = 0; i < 32; i++)
+         {
+            if (month.days & (quint32(1) << i))
+            {
+               m_days.append(days[i]);
+            }
+         }
+      }
+      m_years.append(year);
+   }
+}
+
+int SautoSchedule::addList(const INTERVAL_LIST &intervals)
+{
+   SautoScheduleList list;
+   list.begin = m_models.size();
+   list.inherit = intervals.size() == 0;
+
+   INTERVAL_ITERATOR it(intervals);
+   while (it.hasNext())
+   {
+      SautoModel intervalDef = it.next();
+      if (!intervalDef.isValid())
+      {
+         intervalDef.updateHasCustomInterval();
+         if (!intervalDef.getHasCustomInterval() || !m_frequency.isValid())
+         {
+            continue;
+         }
+
+         // combine the interval with the default frequency
+         SautoModel combined = m_frequency;
+         combined.setStartTimeMSecs(intervalDef.getStartTimeMSec());
+         combined.setDuration(intervalDef.getDuration());
+         combined.updateHasCustomInterval();
+         intervalDef = combined;
+      }
+      m_models.append(intervalDef);
+      list.count++;
+   }
+
+   m_lists.append(list);
+   return m_lists.size() - 1;
+}
+
+//  Schedules are equal when they compile to the same lists, models and days, whatever the
+//  definitions looked like
+bool SautoSchedule::operator==(const SautoSchedule &other) const
+{
+   if (m_frequency != other.m_frequency ||
+      m_models != other.m_models ||
+      m_lists.size() != other.m_lists.size() ||
+      m_days.size() != other.m_days.size() ||
+      m_years.size() != other.m_years.size() ||
+      m_recurrence != other.m_recurrence ||
+      m_hasWeek != other.m_hasWeek ||
+      m_weekMask != other.m_weekMask)
+   {
+      return false;
+   }
+
+   for (int i = 0; i < 8; i++)
+   {
+      if (m_weekList[i] != other.m_weekList[i])
+      {
+         return false;
+      }
+   }
+
+   for (int i = 0; i < m_lists.size(); i++)
+   {
+      const SautoScheduleList &list = m_lists.at(i);
+      const SautoScheduleList &otherList = other.m_lists.at(i);
+      if (list.begin != otherList.begin || list.count != otherList.count || list.inherit != otherList.inherit)
+      {
+         return false;
+      }
+   }
+
+   for (int i = 0; i < m_days.size(); i++)
+   {
+      if (m_days.at(i).date != other.m_days.at(i).date || m_days.at(i).list != other.m_days.at(i).list)
+      {
+         return false;
+      }
+   }
+
+   for (int i = 0; i < m_years.size(); i++)
+   {
+      const SautoScheduleYear &year = m_years.at(i);
+      const SautoScheduleYear &otherYear = other.m_years.at(i);
+      if (year.year != otherYear.year || year.months != otherYear.months)
+      {
+         return false;
+      }
+      for (int j = JANUARY; j <= DECEMBER; j++)
+      {
+         const SautoScheduleMonth &month = year.month[j];
+         const SautoScheduleMonth &otherMonth = otherYear.month[j];
+         if (month.inherit != otherMonth.inherit || month.days != otherMonth.days || month.firstDay != otherMonth.firstDay)
+         {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+static bool yearLessThan(const SautoScheduleYear &year, int value)
+{
+   return year.year < value;
+}
+
+int SautoSchedule::yearIndex(int year) const
+{
+   return std::lower_bound(m_years.constBegin(), m_years.constEnd(), year, yearLessThan) - m_years.constBegin();
+}
+
+int SautoSchedule::firstMonth(const SautoScheduleYear &year) const
+{
+   if (year.months == 0)
+   {
+      return 0;
+   }
+   return qCountTrailingZeroBits(static_cast<quint32>(year.months));
+}
+
+//  Number of days from the argument weekday until a weekday that is enabled in the week definition,
+//  0 when the weekday itself is enabled and -1 when none are
+int SautoSchedule::daysToEnabledWeekday(int dayOfWeek) const
+{
+   if (m_weekMask == 0)
+   {
+      return -1;
+   }
+   const quint32 twoWeeks = m_weekMask | (static_cast<quint32>(m_weekMask) << 7);
+   return qCountTrailingZeroBits(twoWeeks >> (dayOfWeek - 1));
+}
+
+//  The first selected day of the month that is on or after the argument day, 0 if there are none
+const SautoScheduleDay* SautoSchedule::nextDay(const SautoScheduleMonth &month, int day) const
+{
+   if (day < 0 || day > 31)
+   {
+      return 0;
+   }
+   const quint32 ahead = month.days & ~((quint32(1) << day) - 1);
+   if (ahead == 0)
+   {
+      return 0;
+   }
+   const quint32 found = qCountTrailingZeroBits(ahead);
+   return m_days.constData() + month.firstDay + qPopulationCount(month.days & ((quint32(1) << found) - 1));
+}
+
+//  The list of intervals that applies to the argument date, -1 if the schedule has no sessions that day
+int SautoSchedule::dayList(const QDate &date) const
+{
+   if (hasRecurrence())
+   {
+      // the days of the rule use the intervals of their weekday, like a selected calendar date
+      return m_recurrence.contains(date) ? weekdayList(date.dayOfWeek()) : -1;
+   }
+
+   if (hasCalendar())
+   {
+      // only the years of the calendar have sessions
+      const int index = yearIndex(date.year());
+      if (index >= m_years.size() || m_years.at(index).year != date.year())
+      {
+         return -1;
+      }
+
+      // a year without months, or a month without days, inherits the week
+      const SautoScheduleYear &year = m_years.at(index);
+      if (year.months != 0)
+      {
+         if ((year.months & (1 << date.month())) == 0)
+         {
+            return -1;
+         }
+
+         const SautoScheduleMonth &month = year.month[date.month()];
+         if (!month.inherit && month.days != 0)
+         {
+            if ((month.days & (quint32(1) << date.day())) == 0)
+            {
+               return -1;
+            }
+
+            // a selected date without intervals of its own uses the intervals of its weekday
+            const SautoScheduleDay *day = nextDay(month, date.day());
+            return day->list >= 0 ? day->list : weekdayList(date.dayOfWeek());
+         }
+      }
+   }
+
+   if (!hasWeek())
+   {
+      return SCHEDULE_DEFAULT_LIST;
+   }
+   return weekdayEnabled(date.dayOfWeek()) ? weekdayList(date.dayOfWeek()) : -1;
+}
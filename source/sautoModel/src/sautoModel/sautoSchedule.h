@@ -0,0 +1,134 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoSchedule.h
+//
+//  \brief     Definition of a compiled, flat representation of a schedule
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_SCHEDULE_H
+#define _SAUTO_SCHEDULE_H
+
+// Qt includes
+#include <QVector>
+#include <QDate>
+
+// local includes
+#include "sautoDefs.h"
+#include "sautoRecurrence.h"
+
+namespace sauto {
+
+   // the default intervals are always compiled first
+   static const int SCHEDULE_DEFAULT_LIST = 0;
+
+   // a list of interval models, stored contiguously in the schedule
+   struct SautoScheduleList
+   {
+      SautoScheduleList() : begin(0), count(0), inherit(true) {}
+      int begin;
+      int count;
+      bool inherit; //< the list was empty in the definition, the default frequency applies
+   };
+
+   // a selected calendar date
+   struct SautoScheduleDay
+   {
+      SautoScheduleDay() : list(-1) {}
+      QDate date;
+      int list; //< -1 when the date inherits from the week definition
+   };
+
+   struct SautoScheduleMonth
+   {
+      SautoScheduleMonth() : inherit(false), days(0), firstDay(0) {}
+      bool inherit;  //< the month uses the week definition
+      quint32 days;  //< bit n is set when day n of the month is selected
+      int firstDay;  //< index of the lowest selected day in the day array
+   };
+
+   struct SautoScheduleYear
+   {
+      SautoScheduleYear() : year(0), months(0) {}
+      int year;
+      quint16 months; //< bit n is set when month n is defined
+      SautoScheduleMonth month[13];
+   };
+
+   // The calendar, week, interval and frequency definitions of a clock with the inheritance
+   // rules already resolved. Interval models of all the levels live in one array, and the
+   // definitions refer to them by list index, so no containers are copied to find a session.
+   // A recurrence rule may take the place of the calendar, then the days that it selects use the
+   // intervals of their weekday
+   class SautoSchedule
+   {
+   public:
+      SautoSchedule();
+      void clear();
+      void compile(const SautoModel &def_frequency, const INTERVAL_LIST &def_intervals, const WEEK_DEF &def_week, const CALENDAR_DEF &def_calendar);
+      inline void setRecurrence(const SautoRecurrence &recurrence) { m_recurrence = recurrence; }
+      bool operator==(const SautoSchedule &other) const;
+      inline bool operator!=(const SautoSchedule &other) const { return !(*this == other); }
+
+      inline bool hasCalendar()  const { return !m_years.isEmpty(); }
+      inline bool hasRecurrence() const { return m_recurrence.isValid(); }
+      inline bool hasWeek()      const { return m_hasWeek; }
+      inline bool hasIntervals() const { return !m_lists.at(SCHEDULE_DEFAULT_LIST).inherit; }
+      inline const SautoModel& frequency() const { return m_frequency; }
+      inline const SautoRecurrence& recurrence() const { return m_recurrence; }
+      inline const SautoScheduleList& list(int index) const { return m_lists.at(index); }
+      inline const SautoModel* models(const SautoScheduleList &list) const { return m_models.constData() + list.begin; }
+      inline const QVector<SautoScheduleYear>& years() const { return m_years; }
+      inline int weekdayList(int dayOfWeek) const { return m_weekList[dayOfWeek]; }
+      inline bool weekdayEnabled(int dayOfWeek) const { return (m_weekMask & (1 << (dayOfWeek - 1))) != 0; }
+      int yearIndex(int year) const;
+      int dayList(const QDate &date) const;
+      int firstMonth(const SautoScheduleYear &year) const;
+      int daysToEnabledWeekday(int dayOfWeek) const;
+      const SautoScheduleDay* nextDay(const SautoScheduleMonth &month, int day) const;
+
+   private:
+      int addList(const INTERVAL_LIST &intervals);
+
+   private:
+      SautoModel m_frequency;
+      QVector<SautoModel> m_models;
+      QVector<SautoScheduleList> m_lists;
+      QVector<SautoScheduleDay> m_days;
+      QVector<SautoScheduleYear> m_years;
+      SautoRecurrence m_recurrence; //< selects the days in place of the calendar
+      bool m_hasWeek;
+      quint8 m_weekMask;   //< bit n - 1 is set when weekday n is enabled
+      int m_weekList[8];   //< list of each weekday, 1 is monday
+   };
+}
+
+#endif
@@ -0,0 +1,113 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoTasks.cpp
+//
+//  \brief     Implementation of the process wide table of task names
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// Qt includes
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+// local includes
+#include "sautoTasks.h"
+
+using namespace sauto;
+
+namespace {
+   struct TaskTable
+   {
+      TaskTable()
+      {
+         names.append(QString());
+         ids.insert(QString(), SAUTO_NO_TASK);
+      }
+      QReadWriteLock lock;
+      QHash<QString, SautoTaskId> ids;
+      QVector<QString> names;
+   };
+}
+
+Q_GLOBAL_STATIC(TaskTable, s_tasks)
+
+//  The id of the argument name, which is added to the table the first time it is seen
+SautoTaskId SautoTasks::intern(const QString &name)
+{
+   if (name.isEmpty())
+   {
+      return SAUTO_NO_TASK;
+   }
+
+   TaskTable *tasks = s_tasks();
+   {
+      QReadLocker lock(&tasks->lock);
+      QHash<QString, SautoTaskId>::const_iterator it = tasks->ids.constFind(name);
+      if (it != tasks->ids.constEnd())
+      {
+         return it.value();
+      }
+   }
+
+   // another thread may have added it between the locks
+   QWriteLocker lock(&tasks->lock);
+   QHash<QString, SautoTaskId>::const_iterator it = tasks->ids.constFind(name);
+   if (it != tasks->ids.constEnd())
+   {
+      return it.value();
+   }
+   const SautoTaskId id = static_cast<SautoTaskId>(tasks->names.size());
+   tasks->names.append(name);
+   tasks->ids.insert(name, id);
+   return id;
+}
+
+//  The name of the argument id, empty for an id that was never handed out. The string is shared
+//  with the table, so nothing is allocated
+QString SautoTasks::name(SautoTaskId id)
+{
+   if (id == SAUTO_NO_TASK)
+   {
+      return QString();
+   }
+
+   TaskTable *tasks = s_tasks();
+   QReadLocker lock(&tasks->lock);
+   return id < static_cast<SautoTaskId>(tasks->names.size()) ? tasks->names.at(static_cast<int>(id)) : QString();
+}
+
+int SautoTasks::count()
+{
+   TaskTable *tasks = s_tasks();
+   QReadLocker lock(&tasks->lock);
+   return tasks->names.size();
+}
@@ -0,0 +1,60 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoTasks.h
+//
+//  \brief     Definition of the process wide table of task names
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_TASKS_H
+#define _SAUTO_TASKS_H
+
+// Qt includes
+#include <QString>
+
+namespace sauto {
+
+   typedef quint32 SautoTaskId;
+   static const SautoTaskId SAUTO_NO_TASK = 0; //< the id of the empty name
+
+   // Task names are kept once for the whole process, and models refer to them by id so that
+   // copying a model or firing a trigger doesn't copy or compare any string. Ids are handed out
+   // in order and never reused, a name is only looked up where it leaves the clocks
+   class SautoTasks
+   {
+   public:
+      static SautoTaskId intern(const QString &name);
+      static QString name(SautoTaskId id);
+      static int count();
+   };
+}
+
+#endif
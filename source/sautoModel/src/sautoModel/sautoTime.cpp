@@ -0,0 +1,150 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoTime.cpp
+//
+//  \brief     Implementation of the time sources that the clocks read the time from
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// local includes
+#include "sautoTime.h"
+
+using namespace sauto;
+
+QDateTime SautoTimeSource::currentDateTime() const
+{
+   return QDateTime::fromMSecsSinceEpoch(currentMSecsSinceEpoch());
+}
+
+QDate SautoTimeSource::currentDate() const
+{
+   return currentDateTime().date();
+}
+
+SautoSystemTime::SautoSystemTime()
+{
+   m_monotonic.start();
+}
+
+qint64 SautoSystemTime::currentMSecsSinceEpoch() const
+{
+   return QDateTime::currentMSecsSinceEpoch();
+}
+
+qint64 SautoSystemTime::elapsed() const
+{
+   return m_monotonic.elapsed();
+}
+
+SautoVirtualTime::SautoVirtualTime(qint64 startMSecsSinceEpoch)
+   :m_wallAtStart(startMSecsSinceEpoch),
+   m_elapsed(0)
+{
+
+}
+
+qint64 SautoVirtualTime::currentMSecsSinceEpoch() const
+{
+   return m_wallAtStart + m_elapsed;
+}
+
+void SautoVirtualTime::advance(qint64 msecs)
+{
+   m_elapsed += qMax<qint64>(0, msecs);
+}
+
+//  Moves the wall clock without the monotonic clock, the way an NTP step or a manual change of the
+//  system time does
+void SautoVirtualTime::stepWallClock(qint64 msecs)
+{
+   m_wallAtStart += msecs;
+}
+
+//  The time of the day on the wall clock to msecs since epoch. A time that the clock skips when it
+//  is set forward is moved to the transition, a time that is repeated when it is set back is the
+//  first one
+qint64 SautoDayContext::toEpoch(qint64 msecsOfDay) const
+{
+   const qint64 msecs = midnight + msecsOfDay;
+   if (msecs < transition)
+   {
+      return msecs;
+   }
+   return qMax(transition, msecs - offsetChange());
+}
+
+qint64 SautoDayContext::msecsOfDay(qint64 msecs) const
+{
+   return msecs - midnight + (msecs < transition ? 0 : offsetChange());
+}
+
+//  The local day of the argument time. The offset changes at most once a day, and when it does the
+//  change is found by halving the day down to the minute
+SautoDayContext sauto::localDayContext(qint64 msecsSinceEpoch)
+{
+   SautoDayContext day;
+   day.date = QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch).date();
+   const QDateTime midnight(day.date, QTime(0, 0, 0, 0));
+   const QDateTime nextMidnight(day.date.addDays(1), QTime(0, 0, 0, 0));
+   day.midnight = midnight.toMSecsSinceEpoch();
+   day.nextMidnight = nextMidnight.toMSecsSinceEpoch();
+   day.transition = day.nextMidnight;
+   day.utcOffset = midnight.offsetFromUtc();
+   day.offsetAfter = nextMidnight.offsetFromUtc();
+   if (day.offsetAfter == day.utcOffset)
+   {
+      return day;
+   }
+
+   static const qint64 msecsPerMinute = 60 * 1000;
+   qint64 before = 0;
+   qint64 after = (day.nextMidnight - day.midnight) / msecsPerMinute;
+   while (after - before > 1)
+   {
+      const qint64 middle = (before + after) / 2;
+      if (QDateTime::fromMSecsSinceEpoch(day.midnight + middle * msecsPerMinute).offsetFromUtc() == day.utcOffset)
+      {
+         before = middle;
+      }
+      else
+      {
+         after = middle;
+      }
+   }
+   day.transition = day.midnight + after * msecsPerMinute;
+   return day;
+}
+
+const SautoTimeSource& sauto::systemTime()
+{
+   static SautoSystemTime time;
+   return time;
+}
@@ -0,0 +1,115 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoTime.h
+//
+//  \brief     Definition of the time sources that the clocks read the time from
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_TIME_H
+#define _SAUTO_TIME_H
+
+// Qt includes
+#include <QDateTime>
+#include <QElapsedTimer>
+
+namespace sauto {
+
+   // The local day that a time falls in. Converting between local time and epoch time is the
+   // expensive part of placing a session, so it is done once for the day, and the times of the day
+   // are converted with plain arithmetic. A day that changes its UTC offset has the time of the
+   // change, so that DST days are 23 or 25 hours long, and the wall clock times after the change
+   // are still placed right
+   struct SautoDayContext
+   {
+      SautoDayContext() : midnight(0), nextMidnight(0), transition(0), utcOffset(0), offsetAfter(0) {}
+      inline bool contains(qint64 msecs) const { return msecs >= midnight && msecs < nextMidnight; }
+      inline qint64 msecsToTomorrow(qint64 msecs) const { return nextMidnight - msecs; }
+      inline qint64 offsetChange() const { return static_cast<qint64>(offsetAfter - utcOffset) * 1000; }
+      qint64 toEpoch(qint64 msecsOfDay) const;
+      qint64 msecsOfDay(qint64 msecs) const;
+
+      QDate date;
+      qint64 midnight;      //< msecs since epoch
+      qint64 nextMidnight;  //< msecs since epoch of the midnight that ends the day
+      qint64 transition;    //< msecs since epoch when the UTC offset changes, nextMidnight if it doesn't
+      int utcOffset;        //< seconds, at midnight
+      int offsetAfter;      //< seconds, from the transition
+   };
+
+   SautoDayContext localDayContext(qint64 msecsSinceEpoch);
+
+   // Where the clocks, the models and the time helpers read the time from. The wall clock is
+   // used to place sessions in the calendar, the monotonic clock to count down to them
+   class SautoTimeSource
+   {
+   public:
+      virtual ~SautoTimeSource() {}
+      virtual qint64 currentMSecsSinceEpoch() const = 0;
+      virtual qint64 elapsed() const = 0;
+      virtual bool isVirtual() const = 0;
+      QDateTime currentDateTime() const;
+      QDate currentDate() const;
+   };
+
+   // the time of the host
+   class SautoSystemTime : public SautoTimeSource
+   {
+   public:
+      SautoSystemTime();
+      qint64 currentMSecsSinceEpoch() const;
+      qint64 elapsed() const;
+      inline bool isVirtual() const { return false; }
+
+   private:
+      QElapsedTimer m_monotonic;
+   };
+
+   // a time that only moves when it is told to, for running schedules faster than real time
+   class SautoVirtualTime : public SautoTimeSource
+   {
+   public:
+      explicit SautoVirtualTime(qint64 startMSecsSinceEpoch = 0);
+      qint64 currentMSecsSinceEpoch() const;
+      inline qint64 elapsed() const { return m_elapsed; }
+      inline bool isVirtual() const { return true; }
+      void advance(qint64 msecs);
+      void stepWallClock(qint64 msecs);
+
+   private:
+      qint64 m_wallAtStart;
+      qint64 m_elapsed;
+   };
+
+   const SautoTimeSource& systemTime();
+}
+
+#endif
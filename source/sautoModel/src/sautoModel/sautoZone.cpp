@@ -0,0 +1,246 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoZone.cpp
+//
+//  \brief     Implementation of a time zone with precomputed UTC offsets
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// std includes
+#include <algorithm>
+
+// Qt includes
+#include <QHash>
+#include <QMutex>
+
+// local includes
+#include "sautoZone.h"
+
+using namespace sauto;
+
+namespace {
+   struct ZoneCache
+   {
+      QMutex mutex;
+      QHash<QByteArray, SautoZone> zones;
+   };
+
+   bool transitionBefore(qint64 msecs, const SautoZoneTransition &transition)
+   {
+      return msecs < transition.atUtc;
+   }
+}
+
+Q_GLOBAL_STATIC(ZoneCache, s_zones)
+
+SautoZone::SautoZone()
+   :m_from(0),
+   m_until(0),
+   m_firstOffset(0)
+{
+
+}
+
+//  The offsets of the zone from one time until another. An id that QTimeZone doesn't know makes a
+//  zone that is not valid
+SautoZone::SautoZone(const QByteArray &ianaId, qint64 fromMSecsSinceEpoch, qint64 untilMSecsSinceEpoch)
+   :m_id(ianaId),
+   m_zone(ianaId),
+   m_from(fromMSecsSinceEpoch),
+   m_until(untilMSecsSinceEpoch),
+   m_firstOffset(0)
+{
+   if (!m_zone.isValid())
+   {
+      return;
+   }
+
+   const QDateTime from = QDateTime::fromMSecsSinceEpoch(m_from, Qt::UTC);
+   m_firstOffset = m_zone.offsetFromUtc(from);
+   if (!m_zone.hasTransitions())
+   {
+      return;
+   }
+
+   const QTimeZone::OffsetDataList transitions = m_zone.transitions(from, QDateTime::fromMSecsSinceEpoch(m_until, Qt::UTC));
+   m_transitions.reserve(transitions.size());
+   for (int i = 0; i < transitions.size(); i++)
+   {
+      SautoZoneTransition transition;
+      transition.atUtc = transitions.at(i).atUtc.toMSecsSinceEpoch();
+      transition.offset = transitions.at(i).offsetFromUtc;
+      m_transitions.append(transition);
+   }
+}
+
+//  The zone of the argument id, shared by every clock in it. The table covers the year behind and
+//  the horizon ahead, and is made again when the time has moved too close to its end
+SautoZone SautoZone::find(const QByteArray &ianaId)
+{
+   if (ianaId.isEmpty())
+   {
+      return SautoZone();
+   }
+
+   const qint64 now = QDateTime::currentMSecsSinceEpoch();
+   static const qint64 msecsPerYear = static_cast<qint64>(msecsPer_Day) * 366;
+   ZoneCache *cache = s_zones();
+   QMutexLocker lock(&cache->mutex);
+   QHash<QByteArray, SautoZone>::const_iterator it = cache->zones.constFind(ianaId);
+   if (it != cache->zones.constEnd() && it.value().until() > now + msecsPerYear)
+   {
+      return it.value();
+   }
+
+   const SautoZone zone(ianaId, now - msecsPerYear, now + ZONE_HORIZON_YEARS * msecsPerYear);
+   if (zone.isValid())
+   {
+      cache->zones.insert(ianaId, zone);
+   }
+   return zone;
+}
+
+//  Seconds from UTC at the argument time
+int SautoZone::offsetAt(qint64 msecsSinceEpoch) const
+{
+   if (isLocal())
+   {
+      return QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch).offsetFromUtc();
+   }
+   if (msecsSinceEpoch < m_from || msecsSinceEpoch >= m_until)
+   {
+      return m_zone.offsetFromUtc(QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch, Qt::UTC));
+   }
+
+   const SautoZoneTransition *next = std::upper_bound(m_transitions.constBegin(), m_transitions.constEnd(), msecsSinceEpoch, transitionBefore);
+   return next == m_transitions.constBegin() ? m_firstOffset : (next - 1)->offset;
+}
+
+//  The first transition after the argument time, 0 if there is none in the table
+const SautoZoneTransition* SautoZone::nextTransition(qint64 msecsSinceEpoch) const
+{
+   const SautoZoneTransition *next = std::upper_bound(m_transitions.constBegin(), m_transitions.constEnd(), msecsSinceEpoch, transitionBefore);
+   return next == m_transitions.constEnd() ? 0 : next;
+}
+
+//  A time of the zone, counted in msecs from 1970-01-01 00:00 of the zone, to msecs since epoch. The
+//  offsets a day before and after the time cover any transition that it is close to. A time that is
+//  skipped when the clocks are set forward is moved to the transition, and of a time that is repeated
+//  when they are set back the first one is used
+qint64 SautoZone::toUtc(qint64 localMSecs) const
+{
+   const int offsetBefore = offsetAt(localMSecs - msecsPer_Day);
+   const int offsetAfter = offsetAt(localMSecs + msecsPer_Day);
+   const qint64 before = localMSecs - static_cast<qint64>(offsetBefore) * 1000;
+   const qint64 after = localMSecs - static_cast<qint64>(offsetAfter) * 1000;
+   const bool beforeValid = offsetAt(before) == offsetBefore;
+   const bool afterValid = offsetAt(after) == offsetAfter;
+   if (beforeValid && afterValid)
+   {
+      return qMin(before, after);
+   }
+   if (beforeValid)
+   {
+      return before;
+   }
+   if (afterValid)
+   {
+      return after;
+   }
+
+   // in the gap, the transition is between the two
+   if (!isLocal() && after >= m_from && after < m_until)
+   {
+      const SautoZoneTransition *transition = nextTransition(after);
+      if (transition != 0)
+      {
+         return transition->atUtc;
+      }
+   }
+   return qMax(before, after);
+}
+
+QDate SautoZone::dateAt(qint64 msecsSinceEpoch) const
+{
+   if (isLocal())
+   {
+      return QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch).date();
+   }
+   const SautoCivilDate civil = civilFromDays(floorDiv(msecsSinceEpoch + static_cast<qint64>(offsetAt(msecsSinceEpoch)) * 1000, msecsPer_Day));
+   return QDate(civil.year, civil.month, civil.day);
+}
+
+//  The day of the zone that the argument time falls in, from the table without any QTimeZone query
+SautoDayContext SautoZone::dayContext(qint64 msecsSinceEpoch) const
+{
+   if (isLocal())
+   {
+      return localDayContext(msecsSinceEpoch);
+   }
+
+   const qint64 dayNumber = floorDiv(msecsSinceEpoch + static_cast<qint64>(offsetAt(msecsSinceEpoch)) * 1000, msecsPer_Day);
+   const SautoCivilDate civil = civilFromDays(dayNumber);
+   SautoDayContext day;
+   day.date = QDate(civil.year, civil.month, civil.day);
+   day.midnight = toUtc(dayNumber * msecsPer_Day);
+   day.nextMidnight = toUtc((dayNumber + 1) * msecsPer_Day);
+   day.transition = day.nextMidnight;
+   day.utcOffset = offsetAt(day.midnight);
+   day.offsetAfter = offsetAt(day.nextMidnight);
+   if (day.offsetAfter == day.utcOffset)
+   {
+      return day;
+   }
+
+   if (day.midnight >= m_from && day.midnight < m_until)
+   {
+      const SautoZoneTransition *transition = nextTransition(day.midnight);
+      if (transition != 0 && transition->atUtc < day.nextMidnight)
+      {
+         day.transition = transition->atUtc;
+      }
+   }
+   else
+   {
+      const QTimeZone::OffsetData transition = m_zone.nextTransition(QDateTime::fromMSecsSinceEpoch(day.midnight, Qt::UTC));
+      if (transition.atUtc.isValid() && transition.atUtc.toMSecsSinceEpoch() < day.nextMidnight)
+      {
+         day.transition = transition.atUtc.toMSecsSinceEpoch();
+      }
+   }
+   return day;
+}
+
+//  The argument date in the zone. Noon is never skipped by a transition, unlike midnight can be
+SautoDayContext SautoZone::dayContext(const QDate &date) const
+{
+   return dayContext(toUtc(daysFromDate(date) * msecsPer_Day + msecsPer_Day / 2));
+}
@@ -0,0 +1,97 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoZone.h
+//
+//  \brief     Definition of a time zone with precomputed UTC offsets
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_ZONE_H
+#define _SAUTO_ZONE_H
+
+// Qt includes
+#include <QByteArray>
+#include <QTimeZone>
+#include <QVector>
+
+// local includes
+#include "timeStuff.h"
+
+namespace sauto {
+
+   // how far ahead the offsets of a zone are calculated, times outside of it ask QTimeZone
+   static const int ZONE_HORIZON_YEARS = YEARS_IN_CALENDAR;
+
+   struct SautoZoneTransition
+   {
+      qint64 atUtc;  //< msecs since epoch
+      int offset;    //< seconds from UTC, from this time on
+   };
+
+   // A time zone that the sessions of a clock are placed in. The UTC offsets of the zone over a
+   // planning horizon are calculated once into a table sorted on time, so converting between the
+   // time of the zone and UTC is a binary search in the table, instead of a QTimeZone query. A zone
+   // without an id is the local time of the host. Copies share the table
+   class SautoZone
+   {
+   public:
+      SautoZone();
+      explicit SautoZone(const QByteArray &ianaId, qint64 fromMSecsSinceEpoch, qint64 untilMSecsSinceEpoch);
+      static SautoZone find(const QByteArray &ianaId);
+
+      inline bool isLocal() const { return m_id.isEmpty(); }
+      inline bool isValid() const { return isLocal() || m_zone.isValid(); }
+      inline const QByteArray& id() const { return m_id; }
+      inline qint64 from() const { return m_from; }
+      inline qint64 until() const { return m_until; }
+      inline const QVector<SautoZoneTransition>& transitions() const { return m_transitions; }
+      int offsetAt(qint64 msecsSinceEpoch) const;
+      qint64 toUtc(qint64 localMSecs) const;
+      QDate dateAt(qint64 msecsSinceEpoch) const;
+      SautoDayContext dayContext(qint64 msecsSinceEpoch) const;
+      SautoDayContext dayContext(const QDate &date) const;
+
+   private:
+      const SautoZoneTransition* nextTransition(qint64 msecsSinceEpoch) const;
+
+   private:
+      QByteArray m_id;
+      QTimeZone m_zone;
+      qint64 m_from;
+      qint64 m_until;
+      int m_firstOffset; //< the offset before the first transition
+      QVector<SautoZoneTransition> m_transitions;
+   };
+}
+
+Q_DECLARE_TYPEINFO(sauto::SautoZoneTransition, Q_PRIMITIVE_TYPE);
+
+#endif
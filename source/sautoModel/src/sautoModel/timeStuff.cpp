@@ -99,68 +99,41 @@ bool sauto::dateIsValid(const QDate &date)
    return true;
 }
 
-qint64 sauto::msecsToTomorrow()
+//  The time is read once, so that the midnight and the current time can't be on either side of a tick
+qint64 sauto::msecsToTomorrow(const SautoTimeSource &time)
 {
-   QDateTime tomorrow(QDateTime::currentDateTime().addDays(1).date(), QTime(0,0,0,0));
-   return tomorrow.toMSecsSinceEpoch() - QDateTime::currentMSecsSinceEpoch();
+   const QDateTime now = time.currentDateTime();
+   const QDateTime tomorrow(now.date().addDays(1), QTime(0, 0, 0, 0));
+   return tomorrow.toMSecsSinceEpoch() - now.toMSecsSinceEpoch();
 }
 
-int sauto::wholeDaysUntilEpochMS(quint64 msecs, bool &ok)
+int sauto::wholeDaysUntilEpochMS(quint64 msecs, bool &ok, const SautoTimeSource &time)
 {
    ok = true;
-   qint64 cleanMs = msecs - QDateTime::currentMSecsSinceEpoch() + sauto::msecsToTomorrow();
+   const QDateTime now = time.currentDateTime();
+   const qint64 nowMSecs = now.toMSecsSinceEpoch();
+   const qint64 tomorrow = QDateTime(now.date().addDays(1), QTime(0, 0, 0, 0)).toMSecsSinceEpoch();
+   const qint64 cleanMs = static_cast<qint64>(msecs) - nowMSecs + (tomorrow - nowMSecs);
    if(0 > cleanMs)
    {
       ok = false;
       return -1;
    }
-   return qFloor(static_cast<qreal>(cleanMs) / static_cast<qreal>(msecsPer_Day));
+   return static_cast<int>(cleanMs / msecsPer_Day);
 }
 
+//  Number of days from one date to the other, not ok if the other date is before the first
 int sauto::daysBetweenDates(const QDate &from, const QDate &to, bool &ok)
 {
-   ok = true;
-   int days = 0;
-   int toYear = to.year();
-   int fromYear = from.year();
-   if (fromYear > toYear)
+   const qint64 days = daysFromCivil(to.year(), to.month(), to.day()) - daysFromCivil(from.year(), from.month(), from.day());
+   if (days < 0)
    {
       // this date is in the past
       ok = false;
       return 0;
    }
-   else if (fromYear < toYear)
-   {
-      // the time to use is not this year, but a year in the future
-      int daysLeftOfThisYear = from.daysInYear() - from.dayOfYear();
-      int dummyYear = fromYear;
-      while (dummyYear < toYear)
-      {
-         ++dummyYear;
-         QDate dummyDate(dummyYear, 1, 1);
-         if (dummyYear == toYear)
-         {
-            days += to.daysInYear() - to.dayOfYear();
-         }
-         else
-         {
-            days += dummyDate.daysInYear();
-         }
-      }
-      days += daysLeftOfThisYear;
-   }
-   else
-   {
-      days += to.dayOfYear() - from.dayOfYear();
-      if (days < 0)
-      {
-         // this date is in the past
-         ok = false;
-         return 0;
-      }
-   }
-
-   return days;
+   ok = true;
+   return static_cast<int>(days);
 }
 
 qint64 sauto::get_SEC_sinceMidnight(const QTime &time)
@@ -175,61 +148,59 @@ qint64 sauto::get_MSEC_sinceMidnight(const QTime &time)
    return (sauto::get_SEC_sinceMidnight(time) * 1000) + time.msec();
 }
 
+//  The names are told apart on their length and first letters before a whole name is compared, so a
+//  name costs at most one string comparison, and nothing is allocated
 int sauto::getMonthAsInt(const QString &monthStr)
 {
-   if(monthStr == QString(JAN_STR))
-   {
-      return 1;
-   }
-   else if(monthStr == QString(FEB_STR))
-   {
-      return 2;
-   }
-   else if(monthStr == QString(MAR_STR))
-   {
-      return 3;
-   }
-   else if(monthStr == QString(APR_STR))
-   {
-      return 4;
-   }
-   else if(monthStr == QString(MAY_STR))
-   {
-      return 5;
-   }
-   else if(monthStr == QString(JUN_STR))
-   {
-      return 6;
-   }
-   else if(monthStr == QString(JUL_STR))
+   if (monthStr.size() < 3)
    {
-      return 7;
-   }
-   else if(monthStr == QString(AUG_STR))
-   {
-      return 8;
-   }
-   else if(monthStr == QString(SEP_STR))
-   {
-      return 9;
-   }
-   else if(monthStr == QString(OKT_STR))
-   {
-      return 10;
+      return -1;
    }
-   else if(monthStr == QString(NOV_STR))
+
+   int month = -1;
+   switch (monthStr.at(0).unicode())
    {
-      return 11;
+   case('j') :
+      month = monthStr.at(1) == QLatin1Char('a') ? 1 : (monthStr.at(2) == QLatin1Char('n') ? 6 : 7);
+      break;
+   case('f') : month = 2;  break;
+   case('m') : month = monthStr.at(2) == QLatin1Char('r') ? 3 : 5; break;
+   case('a') : month = monthStr.at(1) == QLatin1Char('p') ? 4 : 8; break;
+   case('s') : month = 9;  break;
+   case('o') : month = 10; break;
+   case('n') : month = 11; break;
+   case('d') : month = 12; break;
+   default:
+      // error
+      return -1;
    }
-   else if(monthStr == QString(DEC_STR))
+
+   static const QString names[] = { JAN_STR, FEB_STR, MAR_STR, APR_STR, MAY_STR, JUN_STR, JUL_STR, AUG_STR, SEP_STR, OKT_STR, NOV_STR, DEC_STR };
+   return monthStr == names[month - 1] ? month : -1;
+}
+
+//  The number of the weekday, 1 is monday, -1 if the name is not a weekday
+int sauto::getDayAsInt(const QString &dayStr)
+{
+   if (dayStr.size() < 2)
    {
-      return 12;
+      return -1;
    }
-   else
+
+   int day = -1;
+   switch (dayStr.at(0).unicode())
    {
-      // error
+   case('m') : day = MONDAY; break;
+   case('t') : day = dayStr.at(1) == QLatin1Char('u') ? TUESDAY : THURSDAY; break;
+   case('w') : day = WEDNESDAY; break;
+   case('f') : day = FRIDAY; break;
+   case('s') : day = dayStr.at(1) == QLatin1Char('a') ? SATRUDAY : SUNDAY; break;
+   default:
       return -1;
    }
+
+   static const QString names[] = { MON_STR, TUE_STR, WED_STR, THU_STR, FRI_STR, SAT_STR, SUN_STR };
+   return dayStr == names[day - 1] ? day : -1;
 }
 
 QString sauto::msecToStr(qint64 msec)
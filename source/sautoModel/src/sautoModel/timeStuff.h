@@ -42,6 +42,8 @@
 #include <QMap>
 #include <QDateTime>
 
+#include "sautoTime.h"
+
 namespace sauto {
 
    static const quint64 m_maxTimeletPeriod = (23 * 60 * 60 + 59 * 60 + 59) * 1000;
@@ -107,7 +109,17 @@ namespace sauto {
    static const int YEARS_IN_CALENDAR = 5;
 
    static const int CLOCK_COOLDOWN_MSEC = 10;
-   static const int CLOCK_ADJUST_INTERV = 1000;
+   static const int CLOCK_JUMP_TOLERANCE = 1000;
+
+   // a trigger that comes this close after the time it is planned at, or after the trigger before
+   // it, is dropped
+   static const int TRIGGER_SPACING_MSEC = 100;
+
+   enum EClockMode
+   {
+      CLOCK_POLLING  , // countdowns are ticked every CLOCK_COOLDOWN_MSEC
+      CLOCK_DEADLINE , // a single shot is armed for the next session start, trigger or session end
+   };
 
    enum EEventType
    {
@@ -171,15 +183,85 @@ namespace sauto {
       VALLEY
    };
 
+   struct SautoCivilDate
+   {
+      int year;
+      int month; //< 1 - 12
+      int day;   //< 1 - 31
+   };
+
+   // Integer conversions between proleptic gregorian dates and days since 1970-01-01, in the shape of
+   // the well known days_from_civil / civil_from_days algorithms. Years are shifted to start in march,
+   // so that the leap day is the last day of the shifted year, and eras of 400 years repeat exactly.
+   // Nothing is allocated and no time zone is involved
+   Q_DECL_RELAXED_CONSTEXPR inline qint64 daysFromCivil(int year, int month, int day)
+   {
+      const qint64 y = static_cast<qint64>(year) - (month <= 2 ? 1 : 0);
+      const qint64 era = (y >= 0 ? y : y - 399) / 400;
+      const qint64 yearOfEra = y - era * 400;
+      const qint64 dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+      const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+      return era * 146097 + dayOfEra - 719468;
+   }
+
+   Q_DECL_RELAXED_CONSTEXPR inline SautoCivilDate civilFromDays(qint64 days)
+   {
+      days += 719468;
+      const qint64 era = (days >= 0 ? days : days - 146096) / 146097;
+      const qint64 dayOfEra = days - era * 146097;
+      const qint64 yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+      const qint64 dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+      const qint64 shiftedMonth = (5 * dayOfYear + 2) / 153;
+      const int month = static_cast<int>(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+      const SautoCivilDate date = { static_cast<int>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0)),
+         month,
+         static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1) };
+      return date;
+   }
+
+   Q_DECL_CONSTEXPR inline bool isLeapYear(int year)
+   {
+      return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+   }
+
+   Q_DECL_CONSTEXPR inline int daysInMonth(int year, int month)
+   {
+      return month == 2 ? (isLeapYear(year) ? 29 : 28) : ((month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31);
+   }
+
+   // 1 is monday, like QDate::dayOfWeek(), 1970-01-01 was a thursday
+   Q_DECL_CONSTEXPR inline int dayOfWeekFromDays(qint64 days)
+   {
+      return days >= -3 ? static_cast<int>((days + 3) % 7) + 1 : static_cast<int>((days + 4) % 7) + 7;
+   }
+
+   // division that rounds towards minus infinity, so that times before 1970 land in the right day
+   Q_DECL_CONSTEXPR inline qint64 floorDiv(qint64 value, qint64 divisor)
+   {
+      return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+   }
+
+   // QDate keeps the julian day, which is the same count from another origin
+   inline qint64 daysFromDate(const QDate &date)
+   {
+      return date.toJulianDay() - Q_INT64_C(2440588);
+   }
+
+   inline QDate dateFromDays(qint64 days)
+   {
+      return QDate::fromJulianDay(days + Q_INT64_C(2440588));
+   }
+
    const QMap<DAYS, QString>& makeWeek();
    const QMap<MONTH_ID, QString>& makeYear();
    bool dateIsValid(const QDate &date);
-   qint64 msecsToTomorrow();
-   int wholeDaysUntilEpochMS(quint64 msecs, bool &ok);
+   qint64 msecsToTomorrow(const SautoTimeSource &time = systemTime());
+   int wholeDaysUntilEpochMS(quint64 msecs, bool &ok, const SautoTimeSource &time = systemTime());
    int daysBetweenDates(const QDate &from, const QDate &to, bool &ok);
    qint64 get_SEC_sinceMidnight(const QTime &time);
    qint64 get_MSEC_sinceMidnight(const QTime &time);
    int getMonthAsInt(const QString &monthStr);
+   int getDayAsInt(const QString &dayStr);
    QString msecToStr(qint64 msec);
    qint64 stringTimeToEpoch(const QString &str);
    QString englishToNorwegian_shortMonthName(const QString &englishMonth);
@@ -0,0 +1,583 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoBinary.cpp
+//
+//  \brief     Implementation of the compiled binary clock definition file format
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+// std includes
+#include <cstring>
+
+// Qt includes
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QtDebug>
+
+// local includes
+#include "sautoBinary.h"
+#include "sautoXml.h"
+
+using namespace sauto;
+
+enum ECheckerBits
+{
+   CHECK_ASAP        = 0x1,
+   CHECK_ALL_DAY     = 0x2,
+   CHECK_EVERY_DAY   = 0x4,
+   CHECK_EVERY_MONTH = 0x8,
+};
+
+qreal SautoBinaryReader::readReal()
+{
+   const quint64 bits = read<quint64>();
+   double real = 0;
+   std::memcpy(&real, &bits, sizeof(real));
+   return real;
+}
+
+QString SautoBinaryReader::readString()
+{
+   const quint32 size = read<quint32>();
+   if (!m_ok || m_end - m_pos < static_cast<qint64>(size))
+   {
+      m_ok = false;
+      return QString();
+   }
+   const QString str = QString::fromUtf8(reinterpret_cast<const char*>(m_pos), size);
+   m_pos += size;
+   return str;
+}
+
+//  A count of records that are at least minSize bytes each, so that a damaged count can't make the
+//  reader reserve memory for records that aren't there
+int SautoBinaryReader::readCount(int minSize)
+{
+   const quint32 count = read<quint32>();
+   if (!m_ok || static_cast<qint64>(count) * minSize > m_end - m_pos)
+   {
+      m_ok = false;
+      return 0;
+   }
+   return static_cast<int>(count);
+}
+
+SautoModel SautoBinaryReader::readModel()
+{
+   SautoModel model;
+   const quint8 type = read<quint8>();
+   const bool hasCustom = read<quint8>() != 0;
+   model.setType(type <= SINGLE ? static_cast<EIntervalType>(type) : NOT_SPECIFIED);
+   model.setPhase(readReal());
+   model.setDuration(read<quint64>());
+   model.setStartTimeMSecs(read<qint64>());
+   model.setPeriodTotMSecs(read<quint64>());
+   model.setOnPeak(readString());
+   model.setOnValley(readString());
+   model.setOnRising(readString());
+   model.setOnSinking(readString());
+   model.setHasCustomInterval(hasCustom);
+   return model;
+}
+
+INTERVAL_LIST SautoBinaryReader::readList()
+{
+   INTERVAL_LIST list;
+   const int count = readCount(MODEL_MIN_SIZE);
+   list.reserve(count);
+   for (int i = 0; i < count && m_ok; i++)
+   {
+      list.append(readModel());
+   }
+   return list;
+}
+
+SautoBinary::SautoBinary()
+   :m_checkers(CHECK_ASAP | CHECK_ALL_DAY | CHECK_EVERY_DAY | CHECK_EVERY_MONTH),
+   m_sourceSize(-1),
+   m_sourceModified(-1)
+{
+
+}
+
+bool SautoBinary::writeClockFile(
+   const QString &fileName,
+   const SautoModel  &frequency,
+   const INTERVAL_LIST &interval,
+   const WEEK_DEF &week,
+   const CALENDAR_DEF  &calender
+   )
+{
+   const QByteArray data = clockData(frequency, interval, week, calender);
+
+   // readers never see a half written file
+   QSaveFile file(fileName);
+   if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+   {
+      m_error = QString("Failed at writing file '%1'").arg(fileName);
+      return false;
+   }
+   return true;
+}
+
+//  The contents of a binary clock file, header included, which readClockData() takes back
+QByteArray SautoBinary::clockData(
+   const SautoModel  &frequency,
+   const INTERVAL_LIST &interval,
+   const WEEK_DEF &week,
+   const CALENDAR_DEF  &calender
+   ) const
+{
+   QByteArray payload;
+   writeModel(payload, frequency);
+   writeList(payload, interval);
+
+   write<quint32>(payload, static_cast<quint32>(week.size()));
+   WEEK_ITERATOR week_it(week);
+   while (week_it.hasNext())
+   {
+      week_it.next();
+      write<quint8>(payload, static_cast<quint8>(week_it.key()));
+      write<quint8>(payload, dayIsToggled(week_it.value()) ? 1 : 0);
+      write<quint8>(payload, dayInheritsTime(week_it.value()) ? 1 : 0);
+      writeList(payload, week_it.value().second);
+   }
+
+   write<quint32>(payload, static_cast<quint32>(calender.size()));
+   CALENDAR_ITERATOR cal_it(calender);
+   while (cal_it.hasNext())
+   {
+      cal_it.next();
+      write<qint32>(payload, cal_it.key());
+      write<quint8>(payload, cal_it.value().first ? 1 : 0);
+      write<quint32>(payload, static_cast<quint32>(cal_it.value().second.size()));
+      MONTH_ITERATOR month_it(cal_it.value().second);
+      while (month_it.hasNext())
+      {
+         month_it.next();
+         writeString(payload, month_it.key());
+         write<quint8>(payload, month_it.value().first ? 1 : 0);
+         write<quint32>(payload, static_cast<quint32>(month_it.value().second.size()));
+         QMapIterator<int, CALENDAR_DATE> day_it(month_it.value().second);
+         while (day_it.hasNext())
+         {
+            day_it.next();
+            write<qint32>(payload, day_it.key());
+            write<qint64>(payload, calendarDate_QDate(day_it.value()).toJulianDay());
+            write<quint8>(payload, calendarDateInheritsTime(day_it.value()) ? 1 : 0);
+            writeList(payload, day_it.value().second);
+         }
+      }
+   }
+
+   QByteArray data;
+   data.reserve(SAUTO_BINARY_HEADER_SIZE + payload.size());
+   write<quint32>(data, SAUTO_BINARY_MAGIC);
+   write<quint16>(data, SAUTO_BINARY_VERSION);
+   write<quint16>(data, m_checkers);
+   write<qint64>(data, m_sourceSize);
+   write<qint64>(data, m_sourceModified);
+   write<quint32>(data, static_cast<quint32>(payload.size()));
+   write<quint32>(data, crc32(reinterpret_cast<const uchar*>(payload.constData()), payload.size()));
+   data.append(payload);
+   return data;
+}
+
+void SautoBinary::writeReal(QByteArray &data, qreal value)
+{
+   double real = value;
+   quint64 bits = 0;
+   std::memcpy(&bits, &real, sizeof(bits));
+   write<quint64>(data, bits);
+}
+
+void SautoBinary::writeString(QByteArray &data, const QString &str)
+{
+   const QByteArray utf8 = str.toUtf8();
+   write<quint32>(data, static_cast<quint32>(utf8.size()));
+   data.append(utf8);
+}
+
+void SautoBinary::writeModel(QByteArray &data, const SautoModel &model)
+{
+   write<quint8>(data, static_cast<quint8>(model.getType()));
+   write<quint8>(data, model.getHasCustomInterval() ? 1 : 0);
+   writeReal(data, model.getPhase());
+   write<quint64>(data, model.getDuration());
+   write<qint64>(data, model.getStartTimeMSec());
+   write<quint64>(data, model.getPeriodTotMSec());
+   writeString(data, model.getOnPeak());
+   writeString(data, model.getOnValley());
+   writeString(data, model.getOnRising());
+   writeString(data, model.getOnSinking());
+}
+
+void SautoBinary::writeList(QByteArray &data, const INTERVAL_LIST &list)
+{
+   write<quint32>(data, static_cast<quint32>(list.size()));
+   for (int i = 0; i < list.size(); i++)
+   {
+      writeModel(data, list.at(i));
+   }
+}
+
+bool SautoBinary::readClockFile(
+   const QString &fileName,
+   SautoModel  &frequency,
+   INTERVAL_LIST &interval,
+   WEEK_DEF &week,
+   CALENDAR_DEF  &calender
+   )
+{
+   QFile file(fileName);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      m_error = QString("Failed at opening file '%1'").arg(fileName);
+      return false;
+   }
+
+   // the file is read through a memory map when the platform allows it
+   const qint64 size = file.size();
+   const uchar *data = size > 0 ? file.map(0, size) : 0;
+   if (data != 0)
+   {
+      return readClockData(data, size, frequency, interval, week, calender);
+   }
+   const QByteArray bytes = file.readAll();
+   return readClockData(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(), frequency, interval, week, calender);
+}
+
+bool SautoBinary::readClockData(
+   const uchar *data,
+   qint64 size,
+   SautoModel  &frequency,
+   INTERVAL_LIST &interval,
+   WEEK_DEF &week,
+   CALENDAR_DEF  &calender
+   )
+{
+   SautoBinaryReader header(data, qMin<qint64>(size, SAUTO_BINARY_HEADER_SIZE));
+   const quint32 magic    = header.read<quint32>();
+   const quint16 version  = header.read<quint16>();
+   const quint16 checkers = header.read<quint16>();
+   const qint64 sourceSize     = header.read<qint64>();
+   const qint64 sourceModified = header.read<qint64>();
+   const quint32 payload  = header.read<quint32>();
+   const quint32 checksum = header.read<quint32>();
+   if (!header.ok() || magic != SAUTO_BINARY_MAGIC)
+   {
+      m_error = "Not a binary clock file";
+      return false;
+   }
+   if (version != SAUTO_BINARY_VERSION)
+   {
+      m_error = QString("Unsupported binary clock file version %1").arg(version);
+      return false;
+   }
+   if (size - SAUTO_BINARY_HEADER_SIZE != static_cast<qint64>(payload) ||
+      crc32(data + SAUTO_BINARY_HEADER_SIZE, payload) != checksum)
+   {
+      m_error = "The binary clock file is damaged";
+      return false;
+   }
+   m_checkers = checkers;
+   m_sourceSize = sourceSize;
+   m_sourceModified = sourceModified;
+
+   SautoBinaryReader reader(data + SAUTO_BINARY_HEADER_SIZE, payload);
+   SautoModel freq = reader.readModel();
+   INTERVAL_LIST intervals = reader.readList();
+
+   WEEK_DEF weekDef;
+   const int days = reader.readCount(7);
+   for (int i = 0; i < days && reader.ok(); i++)
+   {
+      const int dayOfWeek = reader.read<quint8>();
+      DAY_OF_WEEK_DEF day;
+      day.first.first = reader.read<quint8>() != 0;
+      day.first.second = reader.read<quint8>() != 0;
+      day.second = reader.readList();
+      weekDef.insert(dayOfWeek, day);
+   }
+
+   CALENDAR_DEF calendarDef;
+   const int years = reader.readCount(9);
+   for (int i = 0; i < years && reader.ok(); i++)
+   {
+      const int yearNo = reader.read<qint32>();
+      const bool active = reader.read<quint8>() != 0;
+      MONTH_DEF months;
+      const int monthCount = reader.readCount(9);
+      for (int j = 0; j < monthCount && reader.ok(); j++)
+      {
+         const QString name = reader.readString();
+         DAY_OF_MONTH_DEF month;
+         month.first = reader.read<quint8>() != 0;
+         const int dayCount = reader.readCount(17);
+         for (int k = 0; k < dayCount && reader.ok(); k++)
+         {
+            const int key = reader.read<qint32>();
+            CALENDAR_DATE date;
+            date.first.first = QDate::fromJulianDay(reader.read<qint64>());
+            date.first.second = reader.read<quint8>() != 0;
+            date.second = reader.readList();
+            month.second.insert(key, date);
+         }
+         months.insert(name, month);
+      }
+      calendarDef.insert(yearNo, qMakePair(active, months));
+   }
+
+   if (!reader.ok() || !reader.atEnd())
+   {
+      m_error = "The binary clock file is damaged";
+      return false;
+   }
+
+   frequency = freq;
+   interval = intervals;
+   week = weekDef;
+   calender = calendarDef;
+   return true;
+}
+
+void SautoBinary::setCheckers(
+   bool asap,
+   bool allDay,
+   bool everyDay,
+   bool everyMonth
+   )
+{
+   m_checkers = 0;
+   m_checkers |= asap ? CHECK_ASAP : 0;
+   m_checkers |= allDay ? CHECK_ALL_DAY : 0;
+   m_checkers |= everyDay ? CHECK_EVERY_DAY : 0;
+   m_checkers |= everyMonth ? CHECK_EVERY_MONTH : 0;
+}
+
+void SautoBinary::getCheckers(
+   bool &asap,
+   bool &allDay,
+   bool &everyDay,
+   bool &everyMonth
+   ) const
+{
+   asap = (m_checkers & CHECK_ASAP) != 0;
+   allDay = (m_checkers & CHECK_ALL_DAY) != 0;
+   everyDay = (m_checkers & CHECK_EVERY_DAY) != 0;
+   everyMonth = (m_checkers & CHECK_EVERY_MONTH) != 0;
+}
+
+//  The XML file that the data is compiled from, see isCompiledFrom()
+void SautoBinary::setSource(qint64 size, qint64 lastModified)
+{
+   m_sourceSize = size;
+   m_sourceModified = lastModified;
+}
+
+//  True when the data that was read last was compiled from the argument XML file as it is now. The
+//  modification time alone is not trusted, a file can be replaced by an older one or keep its time
+bool SautoBinary::isCompiledFrom(const QString &xmlFileName) const
+{
+   const QFileInfo info(xmlFileName);
+   return info.exists() && m_sourceSize == info.size() &&
+      m_sourceModified == info.lastModified().toMSecsSinceEpoch();
+}
+
+bool SautoBinary::isBinaryClockFile(const QString &fileName)
+{
+   QFile file(fileName);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      return false;
+   }
+   uchar magic[4];
+   if (file.read(reinterpret_cast<char*>(magic), 4) != 4)
+   {
+      return false;
+   }
+   return qFromLittleEndian<quint32>(magic) == SAUTO_BINARY_MAGIC;
+}
+
+// CRC-32 of every byte value, with the reflected polynomial 0xEDB88320 of zlib and PNG. The table is
+// constant, so that clock files can be checked from any thread
+static const quint32 s_crcTable[256] = {
+   0x00000000u, 0x77073096u, 0xEE0E612Cu, 0x990951BAu, 0x076DC419u, 0x706AF48Fu, 0xE963A535u, 0x9E6495A3u,
+   0x0EDB8832u, 0x79DCB8A4u, 0xE0D5E91Eu, 0x97D2D988u, 0x09B64C2Bu, 0x7EB17CBDu, 0xE7B82D07u, 0x90BF1D91u,
+   0x1DB71064u, 0x6AB020F2u, 0xF3B97148u, 0x84BE41DEu, 0x1ADAD47Du, 0x6DDDE4EBu, 0xF4D4B551u, 0x83D385C7u,
+   0x136C9856u, 0x646BA8C0u, 0xFD62F97Au, 0x8A65C9ECu, 0x14015C4Fu, 0x63066CD9u, 0xFA0F3D63u, 0x8D080DF5u,
+   0x3B6E20C8u, 0x4C69105Eu, 0xD56041E4u, 0xA2677172u, 0x3C03E4D1u, 0x4B04D447u, 0xD20D85FDu, 0xA50AB56Bu,
+   0x35B5A8FAu, 0x42B2986Cu, 0xDBBBC9D6u, 0xACBCF940u, 0x32D86CE3u, 0x45DF5C75u, 0xDCD60DCFu, 0xABD13D59u,
+   0x26D930ACu, 0x51DE003Au, 0xC8D75180u, 0xBFD06116u, 0x21B4F4B5u, 0x56B3C423u, 0xCFBA9599u, 0xB8BDA50Fu,
+   0x2802B89Eu, 0x5F058808u, 0xC60CD9B2u, 0xB10BE924u, 0x2F6F7C87u, 0x58684C11u, 0xC1611DABu, 0xB6662D3Du,
+   0x76DC4190u, 0x01DB7106u, 0x98D220BCu, 0xEFD5102Au, 0x71B18589u, 0x06B6B51Fu, 0x9FBFE4A5u, 0xE8B8D433u,
+   0x7807C9A2u, 0x0F00F934u, 0x9609A88Eu, 0xE10E9818u, 0x7F6A0DBBu, 0x086D3D2Du, 0x91646C97u, 0xE6635C01u,
+   0x6B6B51F4u, 0x1C6C6162u, 0x856530D8u, 0xF262004Eu, 0x6C0695EDu, 0x1B01A57Bu, 0x8208F4C1u, 0xF50FC457u,
+   0x65B0D9C6u, 0x12B7E950u, 0x8BBEB8EAu, 0xFCB9887Cu, 0x62DD1DDFu, 0x15DA2D49u, 0x8CD37CF3u, 0xFBD44C65u,
+   0x4DB26158u, 0x3AB551CEu, 0xA3BC0074u, 0xD4BB30E2u, 0x4ADFA541u, 0x3DD895D7u, 0xA4D1C46Du, 0xD3D6F4FBu,
+   0x4369E96Au, 0x346ED9FCu, 0xAD678846u, 0xDA60B8D0u, 0x44042D73u, 0x33031DE5u, 0xAA0A4C5Fu, 0xDD0D7CC9u,
+   0x5005713Cu, 0x270241AAu, 0xBE0B1010u, 0xC90C2086u, 0x5768B525u, 0x206F85B3u, 0xB966D409u, 0xCE61E49Fu,
+   0x5EDEF90Eu, 0x29D9C998u, 0xB0D09822u, 0xC7D7A8B4u, 0x59B33D17u, 0x2EB40D81u, 0xB7BD5C3Bu, 0xC0BA6CADu,
+   0xEDB88320u, 0x9ABFB3B6u, 0x03B6E20Cu, 0x74B1D29Au, 0xEAD54739u, 0x9DD277AFu, 0x04DB2615u, 0x73DC1683u,
+   0xE3630B12u, 0x94643B84u, 0x0D6D6A3Eu, 0x7A6A5AA8u, 0xE40ECF0Bu, 0x9309FF9Du, 0x0A00AE27u, 0x7D079EB1u,
+   0xF00F9344u, 0x8708A3D2u, 0x1E01F268u, 0x6906C2FEu, 0xF762575Du, 0x806567CBu, 0x196C3671u, 0x6E6B06E7u,
+   0xFED41B76u, 0x89D32BE0u, 0x10DA7A5Au, 0x67DD4ACCu, 0xF9B9DF6Fu, 0x8EBEEFF9u, 0x17B7BE43u, 0x60B08ED5u,
+   0xD6D6A3E8u, 0xA1D1937Eu, 0x38D8C2C4u, 0x4FDFF252u, 0xD1BB67F1u, 0xA6BC5767u, 0x3FB506DDu, 0x48B2364Bu,
+   0xD80D2BDAu, 0xAF0A1B4Cu, 0x36034AF6u, 0x41047A60u, 0xDF60EFC3u, 0xA867DF55u, 0x316E8EEFu, 0x4669BE79u,
+   0xCB61B38Cu, 0xBC66831Au, 0x256FD2A0u, 0x5268E236u, 0xCC0C7795u, 0xBB0B4703u, 0x220216B9u, 0x5505262Fu,
+   0xC5BA3BBEu, 0xB2BD0B28u, 0x2BB45A92u, 0x5CB36A04u, 0xC2D7FFA7u, 0xB5D0CF31u, 0x2CD99E8Bu, 0x5BDEAE1Du,
+   0x9B64C2B0u, 0xEC63F226u, 0x756AA39Cu, 0x026D930Au, 0x9C0906A9u, 0xEB0E363Fu, 0x72076785u, 0x05005713u,
+   0x95BF4A82u, 0xE2B87A14u, 0x7BB12BAEu, 0x0CB61B38u, 0x92D28E9Bu, 0xE5D5BE0Du, 0x7CDCEFB7u, 0x0BDBDF21u,
+   0x86D3D2D4u, 0xF1D4E242u, 0x68DDB3F8u, 0x1FDA836Eu, 0x81BE16CDu, 0xF6B9265Bu, 0x6FB077E1u, 0x18B74777u,
+   0x88085AE6u, 0xFF0F6A70u, 0x66063BCAu, 0x11010B5Cu, 0x8F659EFFu, 0xF862AE69u, 0x616BFFD3u, 0x166CCF45u,
+   0xA00AE278u, 0xD70DD2EEu, 0x4E048354u, 0x3903B3C2u, 0xA7672661u, 0xD06016F7u, 0x4969474Du, 0x3E6E77DBu,
+   0xAED16A4Au, 0xD9D65ADCu, 0x40DF0B66u, 0x37D83BF0u, 0xA9BCAE53u, 0xDEBB9EC5u, 0x47B2CF7Fu, 0x30B5FFE9u,
+   0xBDBDF21Cu, 0xCABAC28Au, 0x53B39330u, 0x24B4A3A6u, 0xBAD03605u, 0xCDD70693u, 0x54DE5729u, 0x23D967BFu,
+   0xB3667A2Eu, 0xC4614AB8u, 0x5D681B02u, 0x2A6F2B94u, 0xB40BBE37u, 0xC30C8EA1u, 0x5A05DF1Bu, 0x2D02EF8Du,
+};
+
+//  CRC-32 with the polynomial of zlib and PNG
+quint32 sauto::crc32(const uchar *data, qint64 size)
+{
+   quint32 crc = 0xFFFFFFFFu;
+   for (qint64 i = 0; i < size; i++)
+   {
+      crc = s_crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+   }
+   return crc ^ 0xFFFFFFFFu;
+}
+
+//  The compiled file that belongs to an XML clock file, next to it with the binary suffix
+QString sauto::binaryClockFileName(const QString &xmlFileName)
+{
+   const QFileInfo info(xmlFileName);
+   return info.path() + "/" + info.completeBaseName() + "." + SAUTO_BINARY_SUFFIX;
+}
+
+bool sauto::convertClockFile(const QString &xmlFileName, const QString &binaryFileName)
+{
+   // the source is taken before the XML is read, a change while it is read is found the next time
+   const QFileInfo info(xmlFileName);
+   const qint64 sourceSize = info.size();
+   const qint64 sourceModified = info.lastModified().toMSecsSinceEpoch();
+
+   SautoModel frequency;
+   INTERVAL_LIST interval;
+   WEEK_DEF week;
+   CALENDAR_DEF calendar;
+   SautoXml xml;
+   if (!xml.readClockFile(xmlFileName, frequency, interval, week, calendar))
+   {
+      return false;
+   }
+
+   bool asap, allDay, everyDay, everyMonth;
+   xml.getCheckers(asap, allDay, everyDay, everyMonth);
+   SautoBinary binary;
+   binary.setCheckers(asap, allDay, everyDay, everyMonth);
+   binary.setSource(sourceSize, sourceModified);
+   if (!binary.writeClockFile(binaryFileName, frequency, interval, week, calendar))
+   {
+      qCritical() << binary.errorString();
+      return false;
+   }
+   return true;
+}
+
+//  Loads a clock file of either format. An XML file is loaded from its compiled file instead when
+//  there is one that was compiled from the XML as it is now. Otherwise the XML is parsed, and
+//  compiled for the next time when its folder is writable
+bool sauto::loadClockFile(
+   const QString &fileName,
+   SautoModel  &frequency,
+   INTERVAL_LIST &interval,
+   WEEK_DEF &week,
+   CALENDAR_DEF  &calender,
+   QString *error
+   )
+{
+   SautoBinary binary;
+   if (SautoBinary::isBinaryClockFile(fileName))
+   {
+      if (!binary.readClockFile(fileName, frequency, interval, week, calender))
+      {
+         qCritical() << binary.errorString();
+         if (error != 0)
+         {
+            *error = binary.errorString();
+         }
+         return false;
+      }
+      return true;
+   }
+
+   // the compiled file is read aside, it is only handed out when it was made from the XML as it is now
+   const QFileInfo xmlInfo(fileName);
+   const QFileInfo binaryInfo(binaryClockFileName(fileName));
+   if (binaryInfo.exists())
+   {
+      SautoModel binaryFrequency;
+      INTERVAL_LIST binaryInterval;
+      WEEK_DEF binaryWeek;
+      CALENDAR_DEF binaryCalender;
+      if (binary.readClockFile(binaryInfo.filePath(), binaryFrequency, binaryInterval, binaryWeek, binaryCalender) &&
+         binary.isCompiledFrom(fileName))
+      {
+         frequency = binaryFrequency;
+         interval = binaryInterval;
+         week = binaryWeek;
+         calender = binaryCalender;
+         return true;
+      }
+   }
+
+   const qint64 sourceSize = xmlInfo.size();
+   const qint64 sourceModified = xmlInfo.lastModified().toMSecsSinceEpoch();
+   SautoXml xml;
+   if (!xml.readClockFile(fileName, frequency, interval, week, calender))
+   {
+      if (error != 0)
+      {
+         *error = xml.errorString();
+      }
+      return false;
+   }
+
+   bool asap, allDay, everyDay, everyMonth;
+   xml.getCheckers(asap, allDay, everyDay, everyMonth);
+   binary.setCheckers(asap, allDay, everyDay, everyMonth);
+   binary.setSource(sourceSize, sourceModified);
+   binary.writeClockFile(binaryInfo.filePath(), frequency, interval, week, calender);
+   return true;
+}
@@ -0,0 +1,186 @@
+//h+//////////////////////////////////////////////////////////////////////////
+//
+// Copyright (C) 2016 Broentech Solutions AS
+// Contact: https://broentech.no/#!/contact
+//
+//
+// GNU Lesser General Public License Usage
+// This file may be used under the terms of the GNU Lesser
+// General Public License version 3 as published by the Free Software
+// Foundation and appearing in the file LICENSE.LGPL3 included in the
+// packaging of this file. Please review the following information to
+// ensure the GNU Lesser General Public License version 3 requirements
+// will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+//
+//
+//h+//////////////////////////////////////////////////////////////////////////
+//
+//  \file      sautoBinary.h
+//
+//  \brief     Definition of the compiled binary clock definition file format
+//
+//  \author    Stian Broen
+//
+//  \date      17.10.2026
+//
+//
+//
+//
+//  \par       Revision History
+//
+//
+//
+//
+//
+//h-//////////////////////////////////////////////////////////////////////////
+
+#ifndef _SAUTO_BINARY_H
+#define _SAUTO_BINARY_H
+
+// Qt includes
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+
+// solution includes
+#include <sautoModel/sautoDefs.h>
+
+namespace sauto {
+
+   static const quint32 SAUTO_BINARY_MAGIC   = 0x42554153; //< "SAUB"
+   static const quint16 SAUTO_BINARY_VERSION = 2;
+   static const int SAUTO_BINARY_HEADER_SIZE = 32;
+   static const QString SAUTO_BINARY_SUFFIX("saub");
+
+   // A clock definition file in a flat binary form, which is read straight from a memory map
+   // without building a tree or parsing any text. All values are little endian:
+   //
+   //    header  : magic u32, version u16, checkers u16, source size i64, source modified i64,
+   //              payload size u32, CRC-32 of payload u32
+   //    payload : frequency model, interval list, week, calendar
+   //    model   : type u8, custom u8, phase f64, duration u64, start i64, period u64, 4 x string
+   //    string  : size u32, UTF-8 bytes
+   //    list    : count u32, models
+   //    week    : count u32, { day u8, toggled u8, inherit u8, list }
+   //    calendar: count u32, { year i32, active u8, months u32,
+   //                 { name string, inherit u8, days u32, { key i32, julian day i64, inherit u8, list } } }
+   //
+   // The source is the size and the modification time, in msecs since epoch, of the XML file that
+   // the file was compiled from, both -1 when it has none. A compiled file whose source doesn't match
+   // its XML file any more, or of another version, is converted again from the XML instead
+   class SautoBinary
+   {
+   public:
+      SautoBinary();
+      bool writeClockFile(const QString &fileName,
+         const SautoModel  &frequency,
+         const INTERVAL_LIST &interval,
+         const WEEK_DEF &week,
+         const CALENDAR_DEF  &calender);
+
+      QByteArray clockData(const SautoModel  &frequency,
+         const INTERVAL_LIST &interval,
+         const WEEK_DEF &week,
+         const CALENDAR_DEF  &calender) const;
+
+      bool readClockFile(const QString &fileName,
+         SautoModel  &frequency,
+         INTERVAL_LIST &interval,
+         WEEK_DEF &week,
+         CALENDAR_DEF &calender);
+
+      bool readClockData(const uchar *data,
+         qint64 size,
+         SautoModel  &frequency,
+         INTERVAL_LIST &interval,
+         WEEK_DEF &week,
+         CALENDAR_DEF &calender);
+
+      void setCheckers(bool asap,
+         bool allDay,
+         bool everyDay,
+         bool everyMonth);
+
+      void getCheckers(bool &asap,
+         bool &allDay,
+         bool &everyDay,
+         bool &everyMonth) const;
+
+      void setSource(qint64 size, qint64 lastModified);
+      inline qint64 sourceSize() const { return m_sourceSize; }
+      inline qint64 sourceModified() const { return m_sourceModified; }
+      bool isCompiledFrom(const QString &xmlFileName) const;
+
+      inline const QString& errorString() const { return m_error; }
+      static bool isBinaryClockFile(const QString &fileName);
+
+      // the values of the format, which the snapshot files write too
+      template<typename T> static void write(QByteArray &data, T value);
+      static void writeReal(QByteArray &data, qreal value);
+      static void writeString(QByteArray &data, const QString &str);
+      static void writeModel(QByteArray &data, const SautoModel &model);
+      static void writeList(QByteArray &data, const INTERVAL_LIST &list);
+
+   private:
+      quint16 m_checkers;
+      qint64 m_sourceSize;
+      qint64 m_sourceModified;
+      QString m_error;
+   };
+
+   template<typename T> void SautoBinary::write(QByteArray &data, T value)
+   {
+      uchar bytes[sizeof(T)];
+      qToLittleEndian<T>(value, bytes);
+      data.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+   }
+
+   // Reads the values that SautoBinary writes from a buffer, every read is checked against the end
+   // of it. A read past the end returns 0 and leaves the reader not ok
+   class SautoBinaryReader
+   {
+   public:
+      SautoBinaryReader(const uchar *data, qint64 size) : m_pos(data), m_end(data + size), m_ok(true) {}
+      inline bool ok() const { return m_ok; }
+      inline bool atEnd() const { return m_pos == m_end; }
+      inline const uchar* pos() const { return m_pos; }
+      inline qint64 left() const { return m_end - m_pos; }
+
+      template<typename T> T read()
+      {
+         if (!m_ok || m_end - m_pos < static_cast<qint64>(sizeof(T)))
+         {
+            m_ok = false;
+            return T(0);
+         }
+         const T value = qFromLittleEndian<T>(m_pos);
+         m_pos += sizeof(T);
+         return value;
+      }
+
+      qreal readReal();
+      QString readString();
+      int readCount(int minSize);
+      SautoModel readModel();
+      INTERVAL_LIST readList();
+
+      static const int MODEL_MIN_SIZE = 2 + 8 * 4 + 4 * 4;
+
+   private:
+      const uchar *m_pos;
+      const uchar *m_end;
+      bool m_ok;
+   };
+
+   quint32 crc32(const uchar *data, qint64 size);
+   QString binaryClockFileName(const QString &xmlFileName);
+   bool convertClockFile(const QString &xmlFileName, const QString &binaryFileName);
+   bool loadClockFile(const QString &fileName,
+      SautoModel  &frequency,
+      INTERVAL_LIST &interval,
+      WEEK_DEF &week,
+      CALENDAR_DEF &calender,
+      QString *error = 0);
+}
+
+#endif
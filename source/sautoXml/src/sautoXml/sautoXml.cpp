@@ -53,8 +53,7 @@ SautoXml::SautoXml(QObject *parent)
    m_everyMonthChecked(true),
    m_defClockSet(false),
    m_defWeekSet(false),
-   m_defCalendarSet(false),
-   m_daysHasCustomInterval(false)
+   m_defCalendarSet(false)
 {
    this->setObjectName("SautoXml");
 }
@@ -93,16 +92,32 @@ bool SautoXml::readClockFile(
    CALENDAR_DEF  &calender
    )
 {
-   CTreeBranch tree;
-   if (!readXml(fileName, &tree))
+   m_error.clear();
+   QFile file(fileName);
+   if (!file.open(QFile::ReadOnly | QFile::Text))
    {
-      qCritical() << QString("%1 '%2'")
+      m_error = file.errorString();
+      qCritical() << QString("%1 '%2' : %3")
          .arg(tr("Failed at reading file"))
-         .arg(fileName);
+         .arg(fileName)
+         .arg(m_error);
       return false;
    }
 
-   return parseProcessTree(&tree, frequency, interval, week, calender);
+   QXmlStreamReader xml(&file);
+   if (!readClockStream(xml, frequency, interval, week, calender))
+   {
+      m_error = QString("%1:%2 : %3")
+         .arg(xml.lineNumber())
+         .arg(xml.columnNumber())
+         .arg(xml.errorString());
+      qCritical() << QString("%1 '%2' (%3)")
+         .arg(tr("Failed at reading file"))
+         .arg(fileName)
+         .arg(m_error);
+      return false;
+   }
+   return true;
 }
 
 void SautoXml::readEntryElement(QXmlStreamReader *xmlReader, CTreeBranch *parent)
@@ -569,162 +584,188 @@ void SautoXml::populateCalendarItem(CTreeBranch *branch, CALENDAR_DEF calendars)
    }
 }
 
-bool SautoXml::parseProcessTree(
-   CTreeBranch *root,
-   SautoModel &frequency,
-   INTERVAL_LIST &interval,
-   WEEK_DEF &week,
-   CALENDAR_DEF &calender
-   )
+//  Moves to the next child element of the current element, false at the end of it. Every read
+//  function below leaves the reader on the end of the element that it was called on
+static bool nextChild(QXmlStreamReader &xml)
 {
-   if (0 == root)
-   {
-      return false;
-   }
-
-   for (int i = 0; i < root->invisibleRootItem()->childCount(); i++)
+   while (!xml.atEnd())
    {
-      CTreeBranch *item = root->invisibleRootItem()->child(i);
-      if (0 == item)
+      xml.readNext();
+      if (xml.isStartElement())
       {
-         continue;
+         return true;
       }
-      if (!parseXmlItem(item, frequency, interval, week, calender))
+      if (xml.isEndElement())
       {
          return false;
       }
    }
+   return false;
+}
 
+static bool readBool(QXmlStreamReader &xml, bool &value)
+{
+   const QString text = xml.readElementText();
+   if (text.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0)
+   {
+      value = true;
+   }
+   else if (text.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0)
+   {
+      value = false;
+   }
+   else
+   {
+      xml.raiseError(QString("Invalid boolean '%1'").arg(text));
+      return false;
+   }
    return true;
 }
 
-bool SautoXml::parseXmlItem(
-   CTreeBranch *branch,
+//  Fills the definitions straight from the reader, in one pass over the file. Definitions that are
+//  not in the file are left as they are
+bool SautoXml::readClockStream(
+   QXmlStreamReader &xml,
    SautoModel &frequency,
    INTERVAL_LIST &interval,
    WEEK_DEF &week,
    CALENDAR_DEF &calender
    )
 {
-   QString itemName = branch->text(0);
-   QString itemVal = branch->text(1);
-   if (itemName == "Time")
+   m_defClockSet = false;
+   m_defWeekSet = false;
+   m_defCalendarSet = false;
+   if (!xml.readNextStartElement())
    {
-      if (!parseXmlTimeSettingsItem(branch,
-         frequency,
-         interval,
-         week,
-         calender))
+      if (!xml.hasError())
       {
-         return false;
+         xml.raiseError(tr("The file has no clock definition"));
       }
+      return false;
    }
 
-   for (int i = 0; i < branch->childCount(); i++)
+   SautoModel freq = frequency;
+   INTERVAL_LIST intervals;
+   WEEK_DEF weekDef;
+   CALENDAR_DEF calendarDef;
+   while (nextChild(xml))
    {
-      if (!parseXmlItem(branch->child(i),
-         frequency,
-         interval,
-         week,
-         calender))
+      const QXmlStreamAttributes attributes = xml.attributes();
+      if (xml.name() == QLatin1String("entry") && attributes.value(QLatin1String("term")) == QLatin1String("Time"))
       {
-         return false;
+         if (!readTimeEntry(xml, freq, intervals, weekDef, calendarDef))
+         {
+            return false;
+         }
+      }
+      else
+      {
+         xml.skipCurrentElement();
       }
    }
+   if (xml.hasError())
+   {
+      return false;
+   }
+
+   frequency = freq;
+   if (m_defClockSet)
+   {
+      interval = intervals;
+   }
+   if (m_defWeekSet)
+   {
+      week = weekDef;
+   }
+   if (m_defCalendarSet)
+   {
+      calender = calendarDef;
+   }
    return true;
 }
 
-bool SautoXml::parseXmlTimeSettingsItem(
-   CTreeBranch *branch,
+//  The definitions are found at any depth below the time entry, the first of each kind is used
+bool SautoXml::readTimeEntry(
+   QXmlStreamReader &xml,
    SautoModel &frequency,
    INTERVAL_LIST &interval,
    WEEK_DEF &week,
    CALENDAR_DEF &calender
    )
 {
-   QString itemName = branch->text(0);
-   QString itemVal = branch->text(1);
-   if (itemName == "Frequency_Definitions")
+   while (nextChild(xml))
    {
-      if (!extractFrequencyDefs(branch, frequency, true))
+      if (xml.name() != QLatin1String("entry"))
       {
-         return false;
+         xml.skipCurrentElement();
+         continue;
       }
-   }
-   else if (itemName == "Clock_Definitions" && !m_defClockSet)
-   {
-      INTERVAL_LIST tmpInterv;
-      if (!extractClockDefs(branch, tmpInterv))
+
+      bool ok = true;
+      const QXmlStreamAttributes attributes = xml.attributes();
+      const QStringRef term = attributes.value(QLatin1String("term"));
+      if (term == QLatin1String("Frequency_Definitions"))
       {
-         return false;
+         ok = readFrequencyEntry(xml, frequency, true);
       }
-      m_defClockSet = true;
-      interval = tmpInterv;
-   }
-   else if (itemName == "Week_Definitions" && !m_defWeekSet)
-   {
-      WEEK_DEF tmpWeek;
-      if (!extractWeekDefs(branch, tmpWeek))
+      else if (term == QLatin1String("Clock_Definitions") && !m_defClockSet)
       {
-         return false;
+         bool inherited = false;
+         ok = readClockEntry(xml, interval, inherited, true);
+         m_defClockSet = true;
       }
-      m_defWeekSet = true;
-      week = tmpWeek;
-   }
-   else if (itemName == "Calendar_Definitions" && !m_defCalendarSet)
-   {
-      CALENDAR_DEF tmpCal;
-      if (!extractCalendarDefs(branch, tmpCal))
+      else if (term == QLatin1String("Week_Definitions") && !m_defWeekSet)
       {
-         return false;
+         ok = readWeekEntry(xml, week);
+         m_defWeekSet = true;
       }
-      m_defCalendarSet = true;
-      calender = tmpCal;
-   }
-
-   for (int i = 0; i < branch->childCount(); i++)
-   {
-      if (!parseXmlTimeSettingsItem(branch->child(i), frequency, interval, week, calender))
+      else if (term == QLatin1String("Calendar_Definitions") && !m_defCalendarSet)
+      {
+         ok = readCalendarEntry(xml, calender);
+         m_defCalendarSet = true;
+      }
+      else
+      {
+         ok = readTimeEntry(xml, frequency, interval, week, calender);
+      }
+      if (!ok)
       {
          return false;
       }
    }
-   return true;
+   return !xml.hasError();
 }
 
-bool SautoXml::extractFrequencyDefs(CTreeBranch *branch, SautoModel &freq, bool isDefaultFreq)
+bool SautoXml::readFrequencyEntry(QXmlStreamReader &xml, SautoModel &freq, bool isDefaultFreq)
 {
-   QString itemName = branch->text(0);
-   QString itemVal  = branch->text(1);
-   QStringList valSplit = itemVal.split(",");
-   for(int i=0; i<valSplit.size(); i++)
+   while (nextChild(xml))
    {
-      if (!valSplit.at(i).contains("="))
-      {
-         continue;
-      }
-      QString paraName = valSplit.at(i).split("=").at(0);
-      QString paraValu = valSplit.at(i).split("=").at(1);
-
-      if(paraName == "Frequency_Mode")
+      const QStringRef name = xml.name();
+      bool ok = true;
+      if (name == QLatin1String("Frequency_Mode"))
       {
+         const QString mode = xml.readElementText();
+         if (mode == QLatin1String("ASAP"))
+         {
+            continue;
+         }
          if (isDefaultFreq)
          {
             m_ASAPChecked = false;
          }
-         if (paraValu == "WAVELET")
+         if (mode == QLatin1String("WAVELET"))
          {
             freq.setType(WAVELET);
          }
-         else if (paraValu == "STATIC")
+         else if (mode == QLatin1String("STATIC"))
          {
             freq.setType(STATIC);
          }
-         else if (paraValu == "SINGLE")
+         else if (mode == QLatin1String("SINGLE"))
          {
             freq.setType(SINGLE);
          }
-         else if(paraValu == "NOT_SPECIFIED")
+         else if (mode == QLatin1String("NOT_SPECIFIED"))
          {
             if (isDefaultFreq)
             {
@@ -734,521 +775,351 @@ bool SautoXml::extractFrequencyDefs(CTreeBranch *branch, SautoModel &freq, bool
          }
          else
          {
+            xml.raiseError(QString("Invalid frequency mode '%1'").arg(mode));
             return false;
          }
       }
-      else if(paraName == "Period_sec")
+      else if (name == QLatin1String("Period_sec"))
       {
-         bool ok;
-         quint64 sec = paraValu.toULongLong(&ok);
-         if(!ok)
-         {
-            qCritical() << QString("Invalid parameter '%1'").arg(valSplit.at(i));
-            return false;
-         }
-         freq.setPeriodTotMSecs(sec*1000);
+         const quint64 sec = xml.readElementText().toULongLong(&ok);
+         freq.setPeriodTotMSecs(sec * 1000);
       }
-      else if(paraName == "Phase_sec")
+      else if (name == QLatin1String("Phase_sec"))
       {
-         bool ok;
-         qreal phase = paraValu.toDouble(&ok);
-         if(!ok)
-         {
-            qCritical() << QString("Invalid parameter '%1'").arg(valSplit.at(i));
-            return false;
-         }
-         freq.setPhase(phase);
+         freq.setPhase(xml.readElementText().toDouble(&ok));
       }
-      else if(paraName == "Start_time")
+      else if (name == QLatin1String("Start_time"))
       {
-         bool ok;
-         qint64 start = paraValu.toLongLong(&ok);
-         if(!ok)
-         {
-            qCritical() << QString("Invalid parameter '%1'").arg(valSplit.at(i));
-            return false;
-         }
-         if (start < 0)
-         {
-            freq.setStartTimeMSecs(-1);
-         }
-         else
-         {
-            freq.setStartTimeMSecs(start * 1000);
-         }
+         const qint64 start = xml.readElementText().toLongLong(&ok);
+         freq.setStartTimeMSecs(start < 0 ? -1 : start * 1000);
       }
-      else if(paraName == "Duration")
+      else if (name == QLatin1String("Duration"))
       {
-         bool ok;
-         quint64 dur = paraValu.toULongLong(&ok);
-         if(!ok)
-         {
-            qCritical() << QString("Invalid parameter '%1'").arg(valSplit.at(i));
-            return false;
-         }
+         const quint64 dur = xml.readElementText().toULongLong(&ok);
          freq.setDuration(dur * 1000);
       }
-      else if (paraName == "Peak_task")
+      else if (name == QLatin1String("Peak_task"))
       {
-         freq.setOnPeak(paraValu);
+         freq.setOnPeak(xml.readElementText());
       }
-      else if (paraName == "Valley_task")
+      else if (name == QLatin1String("Valley_task"))
       {
-         freq.setOnValley(paraValu);
+         freq.setOnValley(xml.readElementText());
       }
-      else if (paraName == "Rising_task")
+      else if (name == QLatin1String("Rising_task"))
       {
-         freq.setOnRising(paraValu);
+         freq.setOnRising(xml.readElementText());
       }
-      else if (paraName == "Sinking_task")
+      else if (name == QLatin1String("Sinking_task"))
       {
-         freq.setOnSinking(paraValu);
+         freq.setOnSinking(xml.readElementText());
       }
-      else if(paraName == "HasCustomInterval")
+      else if (name == QLatin1String("HasCustomInterval"))
       {
-         if (paraValu.toLower() == "true")
-         {
-            freq.setHasCustomInterval(true);
-         }
-         else if (paraValu.toLower() == "false")
-         {
-            freq.setHasCustomInterval(false);
-         }
-         else
+         bool hasCustom = false;
+         if (!readBool(xml, hasCustom))
          {
             return false;
          }
+         freq.setHasCustomInterval(hasCustom);
       }
       else
       {
-         return false;
+         xml.skipCurrentElement();
       }
-   }
 
-   for(int i=0; i<branch->childCount(); i++)
-   {
-      if (!extractFrequencyDefs(branch->child(i), freq))
+      if (!ok)
       {
+         xml.raiseError("Invalid number");
          return false;
       }
    }
-   return true;
+   return !xml.hasError();
 }
 
-bool SautoXml::extractClockDefs(CTreeBranch *branch, INTERVAL_LIST &interval)
+//  A list of intervals, inherited is set when the list defers to the level above it
+bool SautoXml::readClockEntry(QXmlStreamReader &xml, INTERVAL_LIST &interval, bool &inherited, bool isDefaultClock)
 {
-   if(0 == branch)
-   {
-      return false;
-   }
-
-   QString itemName = branch->text(0);
-   QString itemVal  = branch->text(1);
-   QStringList itemSplit = itemVal.split("=");
-   if(itemSplit.at(0) == "Clock_Mode")
+   while (nextChild(xml))
    {
-      if(itemSplit.size() >= 2 && itemSplit.at(1) == "Custom")
+      if (xml.name() == QLatin1String("Clock_Mode"))
       {
-         if (!m_defClockSet)
+         const QString mode = xml.readElementText();
+         if (mode == QLatin1String("Custom"))
          {
-            m_allDayChecked = false;
+            inherited = false;
          }
-      }
-      else if (itemSplit.size() >= 2 && itemSplit.at(1) == "All_Day" ||
-         itemSplit.size() >= 2 && itemSplit.at(1) == "Inherited")
-      {
-         if (!m_defClockSet)
+         else if (mode == QLatin1String("All_Day") || mode == QLatin1String("Inherited"))
          {
-            m_allDayChecked = true;
+            inherited = true;
+         }
+         else
+         {
+            xml.raiseError(QString("Invalid clock mode '%1'").arg(mode));
+            return false;
+         }
+         if (isDefaultClock)
+         {
+            m_allDayChecked = inherited;
          }
-         return true;
       }
-      else
+      else if (!readIntervalEntry(xml, interval, inherited))
       {
          return false;
       }
    }
-   else if(itemName == "INTERVAL")
+   return !xml.hasError();
+}
+
+//  Appends the interval when the reader is on one, and skips anything else
+bool SautoXml::readIntervalEntry(QXmlStreamReader &xml, INTERVAL_LIST &interval, bool ignore)
+{
+   const QXmlStreamAttributes attributes = xml.attributes();
+   if (xml.name() != QLatin1String("entry") || attributes.value(QLatin1String("term")) != QLatin1String("INTERVAL"))
    {
-      SautoModel freq;
-      if (!extractFrequencyDefs(branch, freq))
-      {
-         return false;
-      }
-      if (freq.isValid() || freq.getHasCustomInterval())
-      {
-         interval << freq;
-      }
+      xml.skipCurrentElement();
+      return true;
    }
-   else if (itemName != "Day_Definition")
+
+   SautoModel freq;
+   if (!readFrequencyEntry(xml, freq))
    {
       return false;
    }
-   for(int i=0; i<branch->childCount(); i++)
+   if (!ignore && (freq.isValid() || freq.getHasCustomInterval()))
    {
-      if (!extractClockDefs(branch->child(i), interval))
-      {
-         return false;
-      }
+      interval << freq;
    }
    return true;
 }
 
-bool SautoXml::extractWeekDefs(CTreeBranch *branch, WEEK_DEF &week)
+bool SautoXml::readWeekEntry(QXmlStreamReader &xml, WEEK_DEF &week)
 {
-   if (0 == branch)
-   {
-      return false;
-   }
-
-   QString itemName = branch->text(0);
-   QString itemVal  = branch->text(1);
-   QStringList itemSplit = itemVal.split("=");
-
-   if(itemSplit.at(0) == "Week_Mode")
+   while (nextChild(xml))
    {
-      if(itemSplit.size() >= 2 && itemSplit.at(1) == "Custom")
+      const QXmlStreamAttributes attributes = xml.attributes();
+      const QStringRef term = attributes.value(QLatin1String("term"));
+      if (xml.name() == QLatin1String("Week_Mode"))
       {
-         if (!m_defWeekSet)
+         const QString mode = xml.readElementText();
+         if (mode == QLatin1String("Custom"))
          {
             m_everyDayChecked = false;
          }
-      }
-      else if(itemSplit.size() >= 2 && itemSplit.at(1) == "Every_Day")
-      {
-         if (!m_defWeekSet)
+         else if (mode == QLatin1String("Every_Day"))
          {
             m_everyDayChecked = true;
          }
-      }
-      else
-      {
-         return false;
-      }
-   }
-   else if(itemSplit.at(0) == "Clock_Mode")
-   {
-      if(itemSplit.size() > 1)
-      {
-         if (itemSplit.at(1) == "Custom")
-         {
-            m_daysHasCustomInterval = true;
-         }
          else
          {
-            m_daysHasCustomInterval = false;
+            xml.raiseError(QString("Invalid week mode '%1'").arg(mode));
+            return false;
          }
       }
-   }
-   else if (
-      itemName == "1" ||
-      itemName == "2" ||
-      itemName == "3" ||
-      itemName == "4" ||
-      itemName == "5" ||
-      itemName == "6" ||
-      itemName == "7"
-      )
-   {
-      QStringList itemValSplit = itemVal.split("=");
-      if (itemValSplit.size() >= 2)
+      else if (xml.name() == QLatin1String("entry") && term.size() == 1 && term.at(0) >= QLatin1Char('1') && term.at(0) <= QLatin1Char('7'))
       {
          // members needed to create a week entry
-         int dayName = itemName.toInt();
-         bool enabled = false;
-         bool inherited = true;
-         INTERVAL_LIST interv;
-         QString boolStr = itemValSplit.at(1);
-         if (boolStr.toLower() == "true")
-         {
-            enabled = true;
-         }
-         else if (boolStr.toLower() == "false")
-         {
-            enabled = false;
-         }
-         else
-         {
-            return false;
-         }
-         int childCount = branch->childCount();
-         for (int i = 0; i < childCount; i++)
+         const int dayName = term.at(0).digitValue();
+         bool hasEnabled = false;
+         DAY_OF_WEEK_DEF day;
+         day.first.first = false;
+         day.first.second = true;
+         while (nextChild(xml))
          {
-            CTreeBranch *itemChild = branch->child(i); //< this day's clock mode
-            QString child1txt = itemChild->text(0);
-            if (child1txt != "Clock_Definitions")
-            {
-               continue;
-            }
-            QString child2txt = itemChild->text(1);
-            if (!child2txt.contains("="))
+            const QXmlStreamAttributes dayAttributes = xml.attributes();
+            if (xml.name() == QLatin1String("Enabled"))
             {
-               continue;
-            }
-            QStringList child2txtSplit = child2txt.split("=");
-            if (child2txtSplit.at(0) == "Clock_Mode")
-            {
-               if (child2txtSplit.at(1) == "Inherited")
-               {
-                  inherited = true;
-                  break;
-               }
-               else if (child2txtSplit.at(1) == "Custom")
+               if (!readBool(xml, day.first.first))
                {
-                  inherited = false;
-                  int grandChildrenCount = itemChild->childCount(); //< number of intervals
-                  for (int j = 0; j < grandChildrenCount; j++)
-                  {
-                     CTreeBranch *itemGrandChild = itemChild->child(j);
-                     if (!extractClockDefs(itemGrandChild, interv))
-                     {
-                        return false;
-                     }
-                  }
+                  return false;
                }
-               else
+               hasEnabled = true;
+            }
+            else if (xml.name() == QLatin1String("entry") && dayAttributes.value(QLatin1String("term")) == QLatin1String("Clock_Definitions"))
+            {
+               if (!readClockEntry(xml, day.second, day.first.second))
                {
                   return false;
                }
             }
+            else
+            {
+               xml.skipCurrentElement();
+            }
+         }
+         if (hasEnabled)
+         {
+            week.insert(dayName, day);
          }
-
-         DAY_OF_WEEK_DEF outerPair;
-         outerPair.first.first = enabled;
-         outerPair.first.second = inherited;
-         outerPair.second = interv;
-         week.insert(dayName, outerPair);
       }
-   }
-
-   for (int i = 0; i < branch->childCount(); i++)
-   {
-      if (!extractWeekDefs(branch->child(i), week))
+      else
       {
-         return false;
+         xml.skipCurrentElement();
       }
    }
-
-   return true;
+   return !xml.hasError();
 }
 
-bool SautoXml::extractCalendarDefs(CTreeBranch *branch, CALENDAR_DEF &calendar )
+bool SautoXml::readCalendarEntry(QXmlStreamReader &xml, CALENDAR_DEF &calendar)
 {
-   if(0 == branch)
+   while (nextChild(xml))
    {
-      return false;
-   }
-
-   QString itemName = branch->text(0);
-   QString itemVal  = branch->text(1);
-   QStringList itemSplit = itemVal.split("=");
-
-   if(itemSplit.at(0) == "Calendar_Mode")
-   {
-      if(itemSplit.size() >= 2 && itemSplit.at(1) == "Custom")
+      const QXmlStreamAttributes attributes = xml.attributes();
+      if (xml.name() == QLatin1String("Calendar_Mode"))
       {
-         if (!m_defCalendarSet)
+         const QString mode = xml.readElementText();
+         if (mode == QLatin1String("Custom"))
          {
             m_everyMonthChecked = false;
          }
+         else if (mode == QLatin1String("Every_Month"))
+         {
+            m_everyMonthChecked = true;
+         }
+         else
+         {
+            xml.raiseError(QString("Invalid calendar mode '%1'").arg(mode));
+            return false;
+         }
       }
-      else if(itemSplit.size() >= 2 && itemSplit.at(1) == "Every_Month")
+      else if (xml.name() == QLatin1String("entry") && attributes.value(QLatin1String("term")) == QLatin1String("Year_Definition"))
       {
-         if (!m_defCalendarSet)
+         if (!readYearEntry(xml, calendar))
          {
-            m_everyMonthChecked = true;
+            return false;
          }
       }
       else
       {
-         return false;
+         xml.skipCurrentElement();
       }
    }
-   else if(itemName == "Year_Definition")
+   return !xml.hasError();
+}
+
+bool SautoXml::readYearEntry(QXmlStreamReader &xml, CALENDAR_DEF &calendar)
+{
+   int yearNo = 0;
+   bool yearIsActive = false;
+   MONTH_DEF monthDef;
+   while (nextChild(xml))
    {
-      int yearNo = 0;
-      bool yearIsActive = false;
-      MONTH_DEF monthDef;
-      QStringList itemValSplit = itemVal.split("=");
-      if(itemValSplit.size() >= 2 && itemValSplit.at(0) == "Name")
+      const QXmlStreamAttributes attributes = xml.attributes();
+      if (xml.name() == QLatin1String("Name"))
       {
          yearIsActive = true;
-         yearNo = itemValSplit.at(1).toInt();
+         yearNo = xml.readElementText().toInt();
+      }
+      else if (xml.name() != QLatin1String("entry"))
+      {
+         xml.skipCurrentElement();
       }
-      int itemChildNo = branch->childCount(); //< number of defined months for this year
-      for(int i=0; i<itemChildNo; i++)
+      else if (attributes.value(QLatin1String("term")) == QLatin1String("Month_Definition"))
       {
          QString monthName;
          DAY_OF_MONTH_DEF monthData;
-         CTreeBranch *childItem = branch->child(i);
-         if (0 == childItem)
+         if (!readMonthEntry(xml, monthName, monthData))
          {
-            continue;
+            return false;
          }
-         QString childName = childItem->text(0);
-         QString childVal  = childItem->text(1);
-         if(childName == "Month_Definition")
+         monthDef.insert(monthName, monthData);
+      }
+      else
+      {
+         xml.raiseError(QString("Unexpected entry '%1' in a year").arg(attributes.value(QLatin1String("term")).toString()));
+         return false;
+      }
+   }
+
+   calendar.insert(yearNo, qMakePair(yearIsActive, monthDef));
+   return !xml.hasError();
+}
+
+bool SautoXml::readMonthEntry(QXmlStreamReader &xml, QString &monthName, DAY_OF_MONTH_DEF &monthData)
+{
+   monthData.first = false;
+   while (nextChild(xml))
+   {
+      const QXmlStreamAttributes attributes = xml.attributes();
+      if (xml.name() == QLatin1String("Name"))
+      {
+         monthName = xml.readElementText();
+         if (getMonthAsInt(monthName) < 0)
          {
-            QStringList childValSplit = childVal.split(",");
-            for(int j=0; j<childValSplit.size(); j++)
-            {
-               QString tmpElem = childValSplit.at(j);
-               if (!tmpElem.contains("="))
-               {
-                  continue;
-               }
-               QStringList elemSplit = tmpElem.split("=");
-               if(elemSplit.at(0) == "Name")
-               {
-                  monthName = elemSplit.at(1);
-                  if (getMonthAsInt(monthName) < 0)
-                  {
-                     return false;
-                  }
-               }
-               else if(elemSplit.at(0) == "Inherited")
-               {
-                  QString elmSplt = elemSplit.at(1);
-                  QString boolName = elmSplt.toLower();
-                  if (boolName == "true")
-                  {
-                     monthData.first = true;
-                  }
-                  else if(boolName == "false")
-                  {
-                     monthData.first = false;
-
-                     // extract days for this month
-                     int grandchildCount = childItem->childCount();
-                     QMap<int, CALENDAR_DATE> days;
-
-                     // loop through all day-children
-                     for(int k=0; k<grandchildCount; k++)
-                     {
-                        int dateInt;
-                        CALENDAR_DATE dayData;
-                        QDate date;
-                        bool dateInherit;
-                        INTERVAL_LIST intervals;
-                        CTreeBranch *dayChild = childItem->child(k);
-                        if(0 == dayChild)
-                        {
-                           continue;
-                        }
-                        QString dayName = dayChild->text(0);
-                        QString dayVal  = dayChild->text(1);
-                        if(dayName == "Day_Definition")
-                        {
-                           QStringList dayValSplit = dayVal.split(",");
-                           for(int l=0; l<dayValSplit.size(); l++)
-                           {
-                              QString dayValElem = dayValSplit.at(l);
-                              if (!dayValElem.contains("="))
-                              {
-                                 continue;
-                              }
-
-                              QStringList dayElemSplit = dayValElem.split("=");
-                              QString dayElemName = dayElemSplit.at(0);
-                              QString dayElemVal  = dayElemSplit.at(1);
-
-                              if(dayElemName == "Name")
-                              {
-                                 dateInt = dayElemVal.toInt();
-
-                                 // construct a QDate
-                                 QString dateStr = QString("%1").arg(dateInt);
-                                 int tmpYear  = dateStr.left(4).toInt();
-                                 int tmpMonth = dateStr.mid(4,2).toInt();
-                                 int tmpDay   = dateStr.right(2).toInt();
-
-                                 date = QDate(tmpYear, tmpMonth, tmpDay);
-                              }
-                              else if(dayElemName == "Inherited")
-                              {
-                                 if (dayElemVal == "true")
-                                 {
-                                    dateInherit = true;
-                                 }
-                                 else if(dayElemVal == "false")
-                                 {
-                                    dateInherit = false;
-                                    INTERVAL_LIST tmpInterv;
-                                    if (!extractClockDefs(dayChild, tmpInterv))
-                                    {
-                                       dateInherit = true;
-                                    }
-                                    else if (tmpInterv.size() == 0)
-                                    {
-                                       dateInherit = true;
-                                    }
-                                    else
-                                    {
-                                       // accept this interval
-                                       intervals = tmpInterv;
-                                    }
-                                 }
-                                 else
-                                 {
-                                    return false;
-                                 }
-                              }
-                              else
-                              {
-                                 return false;
-                              }
-                           }
-                        }
-                        else
-                        {
-                           return false;
-                        }
-
-                        // insert the day data into this day
-                        dayData.first.first = date;
-                        dayData.first.second = dateInherit;
-                        dayData.second = intervals;
-                        days.insert(dateInt, dayData);
-                     }
-
-                     // insert the list of days into the month definition
-                     monthData.second = days;
-                  }
-                  else
-                  {
-                     return false;
-                  }
-               }
-               else
-               {
-                  return false;
-               }
-            }
+            xml.raiseError(QString("Invalid month '%1'").arg(monthName));
+            return false;
          }
-         else
+      }
+      else if (xml.name() == QLatin1String("Inherited"))
+      {
+         if (!readBool(xml, monthData.first))
          {
             return false;
          }
-
-         // insert this month to month definition list
-         monthDef.insert(monthName, monthData);
       }
-
-      // insert this year to the calendar list
-      QPair<bool, MONTH_DEF> monthDefPair;
-      monthDefPair.first = yearIsActive;
-      monthDefPair.second = monthDef;
-      calendar.insert(yearNo, monthDefPair);
+      else if (xml.name() != QLatin1String("entry"))
+      {
+         xml.skipCurrentElement();
+      }
+      else if (attributes.value(QLatin1String("term")) == QLatin1String("Day_Definition"))
+      {
+         // the days of a month that inherits from the week are not used
+         if (!readDayEntry(xml, monthData.first ? 0 : &monthData.second))
+         {
+            return false;
+         }
+      }
+      else
+      {
+         xml.raiseError(QString("Unexpected entry '%1' in a month").arg(attributes.value(QLatin1String("term")).toString()));
+         return false;
+      }
    }
+   return !xml.hasError();
+}
 
-   for(int i=0; i<branch->childCount(); i++)
+//  A day is keyed on its date as yyyymmdd. A day without intervals of its own inherits them
+bool SautoXml::readDayEntry(QXmlStreamReader &xml, QMap<int, CALENDAR_DATE> *days)
+{
+   int dateInt = 0;
+   bool dateInherit = true;
+   INTERVAL_LIST intervals;
+   while (nextChild(xml))
    {
-      if(!extractCalendarDefs(branch->child(i), calendar))
+      if (xml.name() == QLatin1String("Name"))
+      {
+         dateInt = xml.readElementText().toInt();
+      }
+      else if (xml.name() == QLatin1String("Inherited"))
+      {
+         if (!readBool(xml, dateInherit))
+         {
+            return false;
+         }
+      }
+      else if (!readIntervalEntry(xml, intervals, dateInherit))
       {
          return false;
       }
    }
+   if (xml.hasError())
+   {
+      return false;
+   }
+   if (days == 0)
+   {
+      return true;
+   }
 
+   if (intervals.size() == 0)
+   {
+      dateInherit = true;
+   }
+   CALENDAR_DATE dayData;
+   dayData.first.first = QDate(dateInt / 10000, (dateInt / 100) % 100, dateInt % 100);
+   dayData.first.second = dateInherit;
+   dayData.second = intervals;
+   days->insert(dateInt, dayData);
    return true;
 }
 
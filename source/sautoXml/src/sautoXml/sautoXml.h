@@ -76,6 +76,8 @@ namespace sauto {
          bool &everyDay,
          bool &everyMonth) const;
 
+      inline const QString& errorString() const { return m_error; }
+
    private:
       CTreeBranch *createClockTree(const SautoModel  &frequency,
          const INTERVAL_LIST &interval,
@@ -92,28 +94,26 @@ namespace sauto {
       void readNameElement(QXmlStreamReader *xmlReader, CTreeBranch *parent, const QString &termVal);
       void readFreqElement(QXmlStreamReader *xmlReader, CTreeBranch *parent, const QString &termVal);
 
-      bool parseProcessTree(CTreeBranch  *root,
-         SautoModel &frequency,
-         INTERVAL_LIST &interval,
-         WEEK_DEF &week,
-         CALENDAR_DEF &calender);
-
-      bool parseXmlItem(CTreeBranch *branch,
+      bool readClockStream(QXmlStreamReader &xml,
          SautoModel &frequency,
          INTERVAL_LIST &interval,
          WEEK_DEF &week,
          CALENDAR_DEF &calender);
 
-      bool parseXmlTimeSettingsItem(CTreeBranch *branch,
+      bool readTimeEntry(QXmlStreamReader &xml,
          SautoModel &frequency,
          INTERVAL_LIST &interval,
          WEEK_DEF &week,
          CALENDAR_DEF &calender);
 
-      bool extractFrequencyDefs(CTreeBranch *branch, SautoModel  &freq, bool isDefaultFreq = false);
-      bool extractClockDefs(CTreeBranch *branch, INTERVAL_LIST &interval);
-      bool extractWeekDefs(CTreeBranch *branch, WEEK_DEF &week);
-      bool extractCalendarDefs(CTreeBranch *branch, CALENDAR_DEF &calendar);
+      bool readFrequencyEntry(QXmlStreamReader &xml, SautoModel &freq, bool isDefaultFreq = false);
+      bool readClockEntry(QXmlStreamReader &xml, INTERVAL_LIST &interval, bool &inherited, bool isDefaultClock = false);
+      bool readIntervalEntry(QXmlStreamReader &xml, INTERVAL_LIST &interval, bool ignore);
+      bool readWeekEntry(QXmlStreamReader &xml, WEEK_DEF &week);
+      bool readCalendarEntry(QXmlStreamReader &xml, CALENDAR_DEF &calendar);
+      bool readYearEntry(QXmlStreamReader &xml, CALENDAR_DEF &calendar);
+      bool readMonthEntry(QXmlStreamReader &xml, QString &monthName, DAY_OF_MONTH_DEF &monthData);
+      bool readDayEntry(QXmlStreamReader &xml, QMap<int, CALENDAR_DATE> *days);
 
    private:
       bool m_ASAPChecked;
@@ -123,7 +123,7 @@ namespace sauto {
       bool m_defClockSet;
       bool m_defWeekSet;
       bool m_defCalendarSet;
-      bool m_daysHasCustomInterval;
+      QString m_error;
       QString m_nameBuffer;
       QString m_buffer;
       QStringList m_freqBuffer;